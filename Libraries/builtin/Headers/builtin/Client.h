@@ -0,0 +1,44 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __builtin_Client_h
+#define __builtin_Client_h
+
+#include <builtin/Base.h>
+#include <builtin/Request.h>
+
+#include <string>
+#include <ext/optional>
+
+namespace builtin {
+
+/*
+ * Sends requests to run builtin tools to a builtin server.
+ */
+class Client {
+public:
+    /*
+     * Run a request in the server listening on a socket. The tool uses the
+     * standard input, output, and error of this process. Returns the exit
+     * status of the tool, or nothing if the server couldn't be reached and
+     * so the tool didn't run.
+     */
+    static ext::optional<int>
+    Run(std::string const &socketPath, Request const &request);
+
+    /*
+     * Start a server in the background, detached from this process.
+     */
+    static bool
+    StartServer(std::string const &serverPath, std::string const &socketPath);
+};
+
+}
+
+#endif // !__builtin_Client_h
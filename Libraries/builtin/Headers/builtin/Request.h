@@ -0,0 +1,87 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __builtin_Request_h
+#define __builtin_Request_h
+
+#include <builtin/Base.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <ext/optional>
+
+namespace builtin {
+
+/*
+ * A request to run a builtin tool in the builtin server. Sent over a Unix
+ * socket along with the standard input, output, and error of the client,
+ * so the tool's output goes directly to wherever the client's would.
+ */
+class Request {
+private:
+    std::string                                  _name;
+    std::vector<std::string>                     _arguments;
+    std::unordered_map<std::string, std::string> _environment;
+    std::string                                  _workingDirectory;
+
+public:
+    Request(
+        std::string const &name,
+        std::vector<std::string> const &arguments,
+        std::unordered_map<std::string, std::string> const &environment,
+        std::string const &workingDirectory);
+
+public:
+    /*
+     * The name of the builtin tool to run, such as "builtin-copy".
+     */
+    std::string const &name() const
+    { return _name; }
+
+    /*
+     * The arguments, environment, and working directory to run it with.
+     */
+    std::vector<std::string> const &arguments() const
+    { return _arguments; }
+    std::unordered_map<std::string, std::string> const &environment() const
+    { return _environment; }
+    std::string const &workingDirectory() const
+    { return _workingDirectory; }
+
+public:
+    /*
+     * Serialize the request.
+     */
+    std::vector<uint8_t> serialize() const;
+
+    /*
+     * Parse a serialized request. Fails if the contents are invalid.
+     */
+    static ext::optional<Request>
+    Deserialize(std::vector<uint8_t> const &contents);
+
+public:
+    /*
+     * Send the request over a socket, passing along the file descriptors.
+     */
+    bool send(int socket, std::vector<int> const &descriptors) const;
+
+    /*
+     * Receive a request from a socket, along with any file descriptors
+     * passed with it. The caller owns the received descriptors.
+     */
+    static ext::optional<Request>
+    Receive(int socket, std::vector<int> *descriptors);
+};
+
+}
+
+#endif // !__builtin_Request_h
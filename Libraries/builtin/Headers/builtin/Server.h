@@ -0,0 +1,79 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __builtin_Server_h
+#define __builtin_Server_h
+
+#include <builtin/Base.h>
+#include <builtin/Registry.h>
+
+#include <string>
+
+namespace builtin {
+
+/*
+ * Runs builtin tools for clients connecting over a Unix socket. The server
+ * stays running between requests, so running a builtin tool only costs a
+ * fork rather than starting a new process and loading the tool each time.
+ * Each request runs in its own child process, so requests run in parallel
+ * and a failing tool can't affect the server.
+ */
+class Server {
+private:
+    Registry    _registry;
+    std::string _socketPath;
+    int         _idleTimeout;
+
+public:
+    Server(Registry const &registry, std::string const &socketPath, int idleTimeout);
+    ~Server();
+
+public:
+    /*
+     * The socket the server listens on.
+     */
+    std::string const &socketPath() const
+    { return _socketPath; }
+
+    /*
+     * Seconds without a request before the server exits.
+     */
+    int idleTimeout() const
+    { return _idleTimeout; }
+
+public:
+    /*
+     * Serve requests until idle. Returns immediately if another server is
+     * already using the socket. Fails if the socket can't be created.
+     */
+    bool run();
+
+public:
+    /*
+     * The socket used by the server for the builtin tools installed in a
+     * directory. Per user, and per installation, so different versions of
+     * the tools never talk to each other. The socket is in a directory only
+     * that user can use.
+     */
+    static std::string
+    DefaultSocketPath(std::string const &executableRoot);
+
+    /*
+     * If the directory containing a socket is private to this user: a real
+     * directory, owned by the user, that no one else can access. Anyone else
+     * able to create the socket could impersonate the server. Optionally
+     * creates the directory first.
+     */
+    static bool
+    SecureSocketDirectory(std::string const &socketPath, bool create);
+};
+
+}
+
+#endif // !__builtin_Server_h
@@ -0,0 +1,155 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <builtin/Client.h>
+#include <builtin/Server.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using builtin::Client;
+using builtin::Request;
+using builtin::Server;
+
+/*
+ * The user running the process on the other end of a connection.
+ */
+static bool
+PeerUser(int connection, uid_t *user)
+{
+#if defined(__linux__)
+    struct ucred credentials;
+    socklen_t size = sizeof(credentials);
+    if (::getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &credentials, &size) != 0) {
+        return false;
+    }
+    *user = credentials.uid;
+    return true;
+#else
+    gid_t group;
+    return ::getpeereid(connection, user, &group) == 0;
+#endif
+}
+
+ext::optional<int> Client::
+Run(std::string const &socketPath, Request const &request)
+{
+    /* Handle a server going away as an error, rather than being killed. */
+    ::signal(SIGPIPE, SIG_IGN);
+
+    struct sockaddr_un address;
+    ::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        return ext::nullopt;
+    }
+    ::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    /* Only trust a socket no one else could have created. */
+    if (!Server::SecureSocketDirectory(socketPath, false)) {
+        return ext::nullopt;
+    }
+
+    int connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection < 0) {
+        return ext::nullopt;
+    }
+
+    if (::connect(connection, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0) {
+        ::close(connection);
+        return ext::nullopt;
+    }
+
+    /*
+     * The request hands over this process's descriptors and environment,
+     * and the status sent back is trusted, so the server must be this user.
+     */
+    uid_t user;
+    if (!PeerUser(connection, &user) || user != ::geteuid()) {
+        ::close(connection);
+        return ext::nullopt;
+    }
+
+    if (!request.send(connection, { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO })) {
+        ::close(connection);
+        return ext::nullopt;
+    }
+
+    /*
+     * Once the request is sent, the tool may have run, so it can't be run
+     * again here. Any failure from now on is a failure of the tool.
+     */
+    uint8_t buffer[4];
+    for (size_t offset = 0; offset < sizeof(buffer);) {
+        ssize_t count = ::read(connection, buffer + offset, sizeof(buffer) - offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        } else if (count <= 0) {
+            fprintf(stderr, "error: builtin server did not finish running %s\n", request.name().c_str());
+            ::close(connection);
+            return 1;
+        }
+        offset += count;
+    }
+
+    ::close(connection);
+
+    uint32_t status = 0;
+    for (size_t n = 0; n < sizeof(buffer); n++) {
+        status |= static_cast<uint32_t>(buffer[n]) << (n * 8);
+    }
+
+    return static_cast<int>(status);
+}
+
+bool Client::
+StartServer(std::string const &serverPath, std::string const &socketPath)
+{
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        return false;
+    } else if (pid == 0) {
+        /*
+         * Detach from the client's session, and fork again so the server is
+         * not a child of the client and outlives it.
+         */
+        ::setsid();
+
+        if (::fork() == 0) {
+            int null = ::open("/dev/null", O_RDWR);
+            if (null >= 0) {
+                ::dup2(null, STDIN_FILENO);
+                ::dup2(null, STDOUT_FILENO);
+                ::dup2(null, STDERR_FILENO);
+                if (null > STDERR_FILENO) {
+                    ::close(null);
+                }
+            }
+
+            ::execl(serverPath.c_str(), serverPath.c_str(), "--socket", socketPath.c_str(), static_cast<char *>(nullptr));
+        }
+
+        ::_exit(0);
+    }
+
+    int status;
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+
+    return true;
+}
@@ -0,0 +1,311 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <builtin/Request.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using builtin::Request;
+
+Request::
+Request(
+    std::string const &name,
+    std::vector<std::string> const &arguments,
+    std::unordered_map<std::string, std::string> const &environment,
+    std::string const &workingDirectory) :
+    _name            (name),
+    _arguments       (arguments),
+    _environment     (environment),
+    _workingDirectory(workingDirectory)
+{
+}
+
+/*
+ * Changed whenever the format changes, so an older server rejects requests
+ * it can't understand rather than misinterpreting them.
+ */
+static std::string const RequestVersion = "xcbuild-builtin-request-1";
+
+/*
+ * Refuse anything larger, rather than allocating whatever a peer claims.
+ */
+static uint32_t const MaximumRequestSize = 64 * 1024 * 1024;
+
+/*
+ * The most file descriptors passed with a request.
+ */
+static size_t const MaximumDescriptors = 3;
+
+static void
+WriteInteger(std::vector<uint8_t> *contents, uint32_t value)
+{
+    for (size_t n = 0; n < sizeof(value); n++) {
+        contents->push_back(static_cast<uint8_t>(value >> (n * 8)));
+    }
+}
+
+static void
+WriteString(std::vector<uint8_t> *contents, std::string const &value)
+{
+    WriteInteger(contents, value.size());
+    contents->insert(contents->end(), value.begin(), value.end());
+}
+
+static bool
+ReadInteger(std::vector<uint8_t> const &contents, size_t *offset, uint32_t *value)
+{
+    if (contents.size() - *offset < sizeof(*value)) {
+        return false;
+    }
+
+    *value = 0;
+    for (size_t n = 0; n < sizeof(*value); n++) {
+        *value |= static_cast<uint32_t>(contents[*offset + n]) << (n * 8);
+    }
+
+    *offset += sizeof(*value);
+    return true;
+}
+
+static bool
+ReadString(std::vector<uint8_t> const &contents, size_t *offset, std::string *value)
+{
+    uint32_t size;
+    if (!ReadInteger(contents, offset, &size) || contents.size() - *offset < size) {
+        return false;
+    }
+
+    *value = std::string(contents.begin() + *offset, contents.begin() + *offset + size);
+    *offset += size;
+    return true;
+}
+
+std::vector<uint8_t> Request::
+serialize() const
+{
+    std::vector<uint8_t> contents;
+    WriteString(&contents, RequestVersion);
+    WriteString(&contents, _name);
+    WriteString(&contents, _workingDirectory);
+
+    WriteInteger(&contents, _arguments.size());
+    for (std::string const &argument : _arguments) {
+        WriteString(&contents, argument);
+    }
+
+    WriteInteger(&contents, _environment.size());
+    for (auto const &variable : _environment) {
+        WriteString(&contents, variable.first);
+        WriteString(&contents, variable.second);
+    }
+
+    return contents;
+}
+
+ext::optional<Request> Request::
+Deserialize(std::vector<uint8_t> const &contents)
+{
+    size_t offset = 0;
+
+    std::string version;
+    if (!ReadString(contents, &offset, &version) || version != RequestVersion) {
+        return ext::nullopt;
+    }
+
+    std::string name;
+    std::string workingDirectory;
+    if (!ReadString(contents, &offset, &name) || !ReadString(contents, &offset, &workingDirectory)) {
+        return ext::nullopt;
+    }
+
+    uint32_t argumentCount;
+    if (!ReadInteger(contents, &offset, &argumentCount)) {
+        return ext::nullopt;
+    }
+
+    std::vector<std::string> arguments;
+    for (uint32_t n = 0; n < argumentCount; n++) {
+        std::string argument;
+        if (!ReadString(contents, &offset, &argument)) {
+            return ext::nullopt;
+        }
+        arguments.push_back(argument);
+    }
+
+    uint32_t environmentCount;
+    if (!ReadInteger(contents, &offset, &environmentCount)) {
+        return ext::nullopt;
+    }
+
+    std::unordered_map<std::string, std::string> environment;
+    for (uint32_t n = 0; n < environmentCount; n++) {
+        std::string variable;
+        std::string value;
+        if (!ReadString(contents, &offset, &variable) || !ReadString(contents, &offset, &value)) {
+            return ext::nullopt;
+        }
+        environment.insert({ variable, value });
+    }
+
+    if (offset != contents.size()) {
+        return ext::nullopt;
+    }
+
+    return Request(name, arguments, environment, workingDirectory);
+}
+
+bool Request::
+send(int socket, std::vector<int> const &descriptors) const
+{
+    if (descriptors.size() > MaximumDescriptors) {
+        return false;
+    }
+
+    /* Prefix with the size, so the receiver knows how much to read. */
+    std::vector<uint8_t> contents;
+    std::vector<uint8_t> body = serialize();
+    WriteInteger(&contents, body.size());
+    contents.insert(contents.end(), body.begin(), body.end());
+
+    /*
+     * Pass the file descriptors with the first part of the request.
+     */
+    struct iovec iov;
+    iov.iov_base = contents.data();
+    iov.iov_len = contents.size();
+
+    union {
+        struct cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(int) * MaximumDescriptors)];
+    } control;
+    ::memset(&control, 0, sizeof(control));
+
+    struct msghdr message;
+    ::memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+
+    if (!descriptors.empty()) {
+        message.msg_control = control.buffer;
+        message.msg_controllen = CMSG_SPACE(sizeof(int) * descriptors.size());
+
+        struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(int) * descriptors.size());
+        ::memcpy(CMSG_DATA(header), descriptors.data(), sizeof(int) * descriptors.size());
+    }
+
+    ssize_t sent;
+    do {
+        sent = ::sendmsg(socket, &message, 0);
+    } while (sent < 0 && errno == EINTR);
+
+    if (sent <= 0) {
+        return false;
+    }
+
+    /*
+     * Write anything that didn't fit.
+     */
+    for (size_t offset = sent; offset < contents.size();) {
+        ssize_t written = ::write(socket, contents.data() + offset, contents.size() - offset);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        } else if (written <= 0) {
+            return false;
+        }
+        offset += written;
+    }
+
+    return true;
+}
+
+static bool
+ReadFully(int socket, uint8_t *buffer, size_t size)
+{
+    for (size_t offset = 0; offset < size;) {
+        ssize_t count = ::read(socket, buffer + offset, size - offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        } else if (count <= 0) {
+            return false;
+        }
+        offset += count;
+    }
+
+    return true;
+}
+
+ext::optional<Request> Request::
+Receive(int socket, std::vector<int> *descriptors)
+{
+    /*
+     * Read the size along with any file descriptors, which arrive with the
+     * first byte of the request.
+     */
+    uint8_t prefix[sizeof(uint32_t)];
+
+    struct iovec iov;
+    iov.iov_base = prefix;
+    iov.iov_len = sizeof(prefix);
+
+    union {
+        struct cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(int) * MaximumDescriptors)];
+    } control;
+    ::memset(&control, 0, sizeof(control));
+
+    struct msghdr message;
+    ::memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+
+    ssize_t received;
+    do {
+        received = ::recvmsg(socket, &message, 0);
+    } while (received < 0 && errno == EINTR);
+
+    if (received <= 0) {
+        return ext::nullopt;
+    }
+
+    for (struct cmsghdr *header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header)) {
+        if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+            size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            int const *data = reinterpret_cast<int const *>(CMSG_DATA(header));
+            descriptors->insert(descriptors->end(), data, data + count);
+        }
+    }
+
+    if (!ReadFully(socket, prefix + received, sizeof(prefix) - received)) {
+        return ext::nullopt;
+    }
+
+    std::vector<uint8_t> prefixContents = std::vector<uint8_t>(prefix, prefix + sizeof(prefix));
+    size_t offset = 0;
+    uint32_t size;
+    if (!ReadInteger(prefixContents, &offset, &size) || size > MaximumRequestSize) {
+        return ext::nullopt;
+    }
+
+    std::vector<uint8_t> contents = std::vector<uint8_t>(size);
+    if (!ReadFully(socket, contents.data(), contents.size())) {
+        return ext::nullopt;
+    }
+
+    return Deserialize(contents);
+}
@@ -0,0 +1,236 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <builtin/Server.h>
+#include <builtin/Driver.h>
+#include <builtin/Request.h>
+#include <libutil/DefaultFilesystem.h>
+#include <libutil/FSUtil.h>
+#include <libutil/Hash.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using builtin::Server;
+using builtin::Registry;
+using builtin::Request;
+using libutil::DefaultFilesystem;
+using libutil::FSUtil;
+using libutil::Hash;
+
+Server::
+Server(Registry const &registry, std::string const &socketPath, int idleTimeout) :
+    _registry   (registry),
+    _socketPath (socketPath),
+    _idleTimeout(idleTimeout)
+{
+}
+
+Server::
+~Server()
+{
+}
+
+static int
+RunRequest(Registry *registry, Request const &request, std::vector<int> const &descriptors)
+{
+    /*
+     * Use the client's input and output, so output goes where it expects.
+     */
+    for (size_t n = 0; n < descriptors.size(); n++) {
+        if (::dup2(descriptors[n], n) < 0) {
+            return 1;
+        }
+    }
+
+    /* Some tools resolve paths against the current directory. */
+    if (::chdir(request.workingDirectory().c_str()) != 0) {
+        fprintf(stderr, "error: unable to change directory to %s\n", request.workingDirectory().c_str());
+        return 1;
+    }
+
+    std::shared_ptr<builtin::Driver> driver = registry->driver(request.name());
+    if (driver == nullptr) {
+        fprintf(stderr, "error: unknown builtin tool %s\n", request.name().c_str());
+        return 1;
+    }
+
+    DefaultFilesystem filesystem;
+    int status = driver->run(request.arguments(), request.environment(), &filesystem, request.workingDirectory());
+
+    fflush(stdout);
+    fflush(stderr);
+    return status;
+}
+
+bool Server::
+run()
+{
+    /* Clients that go away shouldn't take the server with them. */
+    ::signal(SIGPIPE, SIG_IGN);
+
+    /* Children exit on their own; don't leave zombies behind. */
+    ::signal(SIGCHLD, SIG_IGN);
+
+    if (!SecureSocketDirectory(_socketPath, true)) {
+        fprintf(stderr, "error: socket directory for %s is not private\n", _socketPath.c_str());
+        return false;
+    }
+
+    /*
+     * Only one server uses the socket. The lock is held until the server
+     * exits, so a server that finds it locked can leave the socket alone.
+     */
+    std::string lockPath = _socketPath + ".lock";
+    int lock = ::open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (lock < 0) {
+        fprintf(stderr, "error: unable to open %s\n", lockPath.c_str());
+        return false;
+    }
+
+    if (::flock(lock, LOCK_EX | LOCK_NB) != 0) {
+        ::close(lock);
+        return true;
+    }
+
+    struct sockaddr_un address;
+    ::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (_socketPath.size() >= sizeof(address.sun_path)) {
+        fprintf(stderr, "error: socket path too long: %s\n", _socketPath.c_str());
+        ::close(lock);
+        return false;
+    }
+    ::strncpy(address.sun_path, _socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        ::close(lock);
+        return false;
+    }
+
+    /* Left behind by a server that didn't exit cleanly. */
+    ::unlink(_socketPath.c_str());
+
+    /* Only this user can connect. */
+    mode_t mask = ::umask(077);
+    int bound = ::bind(listener, reinterpret_cast<struct sockaddr *>(&address), sizeof(address));
+    ::umask(mask);
+
+    if (bound != 0 || ::listen(listener, SOMAXCONN) != 0) {
+        fprintf(stderr, "error: unable to listen on %s: %s\n", _socketPath.c_str(), strerror(errno));
+        ::close(listener);
+        ::close(lock);
+        return false;
+    }
+
+    while (true) {
+        struct pollfd descriptor = { listener, POLLIN, 0 };
+        int ready = ::poll(&descriptor, 1, _idleTimeout * 1000);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        } else if (ready <= 0) {
+            /* Idle for long enough, or something went wrong. */
+            break;
+        }
+
+        int connection = ::accept(listener, nullptr, nullptr);
+        if (connection < 0) {
+            continue;
+        }
+
+        std::vector<int> descriptors;
+        ext::optional<Request> request = Request::Receive(connection, &descriptors);
+
+        if (request && descriptors.size() == 3) {
+            pid_t pid = ::fork();
+            if (pid == 0) {
+                ::close(listener);
+                ::close(lock);
+
+                /* Tools wait for their own children, so need them kept around. */
+                ::signal(SIGCHLD, SIG_DFL);
+                ::signal(SIGPIPE, SIG_DFL);
+
+                int status = RunRequest(&_registry, *request, descriptors);
+
+                /* Report the status to the client, which is waiting on it. */
+                uint8_t buffer[4];
+                for (size_t n = 0; n < sizeof(buffer); n++) {
+                    buffer[n] = static_cast<uint8_t>(static_cast<uint32_t>(status) >> (n * 8));
+                }
+                (void)::write(connection, buffer, sizeof(buffer));
+
+                ::_exit(0);
+            }
+        }
+
+        for (int descriptor : descriptors) {
+            ::close(descriptor);
+        }
+        ::close(connection);
+    }
+
+    ::unlink(_socketPath.c_str());
+    ::close(listener);
+    ::close(lock);
+    return true;
+}
+
+std::string Server::
+DefaultSocketPath(std::string const &executableRoot)
+{
+    /* A short hash keeps the path within the limit for socket paths. */
+    std::string hash = Hash::Hex(executableRoot).substr(0, 8);
+
+    std::string temporaryDirectory = "/tmp";
+    if (char const *environmentDirectory = ::getenv("TMPDIR")) {
+        if (*environmentDirectory != '\0') {
+            temporaryDirectory = environmentDirectory;
+        }
+    }
+    if (temporaryDirectory.size() > 1 && temporaryDirectory.back() == '/') {
+        temporaryDirectory.pop_back();
+    }
+
+    return temporaryDirectory + "/xcbuild-builtin-" + std::to_string(::geteuid()) + "/" + hash + ".sock";
+}
+
+bool Server::
+SecureSocketDirectory(std::string const &socketPath, bool create)
+{
+    std::string directory = FSUtil::GetDirectoryName(socketPath);
+    if (directory.empty()) {
+        return false;
+    }
+
+    if (create && ::mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST) {
+        return false;
+    }
+
+    /* Not following links, which could point anywhere. */
+    struct stat st;
+    if (::lstat(directory.c_str(), &st) != 0) {
+        return false;
+    }
+
+    return S_ISDIR(st.st_mode) && st.st_uid == ::geteuid() && (st.st_mode & 077) == 0;
+}
@@ -12,15 +12,15 @@
 
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
-#include <libutil/Subprocess.h>
+#include <libutil/Wildcard.h>
 
-#include <unordered_set>
+#include <algorithm>
 
 using builtin::copy::Driver;
 using builtin::copy::Options;
 using libutil::Filesystem;
 using libutil::FSUtil;
-using libutil::Subprocess;
+using libutil::CompiledWildcard;
 
 Driver::
 Driver()
@@ -39,21 +39,52 @@ name()
 }
 
 static bool
-CopyPath(Filesystem *filesystem, std::string const &inputPath, std::string const &outputPath)
+CopyPath(Filesystem *filesystem, std::vector<CompiledWildcard> const &excludes, std::string const &inputPath, std::string const &outputPath)
 {
-    if (!filesystem->createDirectory(FSUtil::GetDirectoryName(outputPath))) {
-        return false;
-    }
+    if (filesystem->isSymbolicLink(inputPath)) {
+        ext::optional<std::string> target = filesystem->readSymbolicLink(inputPath);
+        if (!target) {
+            fprintf(stderr, "error: unable to read symbolic link '%s'\n", inputPath.c_str());
+            return false;
+        }
 
-    Subprocess cp;
-    if (!cp.execute("/bin/cp", { "-R", inputPath, outputPath }) || cp.exitcode() != 0) {
-        return false;
-    }
+        if (filesystem->isSymbolicLink(outputPath) || (filesystem->exists(outputPath) && !filesystem->isDirectory(outputPath))) {
+            filesystem->removeFile(outputPath);
+        }
+
+        if (!filesystem->writeSymbolicLink(*target, outputPath)) {
+            fprintf(stderr, "error: unable to create symbolic link '%s'\n", outputPath.c_str());
+            return false;
+        }
+    } else if (filesystem->isDirectory(inputPath)) {
+        if (!filesystem->createDirectory(outputPath)) {
+            fprintf(stderr, "error: unable to create directory '%s'\n", outputPath.c_str());
+            return false;
+        }
 
-    /* Should preserve permissions but make writable. */
-    Subprocess chmod;
-    if (!chmod.execute("/bin/chmod", { "-R", "+w", outputPath }) || chmod.exitcode() != 0) {
-        return false;
+        std::vector<std::string> names;
+        if (!filesystem->enumerateDirectory(inputPath, [&](std::string const &name) {
+            names.push_back(name);
+        })) {
+            fprintf(stderr, "error: unable to read directory '%s'\n", inputPath.c_str());
+            return false;
+        }
+
+        for (std::string const &name : names) {
+            if (std::any_of(excludes.begin(), excludes.end(), [&](CompiledWildcard const &exclude) { return exclude.match(name); })) {
+                continue;
+            }
+
+            if (!CopyPath(filesystem, excludes, inputPath + "/" + name, outputPath + "/" + name)) {
+                return false;
+            }
+        }
+    } else {
+        /* Keeps permissions but makes writable, sharing storage if possible. */
+        if (!filesystem->copyFile(inputPath, outputPath)) {
+            fprintf(stderr, "error: unable to copy '%s' to '%s'\n", inputPath.c_str(), outputPath.c_str());
+            return false;
+        }
     }
 
     return true;
@@ -74,7 +105,11 @@ Run(Filesystem *filesystem, Options const &options, std::string const &workingDi
     }
 
     std::string const &output = FSUtil::ResolveRelativePath(options.output(), workingDirectory);
-    auto excludes = std::unordered_set<std::string>(options.excludes().begin(), options.excludes().end());
+    /* Excludes are patterns, matched against each name in the copied directories. */
+    std::vector<CompiledWildcard> excludes;
+    for (std::string const &exclude : options.excludes()) {
+        excludes.push_back(CompiledWildcard(exclude));
+    }
 
     for (std::string input : options.inputs()) {
         input = FSUtil::ResolveRelativePath(input, workingDirectory);
@@ -96,8 +131,13 @@ Run(Filesystem *filesystem, Options const &options, std::string const &workingDi
             printf("verbose: copying %s -> %s\n", input.c_str(), output.c_str());
         }
 
+        if (!filesystem->createDirectory(output)) {
+            fprintf(stderr, "error: unable to create directory '%s'\n", output.c_str());
+            return 1;
+        }
+
         std::string outputPath = output + "/" + FSUtil::GetBaseName(input);
-        if (!CopyPath(filesystem, input, outputPath)) {
+        if (!CopyPath(filesystem, excludes, input, outputPath)) {
             return 1;
         }
     }
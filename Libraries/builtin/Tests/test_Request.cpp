@@ -0,0 +1,68 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <builtin/Request.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+using builtin::Request;
+
+TEST(Request, Serialize)
+{
+    Request request = Request("builtin-copy", { "-strip-debug-symbols", "in file", "" }, { { "A", "1" }, { "B", "" } }, "/tmp");
+
+    ext::optional<Request> parsed = Request::Deserialize(request.serialize());
+    ASSERT_NE(ext::nullopt, parsed);
+    EXPECT_EQ(request.name(), parsed->name());
+    EXPECT_EQ(request.arguments(), parsed->arguments());
+    EXPECT_EQ(request.environment(), parsed->environment());
+    EXPECT_EQ(request.workingDirectory(), parsed->workingDirectory());
+
+    /* Truncated, extended, or foreign contents are rejected. */
+    std::vector<uint8_t> contents = request.serialize();
+    contents.pop_back();
+    EXPECT_EQ(ext::nullopt, Request::Deserialize(contents));
+    contents = request.serialize();
+    contents.push_back(0);
+    EXPECT_EQ(ext::nullopt, Request::Deserialize(contents));
+    EXPECT_EQ(ext::nullopt, Request::Deserialize({ 'x' }));
+}
+
+TEST(Request, SendReceive)
+{
+    int sockets[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+
+    int pipes[2];
+    ASSERT_EQ(0, ::pipe(pipes));
+
+    Request request = Request("builtin-copyPlist", { "--convert", "binary1" }, { { "PATH", "/usr/bin" } }, "/");
+    ASSERT_TRUE(request.send(sockets[0], { pipes[1] }));
+
+    std::vector<int> descriptors;
+    ext::optional<Request> received = Request::Receive(sockets[1], &descriptors);
+    ASSERT_NE(ext::nullopt, received);
+    EXPECT_EQ(request.name(), received->name());
+    EXPECT_EQ(request.arguments(), received->arguments());
+
+    /* The received descriptor refers to the same pipe. */
+    ASSERT_EQ(1, descriptors.size());
+    ASSERT_EQ(1, ::write(descriptors[0], "x", 1));
+    char buffer = 0;
+    ASSERT_EQ(1, ::read(pipes[0], &buffer, 1));
+    EXPECT_EQ('x', buffer);
+
+    ::close(descriptors[0]);
+    ::close(pipes[0]);
+    ::close(pipes[1]);
+    ::close(sockets[0]);
+    ::close(sockets[1]);
+}
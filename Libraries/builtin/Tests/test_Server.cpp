@@ -0,0 +1,90 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <builtin/Client.h>
+#include <builtin/Server.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using builtin::Client;
+using builtin::Request;
+using builtin::Server;
+
+TEST(Server, SecureSocketDirectory)
+{
+    char temporary[] = "/tmp/Server.XXXXXX";
+    ASSERT_NE(nullptr, ::mkdtemp(temporary));
+    std::string root = temporary;
+
+    /* Created private to this user. */
+    std::string directory = root + "/private";
+    EXPECT_FALSE(Server::SecureSocketDirectory(directory + "/server.sock", false));
+    EXPECT_TRUE(Server::SecureSocketDirectory(directory + "/server.sock", true));
+    EXPECT_TRUE(Server::SecureSocketDirectory(directory + "/server.sock", false));
+
+    struct stat st;
+    ASSERT_EQ(0, ::stat(directory.c_str(), &st));
+    EXPECT_EQ(0700, st.st_mode & 0777);
+
+    /* Others can get at the socket: not trusted, even when creating. */
+    ASSERT_EQ(0, ::chmod(directory.c_str(), 0755));
+    EXPECT_FALSE(Server::SecureSocketDirectory(directory + "/server.sock", false));
+    EXPECT_FALSE(Server::SecureSocketDirectory(directory + "/server.sock", true));
+    ASSERT_EQ(0, ::chmod(directory.c_str(), 0700));
+
+    /* A link could be swapped to point anywhere. */
+    std::string link = root + "/link";
+    ASSERT_EQ(0, ::symlink(directory.c_str(), link.c_str()));
+    EXPECT_FALSE(Server::SecureSocketDirectory(link + "/server.sock", false));
+
+    EXPECT_EQ(0, ::unlink(link.c_str()));
+    EXPECT_EQ(0, ::rmdir(directory.c_str()));
+    EXPECT_EQ(0, ::rmdir(root.c_str()));
+}
+
+TEST(Client, SharedDirectory)
+{
+    char temporary[] = "/tmp/Client.XXXXXX";
+    ASSERT_NE(nullptr, ::mkdtemp(temporary));
+    std::string root = temporary;
+    ASSERT_EQ(0, ::chmod(root.c_str(), 0755));
+
+    /* Something listening where anyone could have put it. */
+    std::string socketPath = root + "/server.sock";
+    struct sockaddr_un address;
+    ::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    ::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_LE(0, listener);
+    ASSERT_EQ(0, ::bind(listener, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)));
+    ASSERT_EQ(0, ::listen(listener, 1));
+
+    /* The client runs the tool itself instead of connecting. */
+    Request request = Request("builtin-copy", { }, { }, "/");
+    EXPECT_EQ(ext::nullopt, Client::Run(socketPath, request));
+
+    ASSERT_EQ(0, ::fcntl(listener, F_SETFL, O_NONBLOCK));
+    EXPECT_GT(0, ::accept(listener, nullptr, nullptr));
+    EXPECT_TRUE(errno == EAGAIN || errno == EWOULDBLOCK);
+
+    ::close(listener);
+    EXPECT_EQ(0, ::unlink(socketPath.c_str()));
+    EXPECT_EQ(0, ::rmdir(root.c_str()));
+}
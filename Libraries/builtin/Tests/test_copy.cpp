@@ -0,0 +1,98 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <builtin/copy/Driver.h>
+#include <libutil/MemoryFilesystem.h>
+
+using builtin::copy::Driver;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+TEST(copy, Name)
+{
+    Driver driver;
+    EXPECT_EQ(driver.name(), "builtin-copy");
+}
+
+TEST(copy, CopyTree)
+{
+    std::vector<uint8_t> contents;
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("file", Contents("one")),
+        MemoryFilesystem::Entry::Directory("tree", {
+            MemoryFilesystem::Entry::File("file", Contents("two")),
+            MemoryFilesystem::Entry::Directory("dir", {
+                MemoryFilesystem::Entry::File("file", Contents("three")),
+                MemoryFilesystem::Entry::File("file.orig", Contents("three")),
+            }),
+            MemoryFilesystem::Entry::Directory(".svn", {
+                MemoryFilesystem::Entry::File("entries", Contents("four")),
+            }),
+        }),
+    });
+
+    Driver driver;
+    EXPECT_EQ(0, driver.run({
+        "-exclude", ".svn",
+        "-exclude", "*.orig",
+        "file",
+        "tree",
+        "output",
+    }, std::unordered_map<std::string, std::string>(), &filesystem, "/"));
+
+    contents.clear();
+    EXPECT_TRUE(filesystem.read(&contents, "/output/file"));
+    EXPECT_EQ(contents, Contents("one"));
+
+    contents.clear();
+    EXPECT_TRUE(filesystem.read(&contents, "/output/tree/file"));
+    EXPECT_EQ(contents, Contents("two"));
+
+    contents.clear();
+    EXPECT_TRUE(filesystem.read(&contents, "/output/tree/dir/file"));
+    EXPECT_EQ(contents, Contents("three"));
+
+    /* Excluded names are skipped anywhere in the tree. */
+    EXPECT_FALSE(filesystem.exists("/output/tree/.svn"));
+    EXPECT_FALSE(filesystem.exists("/output/tree/dir/file.orig"));
+
+    /* Copying again replaces what was copied before. */
+    ASSERT_TRUE(filesystem.write(Contents("changed"), "/tree/dir/file"));
+    EXPECT_EQ(0, driver.run({
+        "tree",
+        "output",
+    }, std::unordered_map<std::string, std::string>(), &filesystem, "/"));
+
+    contents.clear();
+    EXPECT_TRUE(filesystem.read(&contents, "/output/tree/dir/file"));
+    EXPECT_EQ(contents, Contents("changed"));
+}
+
+TEST(copy, MissingInput)
+{
+    MemoryFilesystem filesystem = MemoryFilesystem({ });
+
+    Driver driver;
+    EXPECT_NE(0, driver.run({
+        "missing",
+        "output",
+    }, std::unordered_map<std::string, std::string>(), &filesystem, "/"));
+
+    EXPECT_EQ(0, driver.run({
+        "-ignore-missing-inputs",
+        "missing",
+        "output",
+    }, std::unordered_map<std::string, std::string>(), &filesystem, "/"));
+}
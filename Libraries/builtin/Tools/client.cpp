@@ -0,0 +1,72 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <builtin/Client.h>
+#include <builtin/Server.h>
+#include <libutil/FSUtil.h>
+#include <libutil/SysUtil.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+
+#include <unistd.h>
+
+using libutil::FSUtil;
+using libutil::SysUtil;
+
+int
+main(int argc, char **argv, char **envp)
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage: builtin-client builtin-tool [arguments]\n");
+        return 1;
+    }
+
+    std::string executableRoot = FSUtil::GetDirectoryName(SysUtil::GetExecutablePath());
+    std::string socketPath = builtin::Server::DefaultSocketPath(executableRoot);
+
+    std::string name = argv[1];
+    std::vector<std::string> arguments = std::vector<std::string>(argv + 2, argv + argc);
+    builtin::Request request = builtin::Request(name, arguments, SysUtil::EnvironmentVariables(), FSUtil::GetCurrentDirectory());
+
+    /*
+     * Use a running server if there is one.
+     */
+    if (ext::optional<int> status = builtin::Client::Run(socketPath, request)) {
+        return *status;
+    }
+
+    /*
+     * Otherwise, start one for this and later requests, and wait briefly
+     * for it to start listening.
+     */
+    if (builtin::Client::StartServer(executableRoot + "/builtin-server", socketPath)) {
+        for (int attempt = 0; attempt < 50; attempt++) {
+            ::usleep(10 * 1000);
+
+            if (ext::optional<int> status = builtin::Client::Run(socketPath, request)) {
+                return *status;
+            }
+        }
+    }
+
+    /*
+     * Without a server, run the standalone tool instead.
+     */
+    std::string path = executableRoot + "/" + name;
+
+    /* The client ignores SIGPIPE, but the tool shouldn't inherit that. */
+    ::signal(SIGPIPE, SIG_DFL);
+    ::execve(path.c_str(), argv + 1, envp);
+
+    fprintf(stderr, "error: unable to run %s: %s\n", path.c_str(), strerror(errno));
+    return 1;
+}
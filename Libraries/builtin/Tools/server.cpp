@@ -0,0 +1,44 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <builtin/Server.h>
+#include <libutil/FSUtil.h>
+#include <libutil/SysUtil.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using libutil::FSUtil;
+using libutil::SysUtil;
+
+int
+main(int argc, char **argv)
+{
+    std::string socketPath;
+    int idleTimeout = 300;
+
+    for (int n = 1; n < argc; n++) {
+        if (::strcmp(argv[n], "--socket") == 0 && n + 1 < argc) {
+            socketPath = argv[++n];
+        } else if (::strcmp(argv[n], "--idle-timeout") == 0 && n + 1 < argc) {
+            idleTimeout = ::atoi(argv[++n]);
+        } else {
+            fprintf(stderr, "Usage: builtin-server [--socket path] [--idle-timeout seconds]\n");
+            return 1;
+        }
+    }
+
+    if (socketPath.empty()) {
+        socketPath = builtin::Server::DefaultSocketPath(FSUtil::GetDirectoryName(SysUtil::GetExecutablePath()));
+    }
+
+    builtin::Server server = builtin::Server(builtin::Registry::Default(), socketPath, idleTimeout);
+    return (server.run() ? 0 : 1);
+}
@@ -37,7 +37,7 @@ serialize() const
             }
 
             /* Add the output. */
-            result += Escape::Makefile(output);
+            Escape::Makefile(output, &result);
         }
 
         /* Add separator. */
@@ -47,7 +47,7 @@ serialize() const
         for (std::string const &input : dependencyInfo.inputs()) {
             result += " \\\n";
             result += "  ";
-            result += Escape::Makefile(input);
+            Escape::Makefile(input, &result);
         }
 
         if (&dependencyInfo != &_dependencyInfo.back()) {
@@ -82,6 +82,11 @@ bom_alloc_empty(struct bom_context_memory memory)
 struct bom_context *
 bom_alloc_load(struct bom_context_memory memory)
 {
+    if (memory.data == NULL) {
+        /* The memory couldn't be loaded, so there is nothing to free. */
+        return NULL;
+    }
+
     struct bom_context *context = _bom_alloc(memory);
     if (context == NULL) {
         memory.free(&memory);
@@ -103,7 +103,16 @@ bom_context_memory_file(const char *fn, bool writeable, size_t minimum_size)
     }
 
     struct stat st;
-    fstat(fd, &st);
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return (struct bom_context_memory) {
+            .data = NULL,
+            .size = 0,
+            .resize = NULL,
+            .free = NULL,
+            .ctx = NULL,
+        };
+    }
 
     // Expand file to minimum_size
     if (st.st_size < (off_t)minimum_size) {
@@ -120,14 +129,24 @@ bom_context_memory_file(const char *fn, bool writeable, size_t minimum_size)
         }
     }
 
+    int prot = writeable ? PROT_READ | PROT_WRITE : PROT_READ;
+    size_t size = st.st_size < (off_t)minimum_size ? minimum_size : st.st_size;
+    void *data = mmap(NULL, size, prot, (writeable ? MAP_SHARED : MAP_PRIVATE), fd, 0);
+    if (data == MAP_FAILED) {
+        close(fd);
+        return (struct bom_context_memory) {
+            .data = NULL,
+            .size = 0,
+            .resize = NULL,
+            .free = NULL,
+            .ctx = NULL,
+        };
+    }
+
     struct _bom_context_memory_mmap_context *context = malloc(sizeof(*context));
     context->fd = fd;
     context->writeable = writeable;
 
-    int prot = context->writeable ? PROT_READ | PROT_WRITE : PROT_READ;
-    size_t size = st.st_size < (off_t)minimum_size ? minimum_size : st.st_size;
-    void *data = mmap(NULL, size, prot, (writeable ? MAP_SHARED : MAP_PRIVATE), context->fd, 0);
-
     return (struct bom_context_memory) {
         .data = data,
         .size = size,
@@ -0,0 +1,110 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __libutil_CachingFilesystem_h
+#define __libutil_CachingFilesystem_h
+
+#include <libutil/Filesystem.h>
+
+#include <mutex>
+#include <unordered_map>
+
+namespace libutil {
+
+/*
+ * Wraps another filesystem, remembering the answer to each test of a path
+ * so the same path is only looked at once. Changes made through this
+ * filesystem update what it remembers; changes made any other way are not
+ * seen, so it should only be used while nothing else changes those paths.
+ */
+class CachingFilesystem : public Filesystem {
+private:
+    struct Entry {
+        ext::optional<Status> status;
+        ext::optional<bool>   isReadable;
+        ext::optional<bool>   isWritable;
+        ext::optional<bool>   isExecutable;
+    };
+
+private:
+    Filesystem                                     *_filesystem;
+
+private:
+    mutable std::mutex                             _mutex;
+    mutable std::unordered_map<std::string, Entry> _entries;
+    mutable uint64_t                               _lookups;
+    mutable uint64_t                               _misses;
+
+public:
+    CachingFilesystem(Filesystem *filesystem);
+    ~CachingFilesystem();
+
+public:
+    /*
+     * The wrapped filesystem.
+     */
+    Filesystem *filesystem() const
+    { return _filesystem; }
+
+public:
+    /*
+     * Forget what is known about a path, after it changed elsewhere.
+     */
+    void invalidate(std::string const &path);
+
+    /*
+     * How many tests were made, and how many of those went to the wrapped
+     * filesystem because the answer wasn't known yet.
+     */
+    uint64_t lookups() const;
+    uint64_t misses() const;
+
+private:
+    bool permission(std::string const &path, ext::optional<bool> Entry::*field, std::function<bool()> const &lookup) const;
+
+public:
+    virtual bool exists(std::string const &path) const;
+
+public:
+    virtual bool isDirectory(std::string const &path) const;
+    virtual bool isSymbolicLink(std::string const &path) const;
+    virtual Status status(std::string const &path) const;
+
+public:
+    virtual bool isReadable(std::string const &path) const;
+    virtual bool isWritable(std::string const &path) const;
+    virtual bool isExecutable(std::string const &path) const;
+
+public:
+    virtual bool createFile(std::string const &path);
+    virtual bool createDirectory(std::string const &path);
+
+public:
+    virtual bool read(std::vector<uint8_t> *contents, std::string const &path) const;
+    virtual bool map(MappedBuffer *contents, std::string const &path) const;
+    virtual bool write(std::vector<uint8_t> const &contents, std::string const &path);
+    virtual ext::optional<std::string> readSymbolicLink(std::string const &path) const;
+    virtual bool writeSymbolicLink(std::string const &target, std::string const &path);
+    virtual bool copyFile(std::string const &from, std::string const &to);
+
+public:
+    virtual bool removeFile(std::string const &path);
+
+public:
+    virtual std::string resolvePath(std::string const &path) const;
+
+public:
+    virtual bool enumerateDirectory(
+        std::string const &path,
+        std::function<void(std::string const &)> const &cb) const;
+};
+
+}
+
+#endif  // !__libutil_CachingFilesystem_h
@@ -21,6 +21,7 @@ public:
 public:
     virtual bool isDirectory(std::string const &path) const;
     virtual bool isSymbolicLink(std::string const &path) const;
+    virtual Status status(std::string const &path) const;
 
 public:
     virtual bool isReadable(std::string const &path) const;
@@ -33,9 +34,11 @@ public:
 
 public:
     virtual bool read(std::vector<uint8_t> *contents, std::string const &path) const;
+    virtual bool map(MappedBuffer *contents, std::string const &path) const;
     virtual bool write(std::vector<uint8_t> const &contents, std::string const &path);
     virtual ext::optional<std::string> readSymbolicLink(std::string const &path) const;
     virtual bool writeSymbolicLink(std::string const &target, std::string const &path);
+    virtual bool copyFile(std::string const &from, std::string const &to);
 
 public:
     virtual bool removeFile(std::string const &path);
@@ -47,6 +50,9 @@ public:
     virtual bool enumerateDirectory(
         std::string const &path,
         std::function<void(std::string const &)> const &cb) const;
+    virtual bool enumerateRecursive(
+        std::string const &path,
+        std::function<bool(std::string const &)> const &cb) const;
 };
 
 }
@@ -0,0 +1,83 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __libutil_DirectoryWalker_h
+#define __libutil_DirectoryWalker_h
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <time.h>
+
+namespace libutil {
+
+/*
+ * Walks a directory tree, reading directories on several threads at once.
+ * The type of each entry comes from the directory listing where available,
+ * so most entries need no stat. Symbolic links are reported but never
+ * followed.
+ */
+class DirectoryWalker {
+public:
+    enum class Type {
+        File,
+        Directory,
+        SymbolicLink,
+        Other,
+    };
+
+    struct Entry {
+        std::string name;
+        Type        type;
+
+        /*
+         * A directory, or a symbolic link to one.
+         */
+        bool        directory;
+    };
+
+    /*
+     * The entries of one directory, delivered together.
+     */
+    struct Directory {
+        /*
+         * Relative to the root of the walk; empty for the root itself.
+         */
+        std::string        path;
+        struct timespec    modificationTime;
+        std::vector<Entry> entries;
+    };
+
+private:
+    bool   _ordered;
+    size_t _threads;
+
+public:
+    /*
+     * If ordered, directories are delivered in the order a serial depth-first
+     * walk would read them. Otherwise, as soon as each has been read. No more
+     * than one directory is delivered at a time either way. Threads beyond
+     * the calling one are only started while there is more to read than
+     * running threads can take. By default, all walks in the process share
+     * a thread per processor between them.
+     */
+    DirectoryWalker(bool ordered, size_t threads = 0);
+
+public:
+    /*
+     * Walk the tree under a directory. Fails only if the root can't be read;
+     * directories below it that can't be read are skipped.
+     */
+    bool walk(std::string const &root, std::function<void(Directory const &)> const &callback) const;
+};
+
+}
+
+#endif  // !__libutil_DirectoryWalker_h
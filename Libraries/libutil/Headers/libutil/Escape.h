@@ -26,11 +26,25 @@ public:
     static std::string
     Shell(std::string const &value);
 
+    /*
+     * Shell-escapes a string, appending it to a buffer. Strings that need no
+     * quoting are appended as they are, so building up a command line this
+     * way allocates only when the buffer grows.
+     */
+    static void
+    Shell(std::string const &value, std::string *result);
+
     /*
      * Escape a file path for a Makefile.
      */
     static std::string
     Makefile(std::string const &value);
+
+    /*
+     * Escape a file path for a Makefile, appending it to a buffer.
+     */
+    static void
+    Makefile(std::string const &value, std::string *result);
 };
 
 }
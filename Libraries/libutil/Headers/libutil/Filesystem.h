@@ -10,6 +10,8 @@
 #ifndef __libutil_Filesystem_h
 #define __libutil_Filesystem_h
 
+#include <libutil/MappedBuffer.h>
+
 #include <functional>
 #include <string>
 #include <vector>
@@ -35,6 +37,23 @@ public:
      */
     virtual bool isSymbolicLink(std::string const &path) const = 0;
 
+public:
+    /*
+     * What is at a path. Symbolic links are followed, except to tell if the
+     * path is itself one.
+     */
+    struct Status {
+        bool exists;
+        bool isDirectory;
+        bool isSymbolicLink;
+    };
+
+    /*
+     * Test what is at a path all at once, with a single lookup where the
+     * filesystem can.
+     */
+    virtual Status status(std::string const &path) const;
+
 public:
     /*
      * Test if a file is readable.
@@ -68,6 +87,12 @@ public:
      */
     virtual bool read(std::vector<uint8_t> *contents, std::string const &path) const = 0;
 
+    /*
+     * Read from a file without copying it, where possible. Large files are
+     * mapped into memory; anything else is read as usual.
+     */
+    virtual bool map(MappedBuffer *contents, std::string const &path) const;
+
     /*
      * Write to a file.
      */
@@ -83,6 +108,13 @@ public:
      */
     virtual bool writeSymbolicLink(std::string const &target, std::string const &path) = 0;
 
+    /*
+     * Copy a file, replacing rather than writing into the destination. The
+     * copy keeps the permissions of the original and is writable by its
+     * owner. Shares storage with the original where the filesystem can.
+     */
+    virtual bool copyFile(std::string const &from, std::string const &to) = 0;
+
 public:
     /*
      * Delete a file.
@@ -104,9 +136,10 @@ public:
         std::function<void(std::string const &)> const &cb) const = 0;
 
     /*
-     * Enumerate the contents of a directory recursively.
+     * Enumerate the contents of a directory recursively. Each directory's
+     * contents are listed before those of its subdirectories.
      */
-    bool enumerateRecursive(
+    virtual bool enumerateRecursive(
         std::string const &path,
         std::function<bool(std::string const &)> const &cb) const;
 
@@ -0,0 +1,81 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __libutil_Hash_h
+#define __libutil_Hash_h
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace libutil {
+
+/*
+ * A fast, non-cryptographic 128-bit hash (MurmurHash3, x64 variant), for
+ * cache keys and generated file names. Much faster than MD5, but it makes
+ * no attempt to resist inputs chosen to collide, so it is not for anything
+ * security sensitive. Input can be added in pieces; the result is the same
+ * as adding it all at once.
+ */
+class Hash {
+private:
+    uint64_t _h1;
+    uint64_t _h2;
+    uint64_t _length;
+
+private:
+    /*
+     * Input not yet hashed, waiting for a full block.
+     */
+    uint8_t  _buffer[16];
+    size_t   _buffered;
+
+public:
+    explicit Hash(uint64_t seed = 0);
+
+public:
+    void update(void const *data, size_t size);
+
+    void update(std::string const &string)
+    { update(string.data(), string.size()); }
+
+    /*
+     * Add the size and then the contents of a file, so whatever is added
+     * next can't be mistaken for part of the file. Large files are mapped
+     * rather than read. Fails if the path isn't a readable regular file.
+     */
+    bool updateFile(std::string const &path);
+
+public:
+    /*
+     * The hash of everything added so far. More can still be added after.
+     */
+    std::pair<uint64_t, uint64_t> digest() const;
+
+    uint64_t digest64() const
+    { return digest().first; }
+
+    /*
+     * The 128-bit hash as 32 lowercase hexadecimal digits.
+     */
+    std::string hex() const;
+
+public:
+    /*
+     * Hash a string, as 32 lowercase hexadecimal digits.
+     */
+    static std::string Hex(std::string const &string);
+
+private:
+    void block(uint8_t const *data);
+};
+
+}
+
+#endif  // !__libutil_Hash_h
@@ -0,0 +1,79 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __libutil_MappedBuffer_h
+#define __libutil_MappedBuffer_h
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <ext/optional>
+
+namespace libutil {
+
+/*
+ * Read-only contents of a file. Either mapped from the file, so the contents
+ * are read straight from the page cache, or held in memory. Either way, the
+ * contents stay valid for as long as the buffer does.
+ */
+class MappedBuffer {
+private:
+    uint8_t const        *_data;
+    size_t                _size;
+    bool                  _mapped;
+    std::vector<uint8_t>  _contents;
+
+public:
+    MappedBuffer();
+    explicit MappedBuffer(std::vector<uint8_t> &&contents);
+    MappedBuffer(MappedBuffer &&other);
+    ~MappedBuffer();
+
+    MappedBuffer &operator=(MappedBuffer &&other);
+
+private:
+    MappedBuffer(MappedBuffer const &) = delete;
+    MappedBuffer &operator=(MappedBuffer const &) = delete;
+
+public:
+    uint8_t const *data() const
+    { return _data; }
+    size_t size() const
+    { return _size; }
+    bool empty() const
+    { return _size == 0; }
+
+public:
+    uint8_t const *begin() const
+    { return _data; }
+    uint8_t const *end() const
+    { return _data + _size; }
+
+public:
+    /*
+     * If the contents are mapped from a file, rather than held in memory.
+     */
+    bool mapped() const
+    { return _mapped; }
+
+private:
+    void reset();
+
+public:
+    /*
+     * Map the first bytes of an open file. The descriptor can be closed
+     * afterwards; the mapping stays valid until the buffer is destroyed.
+     */
+    static ext::optional<MappedBuffer>
+    Map(int fd, size_t size);
+};
+
+}
+
+#endif  // !__libutil_MappedBuffer_h
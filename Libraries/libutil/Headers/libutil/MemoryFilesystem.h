@@ -12,6 +12,10 @@
 
 #include <libutil/Filesystem.h>
 
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
 namespace libutil {
 
 class MemoryFilesystem : public Filesystem {
@@ -29,7 +33,14 @@ public:
     public:
         Type                 _type;
         std::vector<uint8_t> _contents;
-        std::vector<Entry>   _children;
+
+    private:
+        /*
+         * Children are never moved once added, except by removing one
+         * before them, so pointers to them stay valid. Indexed by name.
+         */
+        std::deque<Entry>                       _children;
+        std::unordered_map<std::string, size_t> _index;
 
     private:
         Entry(std::string const &name, Type type);
@@ -47,29 +58,64 @@ public:
         { return _contents; }
         std::vector<uint8_t> const &contents() const
         { return _contents; }
-        std::vector<Entry> &children()
-        { return _children; }
-        std::vector<Entry> const &children() const
+        std::deque<Entry> const &children() const
         { return _children; }
 
     public:
         MemoryFilesystem::Entry *child(std::string const &name);
         MemoryFilesystem::Entry const *child(std::string const &name) const;
 
+    public:
+        /*
+         * Add a child. If one already has the same name, it's kept instead.
+         */
+        MemoryFilesystem::Entry *add(Entry &&entry);
+
+        /*
+         * Remove a child by name. Moves the children added after it.
+         */
+        bool remove(std::string const &name);
+
     public:
         static Entry File(std::string const &name, std::vector<uint8_t> const &contents);
         static Entry Directory(std::string const &name, std::vector<Entry> const &children);
     };
 
 private:
-    Entry _root;
+    /*
+     * Directories found by earlier lookups, by path, so most lookups only
+     * need to find the last component. Points into the entries, so copying
+     * the filesystem starts the copy with an empty cache.
+     */
+    class DirectoryCache {
+    public:
+        std::mutex                               mutex;
+        std::unordered_map<std::string, Entry *> directories;
+
+    public:
+        DirectoryCache()
+        { }
+        DirectoryCache(DirectoryCache const &other)
+        { }
+
+    public:
+        DirectoryCache &operator=(DirectoryCache const &other)
+        { directories.clear(); return *this; }
+    };
+
+private:
+    Entry                  _root;
+    mutable DirectoryCache _cache;
 
 public:
     MemoryFilesystem(std::vector<Entry> const &entries);
 
 public:
-    Entry &root()
-    { return _root; }
+    /*
+     * The root directory. Changing entries through it directly, rather
+     * than through the filesystem, drops the directory cache.
+     */
+    Entry &root();
     Entry const &root() const
     { return _root; }
 
@@ -94,6 +140,7 @@ public:
     virtual bool write(std::vector<uint8_t> const &contents, std::string const &path);
     virtual ext::optional<std::string> readSymbolicLink(std::string const &path) const;
     virtual bool writeSymbolicLink(std::string const &target, std::string const &path);
+    virtual bool copyFile(std::string const &from, std::string const &to);
 
 public:
     virtual bool removeFile(std::string const &path);
@@ -105,6 +152,10 @@ public:
     virtual bool enumerateDirectory(
         std::string const &path,
         std::function<void(std::string const &)> const &cb) const;
+
+private:
+    template<typename T, typename U, typename V>
+    static bool WalkPath(U filesystem, std::string const &path, bool all, V const &cb);
 };
 
 }
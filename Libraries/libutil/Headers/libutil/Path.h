@@ -0,0 +1,108 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __libutil_Path_h
+#define __libutil_Path_h
+
+#include <functional>
+#include <string>
+
+namespace libutil {
+
+/*
+ * A normalized path, interned so each distinct path is stored only once.
+ * Copying, comparing and hashing a path costs no more than a pointer. The
+ * directories containing a path are interned along with it, and shared by
+ * every path inside them, so each path adds only its last component. Interned
+ * paths are kept for the life of the process, so this is meant for paths in
+ * a build graph, not arbitrary ones.
+ */
+class Path {
+private:
+    struct Node;
+
+private:
+    Node const *_node;
+
+private:
+    explicit Path(Node const *node);
+
+private:
+    static Node const *Intern(std::string const &path);
+
+public:
+    /*
+     * The empty path.
+     */
+    Path();
+
+    /*
+     * Normalizes and interns a path. Safe to call from any thread.
+     */
+    explicit Path(std::string const &path);
+
+public:
+    /*
+     * The normalized path. Built from the components on first use.
+     */
+    std::string const &string() const;
+
+    bool empty() const
+    { return _node == nullptr; }
+
+public:
+    /*
+     * The directory containing this path. Empty for the root, or for a
+     * relative path with a single component.
+     */
+    Path parent() const;
+
+    /*
+     * The last component of the path.
+     */
+    std::string base() const;
+
+    /*
+     * If this path is somewhere inside a directory, not counting the
+     * directory itself.
+     */
+    bool inside(Path const &directory) const;
+
+public:
+    bool operator==(Path const &other) const
+    { return _node == other._node; }
+    bool operator!=(Path const &other) const
+    { return _node != other._node; }
+
+    /*
+     * Orders by the path, so the order doesn't depend on interning.
+     */
+    bool operator<(Path const &other) const
+    { return string() < other.string(); }
+
+public:
+    size_t hash() const
+    { return std::hash<Node const *>()(_node); }
+};
+
+}
+
+namespace std {
+
+template<>
+struct hash<libutil::Path> {
+    size_t operator()(libutil::Path const &path) const
+    {
+        return path.hash();
+    }
+};
+
+}
+
+#endif  // !__libutil_Path_h
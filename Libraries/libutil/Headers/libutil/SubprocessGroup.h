@@ -0,0 +1,99 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __libutil_SubprocessGroup_h
+#define __libutil_SubprocessGroup_h
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <ext/optional>
+
+#include <sys/types.h>
+
+namespace libutil {
+
+/*
+ * Runs any number of child processes at once. Each child's input is written
+ * and its output and error are read as the child is able to, so no child can
+ * block on a full pipe. When a child exits, its completion is called from
+ * whichever of poll() or wait() is running, on the thread calling it.
+ */
+class SubprocessGroup {
+public:
+    /*
+     * What a child did once it exited.
+     */
+    struct Result {
+        /*
+         * The child's exit status. For a child killed by a signal, this is
+         * 128 plus the signal number, as shells report it.
+         */
+        int         exitcode;
+
+        /*
+         * Captured output and error. Empty unless capture was requested.
+         */
+        std::string output;
+        std::string error;
+    };
+
+    typedef std::function<void(Result const &result)> Completion;
+
+private:
+    struct Child;
+    std::vector<std::unique_ptr<Child>> _children;
+
+public:
+    SubprocessGroup();
+    ~SubprocessGroup();
+
+public:
+    /*
+     * Start a child. Without input, the child shares standard input with
+     * this process; likewise for output and error when not captured. An
+     * empty directory runs the child in the current directory. Fails if
+     * the child could not be started, in which case the completion is
+     * never called.
+     */
+    bool spawn(
+        std::string const &path,
+        std::vector<std::string> const &arguments,
+        std::unordered_map<std::string, std::string> const &environment,
+        std::string const &directory,
+        ext::optional<std::string> const &input,
+        bool captureOutput,
+        bool captureError,
+        Completion const &completion);
+
+public:
+    /*
+     * How many children have not yet finished.
+     */
+    size_t running() const
+    { return _children.size(); }
+
+    /*
+     * Handle any input, output, or exits, waiting up to the timeout in
+     * milliseconds for one to happen. A negative timeout waits until one
+     * does. Returns if any children are still running.
+     */
+    bool poll(int timeout);
+
+    /*
+     * Run until every child has finished.
+     */
+    void wait();
+};
+
+}
+
+#endif  // !__libutil_SubprocessGroup_h
@@ -10,14 +10,64 @@
 #ifndef __libutil_Wildcard_h
 #define __libutil_Wildcard_h
 
+#include <bitset>
 #include <string>
+#include <vector>
 
 namespace libutil {
 
+/*
+ * Patterns are matched against the whole string. A '*' matches any number
+ * of characters, and a '[...]' matches any one of the characters listed.
+ * Anything else matches itself.
+ */
 struct Wildcard {
     static bool Match(std::string const &pattern, std::string const &string);
 };
 
+/*
+ * A wildcard pattern parsed once, to match against many strings. The
+ * pattern is split at each '*' into segments: the first must match at the
+ * start of the string, the last at the end, and the rest in order in
+ * between. Matching never allocates.
+ */
+class CompiledWildcard {
+private:
+    struct Segment {
+        size_t offset;
+        size_t length;
+
+        /*
+         * Contains no character classes, so can be compared directly.
+         */
+        bool   literal;
+    };
+
+private:
+    /*
+     * The character to match at each position, or for a class, which of
+     * the class bitsets to check instead.
+     */
+    std::string                  _characters;
+    std::vector<int>             _classes;
+    std::vector<std::bitset<256>> _sets;
+
+private:
+    std::vector<Segment>         _segments;
+
+public:
+    explicit CompiledWildcard(std::string const &pattern);
+
+public:
+    bool match(char const *string, size_t size) const;
+
+    bool match(std::string const &string) const
+    { return match(string.data(), string.size()); }
+
+private:
+    bool matchAt(Segment const &segment, char const *string) const;
+};
+
 }
 
 #endif  // !__libutil_Wildcard_h
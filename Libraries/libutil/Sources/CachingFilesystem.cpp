@@ -0,0 +1,230 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <libutil/CachingFilesystem.h>
+#include <libutil/FSUtil.h>
+
+using libutil::CachingFilesystem;
+using libutil::Filesystem;
+using libutil::MappedBuffer;
+
+CachingFilesystem::
+CachingFilesystem(Filesystem *filesystem) :
+    _filesystem(filesystem),
+    _lookups   (0),
+    _misses    (0)
+{
+}
+
+CachingFilesystem::
+~CachingFilesystem()
+{
+}
+
+void CachingFilesystem::
+invalidate(std::string const &path)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.erase(path);
+}
+
+uint64_t CachingFilesystem::
+lookups() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _lookups;
+}
+
+uint64_t CachingFilesystem::
+misses() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _misses;
+}
+
+CachingFilesystem::Status CachingFilesystem::
+status(std::string const &path) const
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _lookups++;
+
+        auto it = _entries.find(path);
+        if (it != _entries.end() && it->second.status) {
+            return *it->second.status;
+        }
+
+        _misses++;
+    }
+
+    /* Not under the lock, so other paths can be tested meanwhile. */
+    Status status = _filesystem->status(path);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries[path].status = status;
+    return status;
+}
+
+bool CachingFilesystem::
+permission(std::string const &path, ext::optional<bool> Entry::*field, std::function<bool()> const &lookup) const
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _lookups++;
+
+        auto it = _entries.find(path);
+        if (it != _entries.end()) {
+            Entry const &entry = it->second;
+            if (entry.*field) {
+                return *(entry.*field);
+            }
+
+            /* Nothing is permitted on a path that doesn't exist. */
+            if (entry.status && !entry.status->exists) {
+                return false;
+            }
+        }
+
+        _misses++;
+    }
+
+    bool result = lookup();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries[path].*field = result;
+    return result;
+}
+
+bool CachingFilesystem::
+exists(std::string const &path) const
+{
+    return status(path).exists;
+}
+
+bool CachingFilesystem::
+isDirectory(std::string const &path) const
+{
+    return status(path).isDirectory;
+}
+
+bool CachingFilesystem::
+isSymbolicLink(std::string const &path) const
+{
+    return status(path).isSymbolicLink;
+}
+
+bool CachingFilesystem::
+isReadable(std::string const &path) const
+{
+    return permission(path, &Entry::isReadable, [&]() { return _filesystem->isReadable(path); });
+}
+
+bool CachingFilesystem::
+isWritable(std::string const &path) const
+{
+    return permission(path, &Entry::isWritable, [&]() { return _filesystem->isWritable(path); });
+}
+
+bool CachingFilesystem::
+isExecutable(std::string const &path) const
+{
+    return permission(path, &Entry::isExecutable, [&]() { return _filesystem->isExecutable(path); });
+}
+
+bool CachingFilesystem::
+createFile(std::string const &path)
+{
+    bool result = _filesystem->createFile(path);
+    invalidate(path);
+    return result;
+}
+
+bool CachingFilesystem::
+createDirectory(std::string const &path)
+{
+    bool result = _filesystem->createDirectory(path);
+
+    /* Any of the containing directories could have been created too. */
+    std::string current = path;
+    while (true) {
+        invalidate(current);
+
+        std::string parent = FSUtil::GetDirectoryName(current);
+        if (parent == current || parent.empty()) {
+            break;
+        }
+        current = parent;
+    }
+
+    return result;
+}
+
+bool CachingFilesystem::
+read(std::vector<uint8_t> *contents, std::string const &path) const
+{
+    return _filesystem->read(contents, path);
+}
+
+bool CachingFilesystem::
+write(std::vector<uint8_t> const &contents, std::string const &path)
+{
+    bool result = _filesystem->write(contents, path);
+    invalidate(path);
+    return result;
+}
+
+bool CachingFilesystem::
+map(MappedBuffer *contents, std::string const &path) const
+{
+    return _filesystem->map(contents, path);
+}
+
+ext::optional<std::string> CachingFilesystem::
+readSymbolicLink(std::string const &path) const
+{
+    return _filesystem->readSymbolicLink(path);
+}
+
+bool CachingFilesystem::
+writeSymbolicLink(std::string const &target, std::string const &path)
+{
+    bool result = _filesystem->writeSymbolicLink(target, path);
+    invalidate(path);
+    return result;
+}
+
+bool CachingFilesystem::
+copyFile(std::string const &from, std::string const &to)
+{
+    bool result = _filesystem->copyFile(from, to);
+    invalidate(to);
+    return result;
+}
+
+bool CachingFilesystem::
+removeFile(std::string const &path)
+{
+    bool result = _filesystem->removeFile(path);
+    invalidate(path);
+    return result;
+}
+
+std::string CachingFilesystem::
+resolvePath(std::string const &path) const
+{
+    return _filesystem->resolvePath(path);
+}
+
+bool CachingFilesystem::
+enumerateDirectory(
+    std::string const &path,
+    std::function<void(std::string const &)> const &cb) const
+{
+    return _filesystem->enumerateDirectory(path, cb);
+}
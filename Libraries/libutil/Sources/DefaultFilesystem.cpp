@@ -8,6 +8,7 @@
  */
 
 #include <libutil/DefaultFilesystem.h>
+#include <libutil/DirectoryWalker.h>
 #include <libutil/FSUtil.h>
 
 #include <fstream>
@@ -22,9 +23,24 @@
 #include <unistd.h>
 #include <libgen.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 
+#if defined(__APPLE__)
+#include <sys/clonefile.h>
+#elif defined(__linux__)
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#endif
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+#define FILESYSTEM_COPY_FILE_RANGE 1
+#endif
+
 using libutil::DefaultFilesystem;
+using libutil::DirectoryWalker;
+using libutil::MappedBuffer;
 
 bool DefaultFilesystem::
 exists(std::string const &path) const
@@ -52,6 +68,29 @@ isSymbolicLink(std::string const &path) const
         return S_ISLNK(st.st_mode);
 }
 
+DefaultFilesystem::Status DefaultFilesystem::
+status(std::string const &path) const
+{
+    Status status = { false, false, false };
+
+    struct stat st;
+    if (::lstat(path.c_str(), &st) < 0) {
+        return status;
+    }
+
+    /* Only a symbolic link needs a second look, at what it points to. */
+    if (S_ISLNK(st.st_mode)) {
+        status.isSymbolicLink = true;
+        if (::stat(path.c_str(), &st) < 0) {
+            return status;
+        }
+    }
+
+    status.exists = true;
+    status.isDirectory = S_ISDIR(st.st_mode);
+    return status;
+}
+
 bool DefaultFilesystem::
 isReadable(std::string const &path) const
 {
@@ -89,29 +128,29 @@ createFile(std::string const &path)
 bool DefaultFilesystem::
 createDirectory(std::string const &path)
 {
-    std::vector<std::string> components;
+    if (path.empty()) {
+        /* The working directory. */
+        return true;
+    }
 
-    std::string current = path;
-    while (current != FSUtil::GetDirectoryName(current)) {
-        std::string component = FSUtil::GetBaseName(current);
-        components.push_back(component);
+    mode_t mode = S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH;
 
-        current = FSUtil::GetDirectoryName(current);
+    /*
+     * Usually the parent already exists, so try the whole path first and
+     * only walk up to create the parents if it turns out to be missing.
+     */
+    if (::mkdir(path.c_str(), mode) == 0 || errno == EEXIST) {
+        return true;
+    } else if (errno != ENOENT) {
+        return false;
     }
 
-    for (auto it = components.rbegin(); it != components.rend(); ++it) {
-        std::string const &component = *it;
-        if (it != components.rbegin()) {
-            current += "/";
-        }
-        current += component;
-
-        if (::mkdir(current.c_str(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) != 0 && errno != EEXIST) {
-            return false;
-        }
+    std::string parent = FSUtil::GetDirectoryName(path);
+    if (parent.empty() || parent == path || !createDirectory(parent)) {
+        return false;
     }
 
-    return true;
+    return (::mkdir(path.c_str(), mode) == 0 || errno == EEXIST);
 }
 
 bool DefaultFilesystem::
@@ -127,6 +166,57 @@ read(std::vector<uint8_t> *contents, std::string const &path) const
     return true;
 }
 
+/*
+ * Below this size, reading is cheaper than setting up and tearing down a
+ * mapping and faulting in its pages.
+ */
+static size_t const MapThreshold = 64 * 1024;
+
+bool DefaultFilesystem::
+map(MappedBuffer *contents, std::string const &path) const
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || S_ISDIR(st.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    /* Only regular files have a size that can be mapped. */
+    if (S_ISREG(st.st_mode) && static_cast<size_t>(st.st_size) >= MapThreshold) {
+        if (ext::optional<MappedBuffer> mapped = MappedBuffer::Map(fd, st.st_size)) {
+            ::close(fd);
+            *contents = std::move(*mapped);
+            return true;
+        }
+    }
+
+    std::vector<uint8_t> buffer;
+    buffer.reserve(S_ISREG(st.st_mode) ? st.st_size : 0);
+
+    uint8_t chunk[65536];
+    while (true) {
+        ssize_t size = ::read(fd, chunk, sizeof(chunk));
+        if (size < 0 && errno == EINTR) {
+            continue;
+        } else if (size < 0) {
+            ::close(fd);
+            return false;
+        } else if (size == 0) {
+            break;
+        }
+        buffer.insert(buffer.end(), chunk, chunk + size);
+    }
+
+    ::close(fd);
+    *contents = MappedBuffer(std::move(buffer));
+    return true;
+}
+
 bool DefaultFilesystem::
 write(std::vector<uint8_t> const &contents, std::string const &path)
 {
@@ -163,6 +253,126 @@ writeSymbolicLink(std::string const &target, std::string const &path)
     return true;
 }
 
+#if defined(__linux__)
+/*
+ * Copies the rest of a file without bringing it into this process. Stops
+ * early, leaving both offsets after what was copied, if the kernel can't
+ * copy between these files.
+ */
+static bool
+CopyInKernel(int in, int out)
+{
+#if defined(FILESYSTEM_COPY_FILE_RANGE)
+    while (true) {
+        ssize_t size = ::copy_file_range(in, NULL, out, NULL, 1 << 30, 0);
+        if (size > 0 || (size < 0 && errno == EINTR)) {
+            continue;
+        } else if (size == 0) {
+            return true;
+        }
+        break;
+    }
+#endif
+
+    while (true) {
+        ssize_t size = ::sendfile(out, in, NULL, 1 << 30);
+        if (size > 0 || (size < 0 && errno == EINTR)) {
+            continue;
+        }
+        return (size == 0);
+    }
+}
+#endif
+
+/*
+ * Copies the rest of a file through a buffer.
+ */
+static bool
+CopyByReading(int in, int out)
+{
+    uint8_t buffer[65536];
+    while (true) {
+        ssize_t size = ::read(in, buffer, sizeof(buffer));
+        if (size < 0 && errno == EINTR) {
+            continue;
+        } else if (size <= 0) {
+            return (size == 0);
+        }
+
+        for (ssize_t offset = 0; offset < size;) {
+            ssize_t written = ::write(out, buffer + offset, size - offset);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            } else if (written <= 0) {
+                return false;
+            }
+            offset += written;
+        }
+    }
+}
+
+bool DefaultFilesystem::
+copyFile(std::string const &from, std::string const &to)
+{
+    int in = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(in, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(in);
+        return false;
+    }
+    mode_t mode = (st.st_mode & 07777) | S_IWUSR;
+
+    /* Replace rather than overwrite, in case the destination is shared. */
+    if (::unlink(to.c_str()) != 0 && errno != ENOENT) {
+        ::close(in);
+        return false;
+    }
+
+#if defined(__APPLE__)
+    if (::clonefile(from.c_str(), to.c_str(), 0) == 0) {
+        ::close(in);
+        return (::chmod(to.c_str(), mode) == 0);
+    }
+#endif
+
+    int out = ::open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, mode);
+    if (out < 0) {
+        ::close(in);
+        return false;
+    }
+
+    /*
+     * Prefer sharing storage, then copying within the kernel, then copying
+     * through this process. Each picks up where the previous one stopped.
+     */
+    bool success = false;
+#if defined(__linux__) && defined(FICLONE)
+    success = (::ioctl(out, FICLONE, in) == 0);
+#endif
+#if defined(__linux__)
+    if (!success) {
+        success = CopyInKernel(in, out);
+    }
+#endif
+    if (!success) {
+        success = CopyByReading(in, out);
+    }
+
+    ::close(in);
+    if (::close(out) != 0) {
+        success = false;
+    }
+
+    if (!success) {
+        ::unlink(to.c_str());
+    }
+    return success;
+}
+
 bool DefaultFilesystem::
 removeFile(std::string const &path)
 {
@@ -206,3 +416,19 @@ enumerateDirectory(
     return true;
 }
 
+bool DefaultFilesystem::
+enumerateRecursive(
+    std::string const &path,
+    std::function<bool(std::string const &)> const &cb) const
+{
+    /* Like the serial enumeration, a missing directory is just empty. */
+    DirectoryWalker walker = DirectoryWalker(true);
+    walker.walk(path, [&](DirectoryWalker::Directory const &directory) {
+        std::string prefix = (directory.path.empty() ? path : path + "/" + directory.path) + "/";
+        for (DirectoryWalker::Entry const &entry : directory.entries) {
+            cb(prefix + entry.name);
+        }
+    });
+
+    return true;
+}
@@ -0,0 +1,301 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <libutil/DirectoryWalker.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using libutil::DirectoryWalker;
+
+DirectoryWalker::
+DirectoryWalker(bool ordered, size_t threads) :
+    _ordered(ordered),
+    _threads(threads)
+{
+}
+
+/*
+ * Threads started by walks using the default, beyond the ones calling
+ * walk(). Walks run from several threads at once, so each starting its own
+ * thread per processor would oversubscribe the machine.
+ */
+static std::atomic<size_t> AdditionalThreads = { 0 };
+
+static bool
+ReserveThread()
+{
+    size_t limit = std::max<size_t>(1, std::thread::hardware_concurrency()) - 1;
+
+    size_t current = AdditionalThreads.load();
+    while (current < limit) {
+        if (AdditionalThreads.compare_exchange_weak(current, current + 1)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void
+ReleaseThread()
+{
+    AdditionalThreads--;
+}
+
+static struct timespec
+ModificationTime(struct stat const &st)
+{
+#if defined(__APPLE__)
+    return st.st_mtimespec;
+#else
+    return st.st_mtim;
+#endif
+}
+
+static DirectoryWalker::Type
+ModeType(mode_t mode)
+{
+    if (S_ISDIR(mode)) {
+        return DirectoryWalker::Type::Directory;
+    } else if (S_ISLNK(mode)) {
+        return DirectoryWalker::Type::SymbolicLink;
+    } else if (S_ISREG(mode)) {
+        return DirectoryWalker::Type::File;
+    } else {
+        return DirectoryWalker::Type::Other;
+    }
+}
+
+static bool
+ReadDirectory(std::string const &path, DirectoryWalker::Directory *directory)
+{
+    DIR *dir = ::opendir(path.c_str());
+    if (dir == nullptr) {
+        return false;
+    }
+
+    int fd = ::dirfd(dir);
+
+    struct stat st;
+    if (::fstat(fd, &st) == 0) {
+        directory->modificationTime = ModificationTime(st);
+    } else {
+        directory->modificationTime = { -1, 0 };
+    }
+
+    while (struct dirent *entry = ::readdir(dir)) {
+        if (::strcmp(entry->d_name, ".") == 0 || ::strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+
+        DirectoryWalker::Entry result;
+        result.name = entry->d_name;
+
+        switch (entry->d_type) {
+            case DT_DIR:
+                result.type = DirectoryWalker::Type::Directory;
+                break;
+            case DT_REG:
+                result.type = DirectoryWalker::Type::File;
+                break;
+            case DT_LNK:
+                result.type = DirectoryWalker::Type::SymbolicLink;
+                break;
+            case DT_UNKNOWN:
+                /* Not all filesystems fill in the type. */
+                if (::fstatat(fd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+                    result.type = ModeType(st.st_mode);
+                } else {
+                    result.type = DirectoryWalker::Type::Other;
+                }
+                break;
+            default:
+                result.type = DirectoryWalker::Type::Other;
+                break;
+        }
+
+        result.directory = (result.type == DirectoryWalker::Type::Directory);
+        if (result.type == DirectoryWalker::Type::SymbolicLink) {
+            result.directory = (::fstatat(fd, entry->d_name, &st, 0) == 0 && S_ISDIR(st.st_mode));
+        }
+
+        directory->entries.push_back(result);
+    }
+
+    ::closedir(dir);
+    return true;
+}
+
+bool DirectoryWalker::
+walk(std::string const &root, std::function<void(Directory const &)> const &callback) const
+{
+    /*
+     * A directory found by the walk. Subdirectories are kept in listing
+     * order, so the ordered delivery doesn't depend on which thread read
+     * what, or when.
+     */
+    struct Node {
+        bool                read;
+        bool                failed;
+        Directory           directory;
+        std::vector<size_t> children;
+    };
+
+    std::deque<Node> nodes = { Node() };
+
+    /* Directories waiting to be read. Most recently found first. */
+    std::vector<size_t> queue = { 0 };
+    size_t active = 0;
+
+    /*
+     * Directories waiting to be delivered. When ordered, a stack of the
+     * next directories in depth-first order, which may not be read yet.
+     * Otherwise, directories in the order they were read.
+     */
+    std::vector<size_t> order = { 0 };
+    std::deque<size_t> ready;
+    bool delivering = false;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    /*
+     * Deliver whatever can be. Only one thread delivers at a time; others
+     * leave what they read for it to pick up after its current callback.
+     */
+    auto deliver = [&](std::unique_lock<std::mutex> &lock) {
+        if (delivering) {
+            return;
+        }
+        delivering = true;
+
+        while (true) {
+            size_t index;
+            if (_ordered) {
+                if (order.empty() || !nodes[order.back()].read) {
+                    break;
+                }
+
+                index = order.back();
+                order.pop_back();
+
+                std::vector<size_t> const &children = nodes[index].children;
+                order.insert(order.end(), children.rbegin(), children.rend());
+
+                if (nodes[index].failed) {
+                    continue;
+                }
+            } else {
+                if (ready.empty()) {
+                    break;
+                }
+
+                index = ready.front();
+                ready.pop_front();
+            }
+
+            Directory directory = std::move(nodes[index].directory);
+            lock.unlock();
+            callback(directory);
+            lock.lock();
+        }
+
+        delivering = false;
+    };
+
+    /*
+     * Started only once there is more queued than idle threads can take, so
+     * small trees are walked on the calling thread alone.
+     */
+    size_t threads = (_threads != 0 ? _threads : std::max<size_t>(1, std::thread::hardware_concurrency()));
+    std::vector<std::thread> pool;
+
+    std::function<void()> worker = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            condition.wait(lock, [&]() { return !queue.empty() || active == 0; });
+            if (queue.empty()) {
+                /* Nothing queued and nothing in progress to queue more. */
+                return;
+            }
+
+            size_t index = queue.back();
+            queue.pop_back();
+            std::string relative = nodes[index].directory.path;
+            active++;
+
+            lock.unlock();
+
+            Directory directory;
+            directory.path = relative;
+            bool read = ReadDirectory(relative.empty() ? root : root + "/" + relative, &directory);
+
+            lock.lock();
+
+            for (Entry const &entry : directory.entries) {
+                if (entry.type == Type::Directory) {
+                    Node node;
+                    node.read = false;
+                    node.failed = false;
+                    node.directory.path = (relative.empty() ? entry.name : relative + "/" + entry.name);
+                    nodes.push_back(std::move(node));
+
+                    nodes[index].children.push_back(nodes.size() - 1);
+                    queue.push_back(nodes.size() - 1);
+                }
+            }
+
+            size_t idle = (pool.size() + 1) - active;
+            for (size_t n = idle + 1; n < queue.size() && pool.size() + 1 < threads; n++) {
+                if (_threads == 0 && !ReserveThread()) {
+                    break;
+                }
+
+                pool.emplace_back([&]() {
+                    worker();
+                    if (_threads == 0) {
+                        ReleaseThread();
+                    }
+                });
+            }
+
+            nodes[index].read = true;
+            nodes[index].failed = !read;
+            nodes[index].directory = std::move(directory);
+            if (!_ordered && read) {
+                ready.push_back(index);
+            }
+
+            active--;
+            condition.notify_all();
+
+            deliver(lock);
+        }
+    };
+
+    /* Once this returns, no thread is reading, so no more are started. */
+    worker();
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+
+    return !nodes[0].failed;
+}
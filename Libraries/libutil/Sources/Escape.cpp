@@ -11,37 +11,86 @@
 
 using libutil::Escape;
 
+/*
+ * Which characters can appear in a shell argument or a Makefile path
+ * without escaping, indexed by the character.
+ */
+struct EscapeTable {
+    bool shell[256];
+    bool makefile[256];
+
+    EscapeTable()
+    {
+        for (int c = 0; c < 256; c++) {
+            shell[c] = ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'));
+            makefile[c] = true;
+        }
+
+        for (unsigned char c : std::string("@%_-+=:,./")) {
+            shell[c] = true;
+        }
+
+        for (unsigned char c : std::string(" \t\n\v\f\r#$%:")) {
+            makefile[c] = false;
+        }
+    }
+};
+
+static EscapeTable const &
+Table()
+{
+    static EscapeTable const table;
+    return table;
+}
+
+static bool
+ShellSafe(std::string const &value)
+{
+    bool const *shell = Table().shell;
+    for (char c : value) {
+        if (!shell[static_cast<unsigned char>(c)]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 std::string Escape::
 Shell(std::string const &value)
 {
-    static std::string const *escaped = nullptr;
-    if (escaped == nullptr) {
-        std::string alphabet = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
-        std::string digits = "0123456789";
-        escaped = new std::string(alphabet + digits + "@%_-+=:,./");
+    if (ShellSafe(value)) {
+        return value;
     }
 
-    if (value.find_first_not_of(*escaped) == std::string::npos) {
-        return value;
-    } else {
-        std::string result;
-        result.reserve(value.size() + 4);
-        result += "'";
-
-        std::string::size_type offset = 0;
-        std::string::size_type previous = 0;
-        while ((offset = value.find("'", offset)) != std::string::npos) {
-            result.append(value.data() + previous, offset - previous);
-            result += "'\\''";
-
-            offset += 1;
-            previous = offset;
-        }
-        result.append(value.data() + previous, value.size() - previous);
+    std::string result;
+    result.reserve(value.size() + 2);
+    Shell(value, &result);
+    return result;
+}
+
+void Escape::
+Shell(std::string const &value, std::string *result)
+{
+    if (ShellSafe(value)) {
+        result->append(value);
+        return;
+    }
+
+    *result += "'";
+
+    std::string::size_type offset = 0;
+    std::string::size_type previous = 0;
+    while ((offset = value.find("'", offset)) != std::string::npos) {
+        result->append(value.data() + previous, offset - previous);
+        *result += "'\\''";
 
-        result += "'";
-        return result;
+        offset += 1;
+        previous = offset;
     }
+    result->append(value.data() + previous, value.size() - previous);
+
+    *result += "'";
 }
 
 std::string Escape::
@@ -49,14 +98,23 @@ Makefile(std::string const &value)
 {
     std::string result;
     result.reserve(value.size());
+    Makefile(value, &result);
+    return result;
+}
 
-    for (char c : value) {
-        if (isspace(c) || c == '#' || c == '$' || c == '%' || c == ':') {
-            result += '\\';
-        }
+void Escape::
+Makefile(std::string const &value, std::string *result)
+{
+    bool const *makefile = Table().makefile;
 
-        result += c;
+    /* Append runs of characters that need no escaping all at once. */
+    std::string::size_type previous = 0;
+    for (std::string::size_type n = 0; n < value.size(); n++) {
+        if (!makefile[static_cast<unsigned char>(value[n])]) {
+            result->append(value.data() + previous, n - previous);
+            *result += '\\';
+            previous = n;
+        }
     }
-
-    return result;
+    result->append(value.data() + previous, value.size() - previous);
 }
@@ -8,6 +8,7 @@
  */
 
 #include <libutil/FSUtil.h>
+#include <libutil/DirectoryWalker.h>
 
 #include <climits>
 #include <cstdlib>
@@ -24,6 +25,7 @@
 #include <sys/stat.h>
 
 using libutil::FSUtil;
+using libutil::DirectoryWalker;
 
 bool FSUtil::
 TestForPresence(std::string const &path)
@@ -259,18 +261,12 @@ EnumerateDirectory(std::string const &path, std::function <bool(std::string cons
 bool FSUtil::
 EnumerateRecursive(std::string const &path, std::function <bool(std::string const &)> const &cb)
 {
-    EnumerateDirectory(path, [&](std::string const &filename) -> bool {
-        std::string full = path + "/" + filename;
-        cb(full);
-        return true;
-    });
-
-    EnumerateDirectory(path, [&](std::string const &filename) -> bool {
-        std::string full = path + "/" + filename;
-        if (TestForDirectory(full) && !TestForSymlink(full)) {
-            EnumerateRecursive(full, cb);
+    DirectoryWalker walker = DirectoryWalker(true);
+    walker.walk(path, [&](DirectoryWalker::Directory const &directory) {
+        std::string prefix = (directory.path.empty() ? path : path + "/" + directory.path) + "/";
+        for (DirectoryWalker::Entry const &entry : directory.entries) {
+            cb(prefix + entry.name);
         }
-        return true;
     });
 
     return true;
@@ -14,8 +14,27 @@
 #include <sstream>
 
 using libutil::Filesystem;
+using libutil::MappedBuffer;
 using libutil::FSUtil;
 
+Filesystem::Status Filesystem::
+status(std::string const &path) const
+{
+    return { exists(path), isDirectory(path), isSymbolicLink(path) };
+}
+
+bool Filesystem::
+map(MappedBuffer *contents, std::string const &path) const
+{
+    std::vector<uint8_t> buffer;
+    if (!read(&buffer, path)) {
+        return false;
+    }
+
+    *contents = MappedBuffer(std::move(buffer));
+    return true;
+}
+
 bool Filesystem::
 enumerateRecursive(
     std::string const &path,
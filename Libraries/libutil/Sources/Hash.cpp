@@ -0,0 +1,236 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <libutil/Hash.h>
+#include <libutil/MappedBuffer.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using libutil::Hash;
+using libutil::MappedBuffer;
+
+static uint64_t const C1 = 0x87c37b91114253d5ULL;
+static uint64_t const C2 = 0x4cf5ad432745937fULL;
+
+static inline uint64_t
+RotateLeft(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t
+Load(uint8_t const *data)
+{
+    /* Blocks are read in host order; the hash is only compared on one machine. */
+    uint64_t value;
+    ::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static inline uint64_t
+Mix(uint64_t k)
+{
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+Hash::
+Hash(uint64_t seed) :
+    _h1      (seed),
+    _h2      (seed),
+    _length  (0),
+    _buffered(0)
+{
+}
+
+void Hash::
+block(uint8_t const *data)
+{
+    uint64_t k1 = Load(data);
+    uint64_t k2 = Load(data + 8);
+
+    k1 *= C1;
+    k1 = RotateLeft(k1, 31);
+    k1 *= C2;
+    _h1 ^= k1;
+
+    _h1 = RotateLeft(_h1, 27);
+    _h1 += _h2;
+    _h1 = _h1 * 5 + 0x52dce729;
+
+    k2 *= C2;
+    k2 = RotateLeft(k2, 33);
+    k2 *= C1;
+    _h2 ^= k2;
+
+    _h2 = RotateLeft(_h2, 31);
+    _h2 += _h1;
+    _h2 = _h2 * 5 + 0x38495ab5;
+}
+
+void Hash::
+update(void const *data, size_t size)
+{
+    uint8_t const *bytes = static_cast<uint8_t const *>(data);
+    _length += size;
+
+    if (_buffered > 0) {
+        size_t fill = std::min(size, sizeof(_buffer) - _buffered);
+        ::memcpy(_buffer + _buffered, bytes, fill);
+        _buffered += fill;
+        bytes += fill;
+        size -= fill;
+
+        if (_buffered < sizeof(_buffer)) {
+            return;
+        }
+
+        block(_buffer);
+        _buffered = 0;
+    }
+
+    for (; size >= sizeof(_buffer); bytes += sizeof(_buffer), size -= sizeof(_buffer)) {
+        block(bytes);
+    }
+
+    ::memcpy(_buffer, bytes, size);
+    _buffered = size;
+}
+
+bool Hash::
+updateFile(std::string const &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    uint64_t size = st.st_size;
+    update(&size, sizeof(size));
+
+    if (ext::optional<MappedBuffer> mapped = MappedBuffer::Map(fd, size)) {
+        ::close(fd);
+        update(mapped->data(), mapped->size());
+        return true;
+    }
+
+    /* Not every file can be mapped; fall back to reading it. */
+    uint8_t buffer[65536];
+    while (true) {
+        ssize_t read = ::read(fd, buffer, sizeof(buffer));
+        if (read < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            ::close(fd);
+            return false;
+        } else if (read == 0) {
+            break;
+        }
+
+        update(buffer, read);
+    }
+
+    ::close(fd);
+    return true;
+}
+
+std::pair<uint64_t, uint64_t> Hash::
+digest() const
+{
+    uint64_t h1 = _h1;
+    uint64_t h2 = _h2;
+
+    uint8_t const *tail = _buffer;
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+
+    switch (_buffered) {
+        case 15: k2 ^= static_cast<uint64_t>(tail[14]) << 48;
+        case 14: k2 ^= static_cast<uint64_t>(tail[13]) << 40;
+        case 13: k2 ^= static_cast<uint64_t>(tail[12]) << 32;
+        case 12: k2 ^= static_cast<uint64_t>(tail[11]) << 24;
+        case 11: k2 ^= static_cast<uint64_t>(tail[10]) << 16;
+        case 10: k2 ^= static_cast<uint64_t>(tail[9]) << 8;
+        case 9:  k2 ^= static_cast<uint64_t>(tail[8]);
+                 k2 *= C2;
+                 k2 = RotateLeft(k2, 33);
+                 k2 *= C1;
+                 h2 ^= k2;
+        case 8:  k1 ^= static_cast<uint64_t>(tail[7]) << 56;
+        case 7:  k1 ^= static_cast<uint64_t>(tail[6]) << 48;
+        case 6:  k1 ^= static_cast<uint64_t>(tail[5]) << 40;
+        case 5:  k1 ^= static_cast<uint64_t>(tail[4]) << 32;
+        case 4:  k1 ^= static_cast<uint64_t>(tail[3]) << 24;
+        case 3:  k1 ^= static_cast<uint64_t>(tail[2]) << 16;
+        case 2:  k1 ^= static_cast<uint64_t>(tail[1]) << 8;
+        case 1:  k1 ^= static_cast<uint64_t>(tail[0]);
+                 k1 *= C1;
+                 k1 = RotateLeft(k1, 31);
+                 k1 *= C2;
+                 h1 ^= k1;
+    }
+
+    h1 ^= _length;
+    h2 ^= _length;
+
+    h1 += h2;
+    h2 += h1;
+
+    h1 = Mix(h1);
+    h2 = Mix(h2);
+
+    h1 += h2;
+    h2 += h1;
+
+    return { h1, h2 };
+}
+
+std::string Hash::
+hex() const
+{
+    static char const digits[] = "0123456789abcdef";
+
+    std::pair<uint64_t, uint64_t> value = digest();
+
+    /* Digits of each byte in little endian order, as the reference does. */
+    std::string result = std::string(32, '0');
+    for (size_t n = 0; n < 16; n++) {
+        uint8_t byte = static_cast<uint8_t>((n < 8 ? value.first : value.second) >> ((n % 8) * 8));
+        result[n * 2]     = digits[byte >> 4];
+        result[n * 2 + 1] = digits[byte & 0xf];
+    }
+
+    return result;
+}
+
+std::string Hash::
+Hex(std::string const &string)
+{
+    Hash hash;
+    hash.update(string);
+    return hash.hex();
+}
@@ -0,0 +1,99 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <libutil/MappedBuffer.h>
+
+#include <sys/mman.h>
+
+using libutil::MappedBuffer;
+
+MappedBuffer::
+MappedBuffer() :
+    _data  (nullptr),
+    _size  (0),
+    _mapped(false)
+{
+}
+
+MappedBuffer::
+MappedBuffer(std::vector<uint8_t> &&contents) :
+    _data    (nullptr),
+    _size    (0),
+    _mapped  (false),
+    _contents(std::move(contents))
+{
+    _data = _contents.data();
+    _size = _contents.size();
+}
+
+MappedBuffer::
+MappedBuffer(MappedBuffer &&other) :
+    MappedBuffer()
+{
+    *this = std::move(other);
+}
+
+MappedBuffer::
+~MappedBuffer()
+{
+    reset();
+}
+
+MappedBuffer &MappedBuffer::
+operator=(MappedBuffer &&other)
+{
+    if (this != &other) {
+        reset();
+
+        /* Moving the vector keeps its storage, so the data stays valid. */
+        _contents = std::move(other._contents);
+        _data     = other._data;
+        _size     = other._size;
+        _mapped   = other._mapped;
+
+        other._data   = nullptr;
+        other._size   = 0;
+        other._mapped = false;
+    }
+
+    return *this;
+}
+
+void MappedBuffer::
+reset()
+{
+    if (_mapped) {
+        ::munmap(const_cast<uint8_t *>(_data), _size);
+    }
+
+    _contents.clear();
+    _data   = nullptr;
+    _size   = 0;
+    _mapped = false;
+}
+
+ext::optional<MappedBuffer> MappedBuffer::
+Map(int fd, size_t size)
+{
+    if (size == 0) {
+        /* Nothing to map, and mapping nothing is an error. */
+        return MappedBuffer();
+    }
+
+    void *data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        return ext::nullopt;
+    }
+
+    MappedBuffer buffer;
+    buffer._data   = static_cast<uint8_t const *>(data);
+    buffer._size   = size;
+    buffer._mapped = true;
+    return ext::optional<MappedBuffer>(std::move(buffer));
+}
@@ -29,13 +29,8 @@ child(std::string const &name)
 {
     assert(_type == MemoryFilesystem::Entry::Type::Directory);
 
-    for (MemoryFilesystem::Entry &entry : _children) {
-        if (entry.name() == name) {
-            return &entry;
-        }
-    }
-
-    return nullptr;
+    auto it = _index.find(name);
+    return (it != _index.end() ? &_children[it->second] : nullptr);
 }
 
 MemoryFilesystem::Entry const *MemoryFilesystem::Entry::
@@ -43,13 +38,44 @@ child(std::string const &name) const
 {
     assert(_type == MemoryFilesystem::Entry::Type::Directory);
 
-    for (MemoryFilesystem::Entry const &entry : _children) {
-        if (entry.name() == name) {
-            return &entry;
+    auto it = _index.find(name);
+    return (it != _index.end() ? &_children[it->second] : nullptr);
+}
+
+MemoryFilesystem::Entry *MemoryFilesystem::Entry::
+add(Entry &&entry)
+{
+    assert(_type == MemoryFilesystem::Entry::Type::Directory);
+
+    auto result = _index.insert({ entry.name(), _children.size() });
+    if (result.second) {
+        _children.emplace_back(std::move(entry));
+    }
+
+    return &_children[result.first->second];
+}
+
+bool MemoryFilesystem::Entry::
+remove(std::string const &name)
+{
+    assert(_type == MemoryFilesystem::Entry::Type::Directory);
+
+    auto it = _index.find(name);
+    if (it == _index.end()) {
+        return false;
+    }
+
+    size_t index = it->second;
+    _index.erase(it);
+    _children.erase(_children.begin() + index);
+
+    for (auto &entry : _index) {
+        if (entry.second > index) {
+            entry.second--;
         }
     }
 
-    return nullptr;
+    return true;
 }
 
 MemoryFilesystem::Entry MemoryFilesystem::Entry::
@@ -64,7 +90,9 @@ MemoryFilesystem::Entry MemoryFilesystem::Entry::
 Directory(std::string const &name, std::vector<Entry> const &children)
 {
     MemoryFilesystem::Entry entry = MemoryFilesystem::Entry(name, MemoryFilesystem::Entry::Type::Directory);
-    entry.children() = children;
+    for (MemoryFilesystem::Entry const &child : children) {
+        entry.add(MemoryFilesystem::Entry(child));
+    }
     return entry;
 }
 
@@ -74,8 +102,16 @@ MemoryFilesystem(std::vector<MemoryFilesystem::Entry> const &entries) :
 {
 }
 
+MemoryFilesystem::Entry &MemoryFilesystem::
+root()
+{
+    std::lock_guard<std::mutex> lock(_cache.mutex);
+    _cache.directories.clear();
+    return _root;
+}
+
 template<typename T, typename U, typename V>
-static bool
+bool MemoryFilesystem::
 WalkPath(
     U filesystem,
     std::string const &path,
@@ -87,12 +123,27 @@ WalkPath(
         return false;
     }
 
-    T *current = &filesystem->root();
+    T *current = &filesystem->_root;
     assert(current->type() == MemoryFilesystem::Entry::Type::Directory);
 
     std::string::size_type start = (normalized.front() == '/' ? 1 : 0);
     std::string::size_type end = normalized.find('/', start);
 
+    DirectoryCache *cache = &filesystem->_cache;
+    if (!all) {
+        /* Start from the containing directory, if it's been found before. */
+        std::string::size_type last = normalized.rfind('/');
+        if (last != std::string::npos && last > start) {
+            std::lock_guard<std::mutex> lock(cache->mutex);
+            auto it = cache->directories.find(normalized.substr(0, last));
+            if (it != cache->directories.end()) {
+                current = it->second;
+                start = last + 1;
+                end = std::string::npos;
+            }
+        }
+    }
+
     do {
         bool final = (end == std::string::npos);
 
@@ -118,6 +169,11 @@ WalkPath(
             return false;
         }
 
+        if (next != current) {
+            std::lock_guard<std::mutex> lock(cache->mutex);
+            cache->directories.insert({ normalized.substr(0, end), const_cast<MemoryFilesystem::Entry *>(next) });
+        }
+
         current = next;
 
         /* Move to next path component. */
@@ -186,9 +242,7 @@ createFile(std::string const &path)
         } else {
             /* Add empty file. */
             MemoryFilesystem::Entry file = MemoryFilesystem::Entry::File(name, std::vector<uint8_t>());
-            std::vector<MemoryFilesystem::Entry> *children = &parent->children();
-            children->emplace_back(std::move(file));
-            return &children->back();
+            return parent->add(std::move(file));
         }
     });
 }
@@ -208,9 +262,7 @@ createDirectory(std::string const &path)
         } else {
             /* Add intermediate directory. */
             MemoryFilesystem::Entry directory = MemoryFilesystem::Entry::Directory(name, { });
-            std::vector<MemoryFilesystem::Entry> *children = &parent->children();
-            children->emplace_back(std::move(directory));
-            return &children->back();
+            return parent->add(std::move(directory));
         }
     });
 }
@@ -244,9 +296,7 @@ write(std::vector<uint8_t> const &contents, std::string const &path)
         } else {
             /* Add file. */
             MemoryFilesystem::Entry file = MemoryFilesystem::Entry::File(name, contents);
-            std::vector<MemoryFilesystem::Entry> *children = &parent->children();
-            children->emplace_back(std::move(file));
-            return &children->back();
+            return parent->add(std::move(file));
         }
     });
 }
@@ -263,17 +313,30 @@ writeSymbolicLink(std::string const &target, std::string const &path)
     return false;
 }
 
+bool MemoryFilesystem::
+copyFile(std::string const &from, std::string const &to)
+{
+    std::vector<uint8_t> contents;
+    if (!read(&contents, from)) {
+        return false;
+    }
+
+    return write(contents, to);
+}
+
 bool MemoryFilesystem::
 removeFile(std::string const &path)
 {
-    return WalkPath<MemoryFilesystem::Entry>(this, path, false, [](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
+    return WalkPath<MemoryFilesystem::Entry>(this, path, false, [this](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
         if (entry != nullptr) {
             if (entry->type() == MemoryFilesystem::Entry::Type::File) {
-                /* Found, remove it. */
-                std::vector<MemoryFilesystem::Entry> *children = &parent->children();
-                children->erase(std::remove_if(children->begin(), children->end(), [&](MemoryFilesystem::Entry const &entry) {
-                    return (entry.name() == name);
-                }), children->end());
+                /* Found, remove it. Directories after it move, so forget where they were. */
+                {
+                    std::lock_guard<std::mutex> lock(_cache.mutex);
+                    _cache.directories.clear();
+                }
+
+                parent->remove(name);
                 return parent;
             } else {
                 /* Can't remove directories. */
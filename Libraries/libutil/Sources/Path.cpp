@@ -0,0 +1,198 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <libutil/Path.h>
+#include <libutil/FSUtil.h>
+
+#include <atomic>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+using libutil::Path;
+using libutil::FSUtil;
+
+/*
+ * Each node stores only its last component, and links to its parent. The
+ * full path is built the first time something asks for it.
+ */
+struct Path::Node {
+    /* Points at the key in the table, so the component isn't stored twice. */
+    std::string const                 *component;
+    Node const                        *parent;
+    mutable std::atomic<std::string *> string;
+
+    Node() :
+        component(nullptr),
+        parent   (nullptr),
+        string   (nullptr)
+    {
+    }
+};
+
+struct InternKey {
+    void const  *parent;
+    std::string  component;
+
+    bool operator==(InternKey const &other) const
+    { return parent == other.parent && component == other.component; }
+};
+
+struct InternKeyHash {
+    size_t operator()(InternKey const &key) const
+    { return std::hash<std::string>()(key.component) ^ (std::hash<void const *>()(key.parent) * 0x9e3779b97f4a7c15ULL); }
+};
+
+static std::mutex &
+InternMutex()
+{
+    static std::mutex *mutex = new std::mutex();
+    return *mutex;
+}
+
+/*
+ * Interns a normalized path one component at a time, so its parents are
+ * interned too. The intern mutex must be held.
+ */
+Path::Node const *Path::
+Intern(std::string const &path)
+{
+    /* Map nodes never move, so neither do the keys the nodes point at. */
+    static std::unordered_map<InternKey, Node, InternKeyHash> *interned = new std::unordered_map<InternKey, Node, InternKeyHash>();
+    std::unordered_map<InternKey, Node, InternKeyHash> &table = *interned;
+
+    Node const *node = nullptr;
+    InternKey key;
+
+    std::string::size_type start = 0;
+    while (start < path.size()) {
+        std::string::size_type slash = path.find('/', start);
+        if (slash == std::string::npos) {
+            slash = path.size();
+        }
+
+        /* The root is a component of its own. */
+        if (slash == 0) {
+            key.component = "/";
+        } else if (slash > start) {
+            key.component.assign(path, start, slash - start);
+        } else {
+            start = slash + 1;
+            continue;
+        }
+        key.parent = node;
+
+        auto it = table.find(key);
+        if (it == table.end()) {
+            it = table.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple()).first;
+            it->second.component = &it->first.component;
+            it->second.parent    = node;
+        }
+
+        node = &it->second;
+        start = slash + 1;
+    }
+
+    return node;
+}
+
+Path::
+Path(Node const *node) :
+    _node(node)
+{
+}
+
+Path::
+Path() :
+    _node(nullptr)
+{
+}
+
+Path::
+Path(std::string const &path) :
+    _node(nullptr)
+{
+    std::string normalized = FSUtil::NormalizePath(path);
+    while (normalized.size() > 1 && normalized.back() == '/') {
+        normalized.pop_back();
+    }
+
+    if (!normalized.empty()) {
+        std::lock_guard<std::mutex> lock(InternMutex());
+        _node = Intern(normalized);
+    }
+}
+
+std::string const &Path::
+string() const
+{
+    static std::string const empty;
+    if (_node == nullptr) {
+        return empty;
+    }
+
+    std::string *string = _node->string.load(std::memory_order_acquire);
+    if (string != nullptr) {
+        return *string;
+    }
+
+    /* Join the components without building strings for the parents. */
+    std::vector<std::string const *> components;
+    size_t size = 0;
+    for (Node const *node = _node; node != nullptr; node = node->parent) {
+        components.push_back(node->component);
+        size += node->component->size() + 1;
+    }
+
+    std::string *built = new std::string();
+    built->reserve(size);
+    for (auto it = components.rbegin(); it != components.rend(); ++it) {
+        if (!built->empty() && built->back() != '/') {
+            *built += '/';
+        }
+        *built += **it;
+    }
+
+    /* Another thread may have built it meanwhile; keep whichever was first. */
+    if (!_node->string.compare_exchange_strong(string, built, std::memory_order_acq_rel)) {
+        delete built;
+        return *string;
+    }
+
+    return *built;
+}
+
+Path Path::
+parent() const
+{
+    return Path(_node != nullptr ? _node->parent : nullptr);
+}
+
+std::string Path::
+base() const
+{
+    return (_node != nullptr ? *_node->component : std::string());
+}
+
+bool Path::
+inside(Path const &directory) const
+{
+    if (directory._node == nullptr) {
+        return false;
+    }
+
+    for (Node const *node = (_node != nullptr ? _node->parent : nullptr); node != nullptr; node = node->parent) {
+        if (node == directory._node) {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -8,14 +8,14 @@
  */
 
 #include <libutil/Subprocess.h>
+#include <libutil/SubprocessGroup.h>
 #include <libutil/FSUtil.h>
 
+#include <iterator>
 #include <sstream>
 
-#include <sys/wait.h>
-#include <unistd.h>
-
 using libutil::Subprocess;
+using libutil::SubprocessGroup;
 
 Subprocess::Subprocess() :
     _exitcode(0)
@@ -36,116 +36,31 @@ execute(
         return false;
     }
 
-    std::vector <char const *> exec_args;
-    exec_args.push_back(path.c_str());
-    for (std::string const &I : arguments) {
-        exec_args.push_back(I.c_str());
-    }
-    exec_args.push_back(nullptr);
-
-    std::vector<std::string> env_values;
-    for (auto const &I : environment) {
-        env_values.push_back(I.first + "=" + I.second);
-    }
-
-    std::vector <char const *> exec_env;
-    for (auto const &I : env_values) {
-        exec_env.push_back(I.c_str());
-    }
-    exec_env.push_back(nullptr);
-
-    char const *work_dir = (!directory.empty() ? directory.c_str() : nullptr);
-
-    pid_t pid;
-    int  ofds[2];
-    int  efds[2];
-
-    if (::pipe(ofds) != 0) {
-        return false;
-    }
-
-    if (::pipe(efds) != 0) {
-        ::close(ofds[1]);
-        ::close(ofds[0]);
-        return false;
-    }
-
-    pid = fork();
-    if (pid < 0) {
-        ::close(ofds[1]);
-        ::close(ofds[0]);
-        ::close(efds[1]);
-        ::close(efds[0]);
-        return false;
+    /*
+     * Input is written as the child reads it, and output and error are
+     * read as they are written, so the child never blocks on a full pipe.
+     */
+    ext::optional<std::string> contents;
+    if (input != nullptr) {
+        contents = std::string(std::istreambuf_iterator<char>(*input), std::istreambuf_iterator<char>());
     }
 
-    if (pid == 0) {
-        ::close(ofds[0]);
-        ::close(efds[0]);
+    SubprocessGroup group;
+    bool spawned = group.spawn(path, arguments, environment, directory, contents, output != nullptr, error != nullptr, [this, output, error](SubprocessGroup::Result const &result) {
+        _exitcode = result.exitcode;
 
         if (output != nullptr) {
-            ::close(1);
-            ::dup2(ofds[1], 1);
+            *output << result.output;
         }
         if (error != nullptr) {
-            ::close(2);
-            ::dup2(efds[1], 2);
-        }
-
-        if (input != nullptr) {
-            // TODO!
+            *error << result.error;
         }
-
-        if (work_dir != nullptr) {
-            ::chdir(work_dir);
-        }
-
-        ::execve(path.c_str(), (char *const *)exec_args.data(), (char *const *)exec_env.data());
-        ::_exit(-1);
+    });
+    if (!spawned) {
         return false;
     }
 
-    if (input != nullptr) {
-        // TODO!
-    }
-
-    ::close(ofds[1]);
-    ::close(efds[1]);
-
-    if (output != nullptr) {
-        for (;;) {
-            char    buf[16384];
-            ssize_t nread;
-
-            nread = ::read(ofds[0], buf, sizeof(buf));
-            if (nread <= 0)
-                break;
-
-            buf[nread] = '\0';
-            *output << buf;
-        }
-    }
-
-    if (error != nullptr) {
-        for (;;) {
-            char    buf[16384];
-            ssize_t nread;
-
-            nread = ::read(efds[0], buf, sizeof(buf));
-            if (nread <= 0)
-                break;
-
-            buf[nread] = '\0';
-            *error << buf;
-        }
-    }
-
-    ::close(ofds[0]);
-    ::close(efds[0]);
-
-    int status;
-    ::waitpid(pid, &status, 0);
-    _exitcode = WEXITSTATUS(status);
+    group.wait();
 
     return true;
 }
@@ -0,0 +1,500 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <libutil/SubprocessGroup.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+/*
+ * Where the child's working directory can be set when spawning it. When it
+ * can't, children with a working directory are forked instead.
+ */
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+#define SUBPROCESS_SPAWN_CHDIR 1
+#endif
+
+/*
+ * Where the system can notify of a child exiting through a descriptor. Without
+ * it, exits are checked for periodically.
+ */
+#if defined(__linux__) && defined(SYS_pidfd_open)
+#define SUBPROCESS_PIDFD 1
+#endif
+
+using libutil::SubprocessGroup;
+
+struct SubprocessGroup::Child {
+    pid_t       pid;
+    int         process;
+    int         input;
+    int         output;
+    int         error;
+    std::string inputContents;
+    size_t      inputOffset;
+    Result      result;
+    Completion  completion;
+};
+
+/*
+ * How often to check for exits that can't be waited for directly.
+ */
+static int const ExitCheckInterval = 10;
+
+SubprocessGroup::
+SubprocessGroup()
+{
+}
+
+SubprocessGroup::
+~SubprocessGroup()
+{
+    /*
+     * Don't leave children behind, but don't call completions either, since
+     * whatever they refer to may be gone by now.
+     */
+    for (std::unique_ptr<Child> const &child : _children) {
+        for (int descriptor : { child->input, child->output, child->error, child->process }) {
+            if (descriptor >= 0) {
+                ::close(descriptor);
+            }
+        }
+
+        int status;
+        while (::waitpid(child->pid, &status, 0) < 0 && errno == EINTR) {
+        }
+    }
+}
+
+static bool
+CreatePipe(int descriptors[2])
+{
+#if defined(__linux__)
+    return ::pipe2(descriptors, O_CLOEXEC) == 0;
+#else
+    if (::pipe(descriptors) != 0) {
+        return false;
+    }
+
+    ::fcntl(descriptors[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(descriptors[1], F_SETFD, FD_CLOEXEC);
+    return true;
+#endif
+}
+
+static void
+ClosePipe(int descriptors[2])
+{
+    for (size_t n = 0; n < 2; n++) {
+        if (descriptors[n] >= 0) {
+            ::close(descriptors[n]);
+            descriptors[n] = -1;
+        }
+    }
+}
+
+static void
+SetNonBlocking(int descriptor)
+{
+    ::fcntl(descriptor, F_SETFL, ::fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+}
+
+#if !defined(SUBPROCESS_SPAWN_CHDIR)
+/*
+ * Start a child with fork() and exec(), for when it can't be spawned.
+ */
+static pid_t
+ForkExecute(
+    std::string const &path,
+    std::vector<char const *> const &arguments,
+    std::vector<char const *> const &environment,
+    std::string const &directory,
+    int const descriptors[3])
+{
+    pid_t pid = ::fork();
+    if (pid != 0) {
+        return pid;
+    }
+
+    for (int n = 0; n < 3; n++) {
+        if (descriptors[n] >= 0) {
+            ::dup2(descriptors[n], n);
+        }
+    }
+
+    ::signal(SIGPIPE, SIG_DFL);
+    ::signal(SIGCHLD, SIG_DFL);
+
+    if (!directory.empty() && ::chdir(directory.c_str()) != 0) {
+        ::_exit(127);
+    }
+
+    ::execve(path.c_str(), const_cast<char *const *>(arguments.data()), const_cast<char *const *>(environment.data()));
+    ::_exit(127);
+}
+#endif
+
+/*
+ * Start a child with posix_spawn(), which avoids copying this process.
+ */
+static pid_t
+SpawnExecute(
+    std::string const &path,
+    std::vector<char const *> const &arguments,
+    std::vector<char const *> const &environment,
+    std::string const &directory,
+    int const descriptors[3])
+{
+    posix_spawn_file_actions_t actions;
+    if (::posix_spawn_file_actions_init(&actions) != 0) {
+        return -1;
+    }
+
+    posix_spawnattr_t attributes;
+    if (::posix_spawnattr_init(&attributes) != 0) {
+        ::posix_spawn_file_actions_destroy(&actions);
+        return -1;
+    }
+
+    for (int n = 0; n < 3; n++) {
+        if (descriptors[n] >= 0) {
+            ::posix_spawn_file_actions_adddup2(&actions, descriptors[n], n);
+        }
+    }
+
+#if defined(SUBPROCESS_SPAWN_CHDIR)
+    if (!directory.empty()) {
+        ::posix_spawn_file_actions_addchdir_np(&actions, directory.c_str());
+    }
+#endif
+
+    /* The child shouldn't inherit signals this process chose to ignore. */
+    sigset_t defaults;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    sigaddset(&defaults, SIGCHLD);
+    ::posix_spawnattr_setsigdefault(&attributes, &defaults);
+    ::posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGDEF);
+
+    pid_t pid;
+    int result = ::posix_spawn(&pid, path.c_str(), &actions, &attributes, const_cast<char *const *>(arguments.data()), const_cast<char *const *>(environment.data()));
+
+    ::posix_spawnattr_destroy(&attributes);
+    ::posix_spawn_file_actions_destroy(&actions);
+
+    if (result != 0) {
+        return -1;
+    }
+
+    return pid;
+}
+
+bool SubprocessGroup::
+spawn(
+    std::string const &path,
+    std::vector<std::string> const &arguments,
+    std::unordered_map<std::string, std::string> const &environment,
+    std::string const &directory,
+    ext::optional<std::string> const &input,
+    bool captureOutput,
+    bool captureError,
+    Completion const &completion)
+{
+    std::vector<char const *> execArguments;
+    execArguments.push_back(path.c_str());
+    for (std::string const &argument : arguments) {
+        execArguments.push_back(argument.c_str());
+    }
+    execArguments.push_back(nullptr);
+
+    std::vector<std::string> environmentValues;
+    for (auto const &variable : environment) {
+        environmentValues.push_back(variable.first + "=" + variable.second);
+    }
+
+    std::vector<char const *> execEnvironment;
+    for (std::string const &value : environmentValues) {
+        execEnvironment.push_back(value.c_str());
+    }
+    execEnvironment.push_back(nullptr);
+
+    int inputPipe[2] = { -1, -1 };
+    int outputPipe[2] = { -1, -1 };
+    int errorPipe[2] = { -1, -1 };
+
+    if ((input && !CreatePipe(inputPipe)) || (captureOutput && !CreatePipe(outputPipe)) || (captureError && !CreatePipe(errorPipe))) {
+        ClosePipe(inputPipe);
+        ClosePipe(outputPipe);
+        ClosePipe(errorPipe);
+        return false;
+    }
+
+    int descriptors[3] = { inputPipe[0], outputPipe[1], errorPipe[1] };
+
+#if defined(SUBPROCESS_SPAWN_CHDIR)
+    pid_t pid = SpawnExecute(path, execArguments, execEnvironment, directory, descriptors);
+#else
+    pid_t pid = (directory.empty() ? SpawnExecute(path, execArguments, execEnvironment, directory, descriptors) : ForkExecute(path, execArguments, execEnvironment, directory, descriptors));
+#endif
+
+    /* The child has its own copies of its ends. */
+    for (int *descriptor : { &inputPipe[0], &outputPipe[1], &errorPipe[1] }) {
+        if (*descriptor >= 0) {
+            ::close(*descriptor);
+            *descriptor = -1;
+        }
+    }
+
+    if (pid < 0) {
+        ClosePipe(inputPipe);
+        ClosePipe(outputPipe);
+        ClosePipe(errorPipe);
+        return false;
+    }
+
+    std::unique_ptr<Child> child = std::unique_ptr<Child>(new Child());
+    child->pid = pid;
+    child->process = -1;
+    child->input = inputPipe[1];
+    child->output = outputPipe[0];
+    child->error = errorPipe[0];
+    child->inputOffset = 0;
+    child->result.exitcode = 0;
+    child->completion = completion;
+
+#if defined(SUBPROCESS_PIDFD)
+    /* Fails on older kernels; exits are then checked for periodically. */
+    child->process = static_cast<int>(::syscall(SYS_pidfd_open, pid, 0));
+#endif
+
+    if (child->input >= 0) {
+        if (input->empty()) {
+            ::close(child->input);
+            child->input = -1;
+        } else {
+            child->inputContents = *input;
+            SetNonBlocking(child->input);
+        }
+    }
+
+    for (int descriptor : { child->output, child->error }) {
+        if (descriptor >= 0) {
+            SetNonBlocking(descriptor);
+        }
+    }
+
+    _children.push_back(std::move(child));
+    return true;
+}
+
+/*
+ * Write without being killed if the reader has gone away. The signal is
+ * blocked during the write, and discarded if the write raised it.
+ */
+static ssize_t
+WriteIgnoringPipeSignal(int descriptor, char const *data, size_t size)
+{
+    sigset_t pipeSignal;
+    sigemptyset(&pipeSignal);
+    sigaddset(&pipeSignal, SIGPIPE);
+
+    sigset_t pending;
+    sigpending(&pending);
+    bool alreadyPending = sigismember(&pending, SIGPIPE);
+
+    sigset_t previous;
+    ::pthread_sigmask(SIG_BLOCK, &pipeSignal, &previous);
+
+    ssize_t written = ::write(descriptor, data, size);
+    int writeError = errno;
+
+    if (written < 0 && writeError == EPIPE && !alreadyPending) {
+        sigpending(&pending);
+        if (sigismember(&pending, SIGPIPE)) {
+            int received;
+            sigwait(&pipeSignal, &received);
+        }
+    }
+
+    ::pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+
+    errno = writeError;
+    return written;
+}
+
+/*
+ * Read what is available into the string. Closes the descriptor once there
+ * is nothing more to read.
+ */
+static void
+ReadAvailable(int *descriptor, std::string *contents)
+{
+    while (true) {
+        char buffer[16384];
+        ssize_t count = ::read(*descriptor, buffer, sizeof(buffer));
+        if (count > 0) {
+            contents->append(buffer, count);
+        } else if (count < 0 && errno == EINTR) {
+            continue;
+        } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        } else {
+            ::close(*descriptor);
+            *descriptor = -1;
+            return;
+        }
+    }
+}
+
+static void
+WriteAvailable(int *descriptor, std::string const &contents, size_t *offset)
+{
+    while (*offset < contents.size()) {
+        ssize_t count = WriteIgnoringPipeSignal(*descriptor, contents.data() + *offset, contents.size() - *offset);
+        if (count > 0) {
+            *offset += count;
+        } else if (count < 0 && errno == EINTR) {
+            continue;
+        } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        } else {
+            /* The child stopped reading, so the rest won't be read. */
+            break;
+        }
+    }
+
+    ::close(*descriptor);
+    *descriptor = -1;
+}
+
+bool SubprocessGroup::
+poll(int timeout)
+{
+    if (_children.empty()) {
+        return false;
+    }
+
+    std::vector<struct pollfd> descriptors;
+    for (std::unique_ptr<Child> const &child : _children) {
+        if (child->input >= 0) {
+            descriptors.push_back({ child->input, POLLOUT, 0 });
+        }
+        for (int descriptor : { child->output, child->error, child->process }) {
+            if (descriptor >= 0) {
+                descriptors.push_back({ descriptor, POLLIN, 0 });
+            }
+        }
+
+        /*
+         * Without a descriptor for the process, check for an exit every so
+         * often, since its output can be held open by its own children.
+         */
+        if (child->process < 0) {
+            timeout = (timeout < 0 ? ExitCheckInterval : std::min(timeout, ExitCheckInterval));
+        }
+    }
+
+    int ready = ::poll(descriptors.data(), descriptors.size(), timeout);
+    if (ready < 0 && errno != EINTR) {
+        return true;
+    }
+
+    std::vector<std::unique_ptr<Child>> finished;
+
+    for (auto it = _children.begin(); it != _children.end();) {
+        Child *child = it->get();
+
+        for (struct pollfd const &descriptor : descriptors) {
+            if (descriptor.revents == 0) {
+                continue;
+            }
+
+            if (descriptor.fd == child->input) {
+                WriteAvailable(&child->input, child->inputContents, &child->inputOffset);
+            } else if (descriptor.fd == child->output) {
+                ReadAvailable(&child->output, &child->result.output);
+            } else if (descriptor.fd == child->error) {
+                ReadAvailable(&child->error, &child->result.error);
+            }
+        }
+
+        /*
+         * Reap the child if it exited. Only this child is waited for, so
+         * other children of this process are left alone.
+         */
+        siginfo_t info;
+        info.si_pid = 0;
+        int waited;
+        do {
+            waited = ::waitid(P_PID, child->pid, &info, WEXITED | WNOHANG);
+        } while (waited < 0 && errno == EINTR);
+
+        if (waited == 0 && info.si_pid == 0) {
+            ++it;
+            continue;
+        }
+
+        if (waited < 0) {
+            /* Reaped elsewhere, so the status is lost. */
+            child->result.exitcode = 1;
+        } else if (info.si_code == CLD_EXITED) {
+            child->result.exitcode = info.si_status;
+        } else {
+            child->result.exitcode = 128 + info.si_status;
+        }
+
+        /*
+         * Collect any output left after the exit. Anything still holding
+         * the pipes open, such as a background grandchild, isn't waited for.
+         */
+        for (int *descriptor : { &child->output, &child->error }) {
+            if (*descriptor >= 0) {
+                ReadAvailable(descriptor, descriptor == &child->output ? &child->result.output : &child->result.error);
+            }
+        }
+
+        for (int *descriptor : { &child->input, &child->output, &child->error, &child->process }) {
+            if (*descriptor >= 0) {
+                ::close(*descriptor);
+                *descriptor = -1;
+            }
+        }
+
+        finished.push_back(std::move(*it));
+        it = _children.erase(it);
+    }
+
+    /* After updating the children, in case a completion starts another. */
+    for (std::unique_ptr<Child> const &child : finished) {
+        if (child->completion) {
+            child->completion(child->result);
+        }
+    }
+
+    return !_children.empty();
+}
+
+void SubprocessGroup::
+wait()
+{
+    while (poll(-1)) {
+    }
+}
@@ -10,36 +10,150 @@
 #include <libutil/Wildcard.h>
 
 #include <algorithm>
+#include <cstring>
 
 using libutil::Wildcard;
+using libutil::CompiledWildcard;
 
 bool Wildcard::
 Match(std::string const &pattern, std::string const &string)
 {
     std::string::const_iterator sit = string.begin();
+    std::string::const_iterator fit = pattern.begin();
+
+    /*
+     * Where to resume after the last '*' if the rest doesn't match: the
+     * star then takes one more character and the rest is tried again.
+     * Earlier stars never need to take more, so only the last one is kept.
+     */
+    std::string::const_iterator fstar;
+    std::string::const_iterator sstar = string.end();
+
+    while (sit != string.end()) {
+        std::string::const_iterator fend;
+        if (fit != pattern.end() && *fit == '*') {
+            fstar = ++fit;
+            sstar = sit;
+            continue;
+        } else if (fit != pattern.end() && *fit == '[' && (fend = std::find(fit, pattern.end(), ']')) != pattern.end()) {
+            if (std::find(std::next(fit), fend, *sit) != fend) {
+                fit = std::next(fend);
+                ++sit;
+                continue;
+            }
+        } else if (fit != pattern.end() && *fit == *sit) {
+            ++fit;
+            ++sit;
+            continue;
+        }
+
+        if (sstar == string.end()) {
+            /* No star to take up the difference. */
+            return false;
+        }
+
+        fit = fstar;
+        sit = ++sstar;
+    }
+
+    /* Trailing stars can match nothing. */
+    return (std::find_if(fit, pattern.end(), [](char c) { return c != '*'; }) == pattern.end());
+}
+
+CompiledWildcard::
+CompiledWildcard(std::string const &pattern) :
+    _segments({ { 0, 0, true } })
+{
     for (std::string::const_iterator fit = pattern.begin(); fit != pattern.end(); ++fit) {
         std::string::const_iterator fend;
         if (*fit == '*') {
-            if (++fit == pattern.end() || sit == string.end()) {
-                return true;
+            _segments.push_back({ _characters.size(), 0, true });
+            continue;
+        } else if (*fit == '[' && (fend = std::find(fit, pattern.end(), ']')) != pattern.end()) {
+            std::bitset<256> set;
+            for (std::string::const_iterator it = std::next(fit); it != fend; ++it) {
+                set.set(static_cast<unsigned char>(*it));
             }
 
-            while (*sit++ != *fit) {
-                if (sit == string.end()) {
-                    return false;
-                }
-            }
-        } else if (*fit == '[' && (fend = std::find(fit, pattern.end(), ']')) != pattern.end()) {
-            std::string allowed = std::string(std::next(fit), fend);
-            if (allowed.find(*sit++) == std::string::npos) {
+            _characters.push_back('\0');
+            _classes.push_back(_sets.size());
+            _sets.push_back(set);
+            _segments.back().literal = false;
+            fit = fend;
+        } else {
+            _characters.push_back(*fit);
+            _classes.push_back(-1);
+        }
+
+        _segments.back().length++;
+    }
+}
+
+bool CompiledWildcard::
+matchAt(Segment const &segment, char const *string) const
+{
+    char const *characters = _characters.data() + segment.offset;
+    if (segment.literal) {
+        for (size_t n = 0; n < segment.length; n++) {
+            if (characters[n] != string[n]) {
                 return false;
             }
-            fit = fend;
-        } else if (*fit != *sit++) {
+        }
+        return true;
+    }
+
+    for (size_t n = 0; n < segment.length; n++) {
+        int set = _classes[segment.offset + n];
+        if (set < 0 ? _characters[segment.offset + n] != string[n] : !_sets[set].test(static_cast<unsigned char>(string[n]))) {
             return false;
         }
     }
 
-    return (sit == string.end());
+    return true;
 }
 
+bool CompiledWildcard::
+match(char const *string, size_t size) const
+{
+    Segment const &first = _segments.front();
+    if (_segments.size() == 1) {
+        return (size == first.length && matchAt(first, string));
+    }
+
+    Segment const &last = _segments.back();
+    if (first.length + last.length > size || !matchAt(first, string) || !matchAt(last, string + size - last.length)) {
+        return false;
+    }
+
+    /*
+     * Taking the earliest match for each segment in between leaves the
+     * most room for the ones after it, so there is never a need to retry.
+     */
+    size_t start = first.length;
+    size_t end = size - last.length;
+    for (auto it = std::next(_segments.begin()); it != std::prev(_segments.end()); ++it) {
+        while (true) {
+            if (end - start < it->length) {
+                return false;
+            }
+
+            if (it->literal && it->length > 0) {
+                /* Skip straight to where the first character appears. */
+                void const *found = ::memchr(string + start, _characters[it->offset], end - start - it->length + 1);
+                if (found == nullptr) {
+                    return false;
+                }
+                start = static_cast<char const *>(found) - string;
+            }
+
+            if (matchAt(*it, string + start)) {
+                break;
+            }
+            start++;
+        }
+
+        start += it->length;
+    }
+
+    return true;
+}
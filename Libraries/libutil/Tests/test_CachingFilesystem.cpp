@@ -0,0 +1,111 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <libutil/CachingFilesystem.h>
+#include <libutil/DefaultFilesystem.h>
+#include <libutil/MemoryFilesystem.h>
+
+#include <cstdlib>
+
+using libutil::CachingFilesystem;
+using libutil::DefaultFilesystem;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+TEST(CachingFilesystem, Cached)
+{
+    MemoryFilesystem memory = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("file", Contents("one")),
+        MemoryFilesystem::Entry::Directory("dir", { }),
+    });
+    CachingFilesystem filesystem(&memory);
+
+    EXPECT_TRUE(filesystem.isDirectory("/dir"));
+    EXPECT_TRUE(filesystem.isDirectory("/dir"));
+    EXPECT_FALSE(filesystem.isDirectory("/file"));
+    EXPECT_EQ(3, filesystem.lookups());
+    EXPECT_EQ(2, filesystem.misses());
+
+    /* A path known to exist doesn't need to be looked up again. */
+    EXPECT_TRUE(filesystem.exists("/dir"));
+    EXPECT_EQ(2, filesystem.misses());
+
+    /* Nor does anything else about a path known not to exist. */
+    EXPECT_FALSE(filesystem.exists("/missing"));
+    EXPECT_FALSE(filesystem.isReadable("/missing"));
+    EXPECT_FALSE(filesystem.isDirectory("/missing"));
+    EXPECT_EQ(3, filesystem.misses());
+
+    /* Changes elsewhere are not seen until invalidated. */
+    ASSERT_TRUE(memory.write(Contents("two"), "/missing"));
+    EXPECT_FALSE(filesystem.exists("/missing"));
+    filesystem.invalidate("/missing");
+    EXPECT_TRUE(filesystem.exists("/missing"));
+}
+
+TEST(CachingFilesystem, SingleLookup)
+{
+    char temporary[] = "/tmp/CachingFilesystem.XXXXXX";
+    ASSERT_NE(nullptr, ::mkdtemp(temporary));
+    std::string root = temporary;
+
+    DefaultFilesystem disk;
+    ASSERT_TRUE(disk.createDirectory(root + "/dir"));
+    ASSERT_TRUE(disk.writeSymbolicLink("dir", root + "/link"));
+    ASSERT_TRUE(disk.writeSymbolicLink("missing", root + "/dangling"));
+    CachingFilesystem filesystem(&disk);
+
+    /* Every test of what a path is comes from the first lookup. */
+    EXPECT_TRUE(filesystem.isSymbolicLink(root + "/link"));
+    EXPECT_TRUE(filesystem.isDirectory(root + "/link"));
+    EXPECT_TRUE(filesystem.exists(root + "/link"));
+    EXPECT_EQ(1, filesystem.misses());
+
+    EXPECT_FALSE(filesystem.isSymbolicLink(root + "/dir"));
+    EXPECT_TRUE(filesystem.isDirectory(root + "/dir"));
+    EXPECT_EQ(2, filesystem.misses());
+
+    /* A link to a missing path doesn't exist, but is still a link. */
+    EXPECT_FALSE(filesystem.exists(root + "/dangling"));
+    EXPECT_TRUE(filesystem.isSymbolicLink(root + "/dangling"));
+    EXPECT_FALSE(filesystem.isReadable(root + "/dangling"));
+    EXPECT_EQ(3, filesystem.misses());
+
+    /* Permissions are looked up on their own. */
+    EXPECT_TRUE(filesystem.isReadable(root + "/dir"));
+    EXPECT_EQ(4, filesystem.misses());
+
+    EXPECT_EQ(0, ::system(("rm -rf " + root).c_str()));
+}
+
+TEST(CachingFilesystem, Invalidate)
+{
+    MemoryFilesystem memory = MemoryFilesystem({ });
+    CachingFilesystem filesystem(&memory);
+
+    /* Changes made through the filesystem are seen immediately. */
+    EXPECT_FALSE(filesystem.exists("/file"));
+    ASSERT_TRUE(filesystem.write(Contents("one"), "/file"));
+    EXPECT_TRUE(filesystem.exists("/file"));
+    ASSERT_TRUE(filesystem.removeFile("/file"));
+    EXPECT_FALSE(filesystem.exists("/file"));
+
+    /* Including directories created along the way. */
+    EXPECT_FALSE(filesystem.isDirectory("/a"));
+    EXPECT_FALSE(filesystem.isDirectory("/a/b"));
+    ASSERT_TRUE(filesystem.createDirectory("/a/b"));
+    EXPECT_TRUE(filesystem.isDirectory("/a"));
+    EXPECT_TRUE(filesystem.isDirectory("/a/b"));
+}
@@ -0,0 +1,159 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <libutil/DirectoryWalker.h>
+#include <libutil/DefaultFilesystem.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+#include <unistd.h>
+
+using libutil::DirectoryWalker;
+using libutil::DefaultFilesystem;
+
+/*
+ * A tree wide and deep enough that several threads take part.
+ */
+static std::string
+CreateTree()
+{
+    char path[] = "/tmp/DirectoryWalker.XXXXXX";
+    if (::mkdtemp(path) == nullptr) {
+        return std::string();
+    }
+
+    std::string root = path;
+    DefaultFilesystem filesystem;
+    for (int a = 0; a < 8; a++) {
+        for (int b = 0; b < 8; b++) {
+            std::string directory = root + "/" + std::to_string(a) + "/" + std::to_string(b);
+            EXPECT_TRUE(filesystem.createDirectory(directory));
+            EXPECT_TRUE(filesystem.write({ 'x' }, directory + "/file"));
+        }
+    }
+    EXPECT_TRUE(filesystem.writeSymbolicLink("0", root + "/link"));
+    return root;
+}
+
+static std::vector<std::string>
+Walk(std::string const &root, bool ordered, size_t threads)
+{
+    std::vector<std::string> paths;
+
+    DirectoryWalker walker = DirectoryWalker(ordered, threads);
+    EXPECT_TRUE(walker.walk(root, [&](DirectoryWalker::Directory const &directory) {
+        for (DirectoryWalker::Entry const &entry : directory.entries) {
+            paths.push_back(directory.path + "/" + entry.name);
+        }
+    }));
+
+    return paths;
+}
+
+TEST(DirectoryWalker, Ordered)
+{
+    std::string root = CreateTree();
+    ASSERT_FALSE(root.empty());
+
+    /* The same order no matter how many threads. */
+    std::vector<std::string> serial = Walk(root, true, 1);
+    EXPECT_EQ(8 + 1 + 8 * 8 + 8 * 8, serial.size());
+    for (int n = 0; n < 4; n++) {
+        EXPECT_EQ(serial, Walk(root, true, 8));
+    }
+
+    /* Each directory's contents come before those of its subdirectories. */
+    auto first = std::find(serial.begin(), serial.end(), "/0");
+    auto child = std::find(serial.begin(), serial.end(), "0/0");
+    EXPECT_LT(first, child);
+
+    /* Unordered finds the same entries. */
+    std::vector<std::string> unordered = Walk(root, false, 8);
+    std::sort(serial.begin(), serial.end());
+    std::sort(unordered.begin(), unordered.end());
+    EXPECT_EQ(serial, unordered);
+
+    EXPECT_EQ(0, ::system(("rm -rf " + root).c_str()));
+}
+
+TEST(DirectoryWalker, Types)
+{
+    std::string root = CreateTree();
+    ASSERT_FALSE(root.empty());
+
+    std::vector<std::string> directories;
+    DirectoryWalker walker = DirectoryWalker(false);
+    EXPECT_TRUE(walker.walk(root, [&](DirectoryWalker::Directory const &directory) {
+        directories.push_back(directory.path);
+
+        for (DirectoryWalker::Entry const &entry : directory.entries) {
+            if (entry.name == "file") {
+                EXPECT_EQ(DirectoryWalker::Type::File, entry.type);
+                EXPECT_FALSE(entry.directory);
+            } else if (entry.name == "link") {
+                EXPECT_EQ(DirectoryWalker::Type::SymbolicLink, entry.type);
+                EXPECT_TRUE(entry.directory);
+            } else {
+                EXPECT_EQ(DirectoryWalker::Type::Directory, entry.type);
+                EXPECT_TRUE(entry.directory);
+            }
+        }
+    }));
+
+    /* Links to directories are not followed. */
+    EXPECT_EQ(1 + 8 + 8 * 8, directories.size());
+    EXPECT_EQ(directories.end(), std::find(directories.begin(), directories.end(), "link"));
+
+    EXPECT_EQ(0, ::system(("rm -rf " + root).c_str()));
+}
+
+TEST(DirectoryWalker, Serial)
+{
+    char path[] = "/tmp/DirectoryWalker.XXXXXX";
+    ASSERT_NE(nullptr, ::mkdtemp(path));
+    std::string root = path;
+
+    DefaultFilesystem filesystem;
+    ASSERT_TRUE(filesystem.createDirectory(root + "/a/b/c"));
+
+    /* With never more than one directory to read, no threads are started. */
+    std::thread::id caller = std::this_thread::get_id();
+    size_t count = 0;
+    DirectoryWalker walker = DirectoryWalker(false, 8);
+    EXPECT_TRUE(walker.walk(root, [&](DirectoryWalker::Directory const &directory) {
+        EXPECT_EQ(caller, std::this_thread::get_id());
+        count++;
+    }));
+    EXPECT_EQ(4, count);
+
+    for (std::string const &directory : { "/a/b/c", "/a/b", "/a", "" }) {
+        EXPECT_EQ(0, ::rmdir((root + directory).c_str()));
+    }
+}
+
+TEST(DirectoryWalker, Missing)
+{
+    size_t count = 0;
+    DirectoryWalker walker = DirectoryWalker(true);
+    EXPECT_FALSE(walker.walk("/nonexistent/directory", [&](DirectoryWalker::Directory const &directory) {
+        count++;
+    }));
+    EXPECT_EQ(0, count);
+
+    /* Enumerating it still succeeds, as it did before the walker. */
+    DefaultFilesystem filesystem;
+    EXPECT_TRUE(filesystem.enumerateRecursive("/nonexistent/directory", [&](std::string const &path) -> bool {
+        count++;
+        return true;
+    }));
+    EXPECT_EQ(0, count);
+}
@@ -37,3 +37,20 @@ TEST(Escape, Makefile)
     EXPECT_EQ(Escape::Makefile("per%cent"), "per\\%cent");
     EXPECT_EQ(Escape::Makefile("'\"\\"), "'\"\\");
 }
+
+TEST(Escape, Append)
+{
+    std::string result = "cmd";
+    for (char const *argument : { "alpha", "sin'gle", "two words", "" }) {
+        result += " ";
+        Escape::Shell(argument, &result);
+    }
+    EXPECT_EQ(result, "cmd alpha 'sin'\\''gle' 'two words' ");
+
+    result = "out:";
+    for (char const *path : { "alpha", "co:lon", "sp ace", "tab\t" }) {
+        result += " ";
+        Escape::Makefile(path, &result);
+    }
+    EXPECT_EQ(result, "out: alpha co\\:lon sp\\ ace tab\\\t");
+}
@@ -0,0 +1,78 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <libutil/Hash.h>
+
+#include <cstdlib>
+#include <vector>
+
+#include <unistd.h>
+
+using libutil::Hash;
+
+TEST(Hash, Known)
+{
+    /* Reference MurmurHash3_x64_128 results, with a seed of zero. */
+    EXPECT_EQ("00000000000000000000000000000000", Hash::Hex(""));
+    EXPECT_EQ("6c1b07bc7bbc4be347939ac4a93c437a", Hash::Hex("The quick brown fox jumps over the lazy dog"));
+}
+
+TEST(Hash, Pieces)
+{
+    std::string input;
+    for (size_t n = 0; n < 100; n++) {
+        input += static_cast<char>('a' + n % 26);
+    }
+
+    for (size_t size = 0; size <= input.size(); size++) {
+        std::string prefix = input.substr(0, size);
+
+        /* Split in every place, including inside and across blocks. */
+        for (size_t split = 0; split <= size; split += 7) {
+            Hash hash;
+            hash.update(prefix.substr(0, split));
+            hash.update(prefix.substr(split));
+            EXPECT_EQ(Hash::Hex(prefix), hash.hex());
+        }
+    }
+
+    EXPECT_NE(Hash::Hex("a"), Hash::Hex("b"));
+    EXPECT_NE(Hash().digest(), Hash(1).digest());
+}
+
+TEST(Hash, File)
+{
+    char path[] = "/tmp/Hash.XXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT_GE(fd, 0);
+
+    /* Large enough to be mapped. */
+    std::vector<uint8_t> contents;
+    for (size_t n = 0; n < 200000; n++) {
+        contents.push_back(static_cast<uint8_t>(n * 7));
+    }
+    ASSERT_EQ(static_cast<ssize_t>(contents.size()), ::write(fd, contents.data(), contents.size()));
+    ::close(fd);
+
+    Hash file;
+    EXPECT_TRUE(file.updateFile(path));
+
+    Hash expected;
+    uint64_t size = contents.size();
+    expected.update(&size, sizeof(size));
+    expected.update(contents.data(), contents.size());
+    EXPECT_EQ(expected.digest(), file.digest());
+
+    ::unlink(path);
+
+    Hash missing;
+    EXPECT_FALSE(missing.updateFile(path));
+    EXPECT_FALSE(missing.updateFile("/tmp"));
+}
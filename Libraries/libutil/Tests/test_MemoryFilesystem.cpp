@@ -181,6 +181,57 @@ TEST(MemoryFilesystem, RemoveFile)
     EXPECT_FALSE(filesystem.removeFile("/dir1"));
     EXPECT_FALSE(filesystem.removeFile("/dir2/dir3"));
     EXPECT_FALSE(filesystem.removeFile("/invalid"));
+
+    /* Directories after a removed file are still found. */
+    std::vector<uint8_t> contents;
+    EXPECT_TRUE(filesystem.read(&contents, "/dir2/file2"));
+    EXPECT_EQ(contents, Contents("two2"));
+    EXPECT_TRUE(filesystem.isDirectory("/dir2/dir3"));
+}
+
+TEST(MemoryFilesystem, WideDirectory)
+{
+    auto filesystem = MemoryFilesystem({ });
+    ASSERT_TRUE(filesystem.createDirectory("/wide/dir"));
+
+    for (size_t n = 0; n < 10000; n++) {
+        std::string name = "file" + std::to_string(n);
+        ASSERT_TRUE(filesystem.write(Contents(name), "/wide/dir/" + name));
+        ASSERT_TRUE(filesystem.createDirectory("/wide/" + name));
+    }
+
+    for (size_t n = 0; n < 10000; n += 97) {
+        std::string name = "file" + std::to_string(n);
+        std::vector<uint8_t> contents;
+        EXPECT_TRUE(filesystem.read(&contents, "/wide/dir/" + name));
+        EXPECT_EQ(contents, Contents(name));
+        EXPECT_TRUE(filesystem.isDirectory("/wide/" + name));
+    }
+
+    size_t count = 0;
+    EXPECT_TRUE(filesystem.enumerateDirectory("/wide/dir", [&](std::string const &name) {
+        EXPECT_EQ("file" + std::to_string(count), name);
+        count++;
+    }));
+    EXPECT_EQ(10000, count);
+}
+
+TEST(MemoryFilesystem, Copy)
+{
+    auto filesystem = BasicFilesystem();
+    EXPECT_TRUE(filesystem.exists("/dir2/file2"));
+
+    /* The copy has its own entries, separate from those already looked up. */
+    MemoryFilesystem copy = filesystem;
+    EXPECT_TRUE(copy.write(Contents("copy"), "/dir2/file2"));
+
+    std::vector<uint8_t> contents;
+    EXPECT_TRUE(filesystem.read(&contents, "/dir2/file2"));
+    EXPECT_EQ(contents, Contents("two2"));
+
+    contents.clear();
+    EXPECT_TRUE(copy.read(&contents, "/dir2/file2"));
+    EXPECT_EQ(contents, Contents("copy"));
 }
 
 TEST(MemoryFilesystem, Read)
@@ -219,6 +270,23 @@ TEST(MemoryFilesystem, Read)
     EXPECT_EQ(contents, Contents(""));
 }
 
+TEST(MemoryFilesystem, Map)
+{
+    auto filesystem = BasicFilesystem();
+    libutil::MappedBuffer contents;
+
+    /* Map file, which is read into memory. */
+    EXPECT_TRUE(filesystem.map(&contents, "/dir1/file2"));
+    EXPECT_EQ(std::vector<uint8_t>(contents.begin(), contents.end()), Contents("two1"));
+    EXPECT_FALSE(contents.mapped());
+
+    /* Can't map directory. */
+    EXPECT_FALSE(filesystem.map(&contents, "/dir1"));
+
+    /* Can't map nonexistent file. */
+    EXPECT_FALSE(filesystem.map(&contents, "/invalid"));
+}
+
 TEST(MemoryFilesystem, Write)
 {
     auto filesystem = BasicFilesystem();
@@ -251,6 +319,30 @@ TEST(MemoryFilesystem, Write)
     EXPECT_FALSE(filesystem.exists("/invalid/new"));
 }
 
+TEST(MemoryFilesystem, CopyFile)
+{
+    auto filesystem = BasicFilesystem();
+    std::vector<uint8_t> contents;
+
+    /* Copy to new file. */
+    EXPECT_TRUE(filesystem.copyFile("/file1", "/new"));
+    contents.clear();
+    EXPECT_TRUE(filesystem.read(&contents, "/new"));
+    EXPECT_EQ(contents, Contents("one"));
+
+    /* Copy over existing file. */
+    EXPECT_TRUE(filesystem.copyFile("/dir1/file2", "/file1"));
+    contents.clear();
+    EXPECT_TRUE(filesystem.read(&contents, "/file1"));
+    EXPECT_EQ(contents, Contents("two1"));
+
+    /* Can't copy a directory. */
+    EXPECT_FALSE(filesystem.copyFile("/dir1", "/new"));
+
+    /* Can't copy nonexistent file. */
+    EXPECT_FALSE(filesystem.copyFile("/invalid", "/new"));
+}
+
 TEST(MemoryFilesystem, ResolvePath)
 {
     auto filesystem = BasicFilesystem();
@@ -0,0 +1,79 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <libutil/Path.h>
+
+#include <unordered_set>
+
+using libutil::Path;
+
+TEST(Path, Intern)
+{
+    EXPECT_EQ(Path("/a/b/c"), Path("/a/b/c"));
+    EXPECT_EQ(&Path("/a/b/c").string(), &Path("/a/b/c").string());
+    EXPECT_NE(Path("/a/b/c"), Path("/a/b/d"));
+
+    EXPECT_TRUE(Path().empty());
+    EXPECT_TRUE(Path("").empty());
+    EXPECT_EQ(Path(), Path(""));
+}
+
+TEST(Path, Normalize)
+{
+    EXPECT_EQ("/a/b/c", Path("/a/b/c").string());
+    EXPECT_EQ(Path("/a/b/c"), Path("/a//b/./c/"));
+    EXPECT_EQ(Path("/a/c"), Path("/a/b/../c"));
+    EXPECT_EQ(Path("a/b"), Path("a/b/"));
+    EXPECT_EQ("/", Path("/").string());
+    EXPECT_EQ("a/b", Path("a/b").string());
+    EXPECT_EQ("/a/b", Path("/a/b/c").parent().string());
+}
+
+TEST(Path, Parent)
+{
+    Path path = Path("/a/b/c");
+    EXPECT_EQ(Path("/a/b"), path.parent());
+    EXPECT_EQ(Path("/a"), path.parent().parent());
+    EXPECT_EQ(Path("/"), path.parent().parent().parent());
+    EXPECT_TRUE(Path("/").parent().empty());
+
+    EXPECT_EQ(Path("a"), Path("a/b").parent());
+    EXPECT_TRUE(Path("a").parent().empty());
+
+    /* Paths in the same directory share it. */
+    EXPECT_EQ(Path("/a/b/c").parent(), Path("/a/b/d").parent());
+}
+
+TEST(Path, Base)
+{
+    EXPECT_EQ("c", Path("/a/b/c").base());
+    EXPECT_EQ("a", Path("/a").base());
+    EXPECT_EQ("a", Path("a").base());
+    EXPECT_EQ("/", Path("/").base());
+    EXPECT_EQ("", Path().base());
+}
+
+TEST(Path, Inside)
+{
+    EXPECT_TRUE(Path("/a/b/c").inside(Path("/a/b")));
+    EXPECT_TRUE(Path("/a/b/c").inside(Path("/a")));
+    EXPECT_TRUE(Path("/a/b/c").inside(Path("/")));
+    EXPECT_FALSE(Path("/a/b/c").inside(Path("/a/b/c")));
+    EXPECT_FALSE(Path("/a/bc").inside(Path("/a/b")));
+    EXPECT_FALSE(Path("/a/b").inside(Path()));
+}
+
+TEST(Path, Hash)
+{
+    std::unordered_set<Path> paths = { Path("/a/b"), Path("/a/./b"), Path("/a/c") };
+    EXPECT_EQ(2, paths.size());
+    EXPECT_EQ(1, paths.count(Path("/a//b")));
+    EXPECT_EQ(0, paths.count(Path("/a")));
+}
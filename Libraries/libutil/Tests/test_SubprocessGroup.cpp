@@ -0,0 +1,116 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <libutil/SubprocessGroup.h>
+#include <libutil/Subprocess.h>
+
+#include <sstream>
+
+using libutil::SubprocessGroup;
+using libutil::Subprocess;
+
+TEST(SubprocessGroup, Capture)
+{
+    SubprocessGroup group;
+
+    /* More error than fits in a pipe, written before any output. */
+    ext::optional<SubprocessGroup::Result> result;
+    ASSERT_TRUE(group.spawn("/bin/sh", { "-c", "head -c 1000000 /dev/zero >&2; echo out; exit 3" }, { }, "", ext::nullopt, true, true, [&](SubprocessGroup::Result const &r) {
+        result = r;
+    }));
+
+    group.wait();
+    EXPECT_EQ(0, group.running());
+    ASSERT_NE(ext::nullopt, result);
+    EXPECT_EQ(3, result->exitcode);
+    EXPECT_EQ("out\n", result->output);
+    EXPECT_EQ(1000000, result->error.size());
+}
+
+TEST(SubprocessGroup, Input)
+{
+    SubprocessGroup group;
+
+    /* More input than fits in a pipe, echoed back as it is read. */
+    std::string input = std::string(1000000, 'x');
+    std::string output;
+    ASSERT_TRUE(group.spawn("/bin/cat", { }, { }, "", input, true, false, [&](SubprocessGroup::Result const &r) {
+        output = r.output;
+    }));
+
+    group.wait();
+    EXPECT_EQ(input, output);
+
+    /* A child that doesn't read its input. */
+    int exitcode = -1;
+    ASSERT_TRUE(group.spawn("/bin/sh", { "-c", "exit 0" }, { }, "", input, false, false, [&](SubprocessGroup::Result const &r) {
+        exitcode = r.exitcode;
+    }));
+
+    group.wait();
+    EXPECT_EQ(0, exitcode);
+}
+
+TEST(SubprocessGroup, Concurrent)
+{
+    SubprocessGroup group;
+
+    std::vector<std::string> outputs = std::vector<std::string>(8);
+    for (size_t n = 0; n < outputs.size(); n++) {
+        ASSERT_TRUE(group.spawn("/bin/sh", { "-c", "sleep 0.1; echo $N" }, { { "N", std::to_string(n) } }, "", ext::nullopt, true, false, [&outputs, n](SubprocessGroup::Result const &r) {
+            outputs[n] = r.output;
+        }));
+    }
+    EXPECT_EQ(outputs.size(), group.running());
+
+    group.wait();
+    for (size_t n = 0; n < outputs.size(); n++) {
+        EXPECT_EQ(std::to_string(n) + "\n", outputs[n]);
+    }
+}
+
+TEST(SubprocessGroup, Directory)
+{
+    SubprocessGroup group;
+
+    std::string output;
+    ASSERT_TRUE(group.spawn("/bin/sh", { "-c", "pwd" }, { }, "/", ext::nullopt, true, false, [&](SubprocessGroup::Result const &r) {
+        output = r.output;
+    }));
+
+    group.wait();
+    EXPECT_EQ("/\n", output);
+}
+
+TEST(SubprocessGroup, Signal)
+{
+    SubprocessGroup group;
+
+    int exitcode = 0;
+    ASSERT_TRUE(group.spawn("/bin/sh", { "-c", "kill -9 $$" }, { }, "", ext::nullopt, false, false, [&](SubprocessGroup::Result const &r) {
+        exitcode = r.exitcode;
+    }));
+
+    group.wait();
+    EXPECT_EQ(128 + 9, exitcode);
+}
+
+TEST(SubprocessGroup, Subprocess)
+{
+    Subprocess process;
+
+    std::istringstream input("input");
+    std::ostringstream output;
+    std::ostringstream error;
+    ASSERT_TRUE(process.execute("/bin/sh", { "-c", "cat; echo error >&2; exit 1" }, &input, &output, &error));
+    EXPECT_EQ(1, process.exitcode());
+    EXPECT_EQ("input", output.str());
+    EXPECT_EQ("error\n", error.str());
+}
@@ -11,6 +11,7 @@
 #include <libutil/Wildcard.h>
 
 using libutil::Wildcard;
+using libutil::CompiledWildcard;
 
 TEST(Wildcard, Basic)
 {
@@ -49,3 +50,43 @@ TEST(Wildcard, One)
     EXPECT_FALSE(Wildcard::Match("[aA]", "b"));
 }
 
+
+TEST(Wildcard, Stars)
+{
+    EXPECT_TRUE(Wildcard::Match("**", ""));
+    EXPECT_TRUE(Wildcard::Match("a**b", "ab"));
+    EXPECT_TRUE(Wildcard::Match("*b*d", "abcd"));
+    EXPECT_TRUE(Wildcard::Match("*ab", "aab"));
+    EXPECT_TRUE(Wildcard::Match("*a*a*a", "aaa"));
+    EXPECT_TRUE(Wildcard::Match("*.[ch]", "main.c.h"));
+    EXPECT_FALSE(Wildcard::Match("a*b", "a"));
+    EXPECT_FALSE(Wildcard::Match("*a*a*a", "aa"));
+    EXPECT_FALSE(Wildcard::Match("*b*d", "abdc"));
+}
+
+/*
+ * The compiled matcher must agree with the one that interprets as it goes.
+ */
+static std::vector<std::pair<std::string, std::string>> const Cases = {
+    { "", "" }, { "", "a" }, { "a", "" },
+    { "a", "a" }, { "abcd", "abcd" }, { "abc", "abcd" }, { "abcd", "bcd" },
+    { "*", "" }, { "*", "abcd" }, { "a*", "a" }, { "*a", "a" }, { "*a*", "a" },
+    { "a*de", "abcde" }, { "a*d", "abcde" }, { "a*dce", "abcde" }, { "*a", "b" },
+    { "**", "" }, { "a**b", "ab" }, { "*b*d", "abcd" }, { "*ab", "aab" },
+    { "*a*a*a", "aaa" }, { "*a*a*a", "aa" }, { "*b*d", "abdc" }, { "a*b", "a" },
+    { "[", "[" }, { "[a]", "a" }, { "[aA]", "A" }, { "[aA]", "aA" }, { "[aA]", "b" },
+    { "[]", "" }, { "[]", "a" }, { "a[", "a[" }, { "a]", "a]" },
+    { "b[aei][dn]", "ban" }, { "b[aei][dn]", "bid" }, { "b[aei][dn]", "bed" }, { "b[aei][dn]", "bod" },
+    { "*.[ch]", "main.c" }, { "*.[ch]", "main.h" }, { "*.[ch]", "main.m" }, { "*.[ch]", "main.c.h" },
+    { "*[Mm]akefile*", "GNUmakefile.in" }, { "*[Mm]akefile*", "Makefil" },
+    { "lib*.dylib", "libz.dylib" }, { "lib*.dylib", "libz.a" },
+    { "iphone*", "iphoneos" }, { "iphone*", "iphonesimulator" }, { "iphone*", "macosx" },
+};
+
+TEST(CompiledWildcard, Match)
+{
+    for (auto const &pair : Cases) {
+        EXPECT_EQ(Wildcard::Match(pair.first, pair.second), CompiledWildcard(pair.first).match(pair.second))
+            << "'" << pair.first << "' against '" << pair.second << "'";
+    }
+}
@@ -0,0 +1,142 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <libutil/Hash.h>
+#include <libutil/Wildcard.h>
+#include <libutil/md5.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using libutil::Hash;
+using libutil::Wildcard;
+using libutil::CompiledWildcard;
+
+/*
+ * Reports how long operations take, so changes to them can be compared.
+ * Not run as a test, since timings depend on the machine and its load.
+ */
+
+static long long
+Microseconds(std::chrono::steady_clock::duration duration)
+{
+    return static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+}
+
+static void
+BenchmarkWildcard()
+{
+    /* Patterns and names like those in build settings and specifications. */
+    std::vector<std::pair<std::string, std::string>> const cases = {
+        { "*", "abcd" }, { "a*de", "abcde" }, { "a*dce", "abcde" }, { "*a*a*a", "aaa" },
+        { "b[aei][dn]", "ban" }, { "b[aei][dn]", "bod" },
+        { "*.[ch]", "main.c" }, { "*.[ch]", "main.m" }, { "*.[ch]", "main.c.h" },
+        { "*[Mm]akefile*", "GNUmakefile.in" }, { "*[Mm]akefile*", "Makefil" },
+        { "lib*.dylib", "libz.dylib" }, { "lib*.dylib", "libz.a" },
+        { "iphone*", "iphoneos" }, { "iphone*", "iphonesimulator" }, { "iphone*", "macosx" },
+    };
+    size_t const iterations = 100000;
+
+    std::vector<CompiledWildcard> compiled;
+    for (auto const &pair : cases) {
+        compiled.push_back(CompiledWildcard(pair.first));
+    }
+
+    size_t interpretedMatches = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t n = 0; n < iterations; n++) {
+        for (auto const &pair : cases) {
+            interpretedMatches += Wildcard::Match(pair.first, pair.second);
+        }
+    }
+    std::chrono::steady_clock::duration interpreted = std::chrono::steady_clock::now() - start;
+
+    size_t compiledMatches = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t n = 0; n < iterations; n++) {
+        for (size_t c = 0; c < cases.size(); c++) {
+            compiledMatches += compiled[c].match(cases[c].second);
+        }
+    }
+    std::chrono::steady_clock::duration compiledDuration = std::chrono::steady_clock::now() - start;
+
+    if (interpretedMatches != compiledMatches) {
+        fprintf(stderr, "error: matchers disagree (%zu and %zu matches)\n", interpretedMatches, compiledMatches);
+    }
+
+    printf("Wildcard::Match: %lld us, CompiledWildcard::match: %lld us (%zu matches)\n",
+        Microseconds(interpreted), Microseconds(compiledDuration), iterations * cases.size());
+}
+
+static void
+BenchmarkHash()
+{
+    std::vector<uint8_t> input = std::vector<uint8_t>(64 * 1024 * 1024);
+    for (size_t n = 0; n < input.size(); n++) {
+        input[n] = static_cast<uint8_t>(n * 31 + n / 7);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    md5_state_t state;
+    md5_init(&state);
+    md5_append(&state, reinterpret_cast<const md5_byte_t *>(input.data()), input.size());
+    uint8_t digest[16];
+    md5_finish(&state, reinterpret_cast<md5_byte_t *>(&digest));
+    std::chrono::steady_clock::duration md5 = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    Hash hash;
+    hash.update(input.data(), input.size());
+    uint64_t result = hash.digest64();
+    std::chrono::steady_clock::duration murmur = std::chrono::steady_clock::now() - start;
+
+    auto throughput = [&](std::chrono::steady_clock::duration duration) {
+        double seconds = std::chrono::duration<double>(duration).count();
+        return (seconds > 0 ? input.size() / seconds / (1024 * 1024) : 0);
+    };
+
+    /* Print the results so neither hash can be optimized away. */
+    printf("md5: %.0f MiB/s, Hash: %.0f MiB/s (%02x, %016llx)\n",
+        throughput(md5), throughput(murmur), digest[0], static_cast<unsigned long long>(result));
+}
+
+int
+main(int argc, char **argv)
+{
+    struct Benchmark {
+        char const *name;
+        void      (*run)();
+    };
+    std::vector<Benchmark> const benchmarks = {
+        { "wildcard", &BenchmarkWildcard },
+        { "hash",     &BenchmarkHash },
+    };
+
+    bool found = false;
+    for (Benchmark const &benchmark : benchmarks) {
+        if (argc < 2 || ::strcmp(argv[1], benchmark.name) == 0) {
+            benchmark.run();
+            found = true;
+        }
+    }
+
+    if (!found) {
+        fprintf(stderr, "usage: %s [", argv[0]);
+        for (size_t n = 0; n < benchmarks.size(); n++) {
+            fprintf(stderr, "%s%s", (n != 0 ? "|" : ""), benchmarks[n].name);
+        }
+        fprintf(stderr, "]\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -14,8 +14,13 @@
 #include <pbxbuild/WorkspaceContext.h>
 #include <pbxbuild/Build/Environment.h>
 #include <pbxbuild/Target/Environment.h>
+#include <pbxbuild/Tool/HeadermapIndex.h>
+#include <pbxbuild/Tool/SearchPaths.h>
 
 #include <ext/optional>
+#include <condition_variable>
+#include <mutex>
+#include <unordered_set>
 
 namespace pbxbuild {
 namespace Build {
@@ -26,6 +31,22 @@ namespace Build {
  * to custom options that can be passed into certain builds.
  */
 class Context {
+private:
+    /*
+     * Target environments computed for the build. The configuration and
+     * override levels are fixed for a context, so the target is the key.
+     */
+    struct TargetEnvironments {
+        std::mutex                                                                              mutex;
+        std::condition_variable                                                                 condition;
+        std::unordered_map<pbxproj::PBX::Target::shared_ptr, ext::optional<Target::Environment>> environments;
+        std::unordered_set<pbxproj::PBX::Target::shared_ptr>                                    creating;
+        size_t                                                                                  created;
+        size_t                                                                                  reused;
+
+        TargetEnvironments();
+    };
+
 private:
     WorkspaceContext                  _workspaceContext;
     xcscheme::XC::Scheme::shared_ptr  _scheme;
@@ -36,7 +57,9 @@ private:
     std::vector<pbxsetting::Level>    _overrideLevels;
 
 private:
-    std::shared_ptr<std::unordered_map<pbxproj::PBX::Target::shared_ptr, Target::Environment>> _targetEnvironments;
+    std::shared_ptr<TargetEnvironments>                                                       _targetEnvironments;
+    std::shared_ptr<Tool::HeadermapIndex::Cache>                                              _headermapIndexes;
+    std::shared_ptr<Tool::SearchPaths::Cache>                                                 _searchPathsCache;
 
 public:
     Context(
@@ -107,11 +130,31 @@ public:
 
 public:
     /*
-     * Create or fetch a target's computed environment.
+     * Create or fetch a target's computed environment. Each target's
+     * environment is created at most once per build, even if it fails.
      */
     ext::optional<Target::Environment>
     targetEnvironment(Build::Environment const &buildEnvironment, pbxproj::PBX::Target::shared_ptr const &target) const;
 
+    /*
+     * The number of target environments created, and the number of
+     * requests answered from a previously created environment.
+     */
+    size_t targetEnvironmentsCreated() const;
+    size_t targetEnvironmentsReused() const;
+
+    /*
+     * The project header indexes shared by all targets in the build.
+     */
+    std::shared_ptr<Tool::HeadermapIndex::Cache> const &headermapIndexes() const
+    { return _headermapIndexes; }
+
+    /*
+     * The expanded recursive search paths shared by all targets in the build.
+     */
+    std::shared_ptr<Tool::SearchPaths::Cache> const &searchPathsCache() const
+    { return _searchPathsCache; }
+
 public:
     /*
      * Finds a target by identifier within a project.
@@ -11,8 +11,11 @@
 #define __pbxbuild_Build_Environment_h
 
 #include <pbxbuild/Base.h>
+#include <pbxbuild/FileTypeResolver.h>
 
 #include <ext/optional>
+#include <map>
+#include <mutex>
 
 namespace libutil { class Filesystem; }
 
@@ -29,6 +32,13 @@ private:
     std::shared_ptr<xcsdk::SDK::Manager> _sdkManager;
     pbxsetting::Environment              _baseEnvironment;
 
+private:
+    struct FileTypeResolvers {
+        std::mutex                                                       mutex;
+        std::map<std::vector<std::string>, FileTypeResolver::shared_ptr> resolvers;
+    };
+    std::shared_ptr<FileTypeResolvers>   _fileTypeResolvers;
+
 public:
     Environment(
         pbxspec::Manager::shared_ptr const &specManager,
@@ -48,6 +58,14 @@ public:
     std::shared_ptr<xcsdk::SDK::Manager> const &sdkManager() const
     { return _sdkManager; }
 
+public:
+    /*
+     * The file type resolver for a set of specification domains. Compiled
+     * on first use, then shared by all copies of this build environment.
+     */
+    FileTypeResolver::shared_ptr
+    fileTypeResolver(std::vector<std::string> const &domains) const;
+
 public:
     /*
      * The base environment from the system.
@@ -11,39 +11,96 @@
 #define __pbxbuild_FileTypeResolver_h
 
 #include <pbxbuild/Base.h>
-#include <pbxbuild/Build/Environment.h>
+#include <libutil/Wildcard.h>
+
+namespace libutil { class Filesystem; }
 
 namespace pbxbuild {
 
 /*
- * Determines the file type of a file.
+ * Determines the file type of a file. A resolver is compiled once for a set
+ * of specification domains and then reused for every file in the build.
  */
 class FileTypeResolver {
+public:
+    typedef std::shared_ptr<FileTypeResolver> shared_ptr;
+
+private:
+    /*
+     * A trie over file name prefixes, for file types that match on a prefix
+     * but have no extensions to index them by.
+     */
+    struct PrefixNode {
+        std::unordered_map<char, size_t> children;
+        std::vector<size_t>              fileTypes;
+    };
+
+private:
+    pbxspec::Manager::shared_ptr                         _specManager;
+    std::vector<std::string>                             _domains;
+
+private:
+    pbxspec::PBX::FileType::vector                       _fileTypes;
+    std::unordered_map<std::string, std::vector<size_t>> _extensions;
+    std::vector<PrefixNode>                              _prefixes;
+    std::vector<size_t>                                  _unindexed;
+
+private:
+    /*
+     * The file name patterns of each file type, parsed once.
+     */
+    std::vector<std::vector<libutil::CompiledWildcard>>  _filenamePatterns;
+
 private:
-    FileTypeResolver();
+    pbxspec::PBX::FileType::shared_ptr                   _file;
+    pbxspec::PBX::FileType::shared_ptr                   _folder;
+
+private:
+    FileTypeResolver(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxspec::PBX::FileType::vector const &fileTypes);
+
+public:
     ~FileTypeResolver();
 
 public:
     /*
-     * Determine the file type of a file path.
+     * The domains the resolver finds file types in.
+     */
+    std::vector<std::string> const &domains() const
+    { return _domains; }
+
+public:
+    /*
+     * Determine the file type of a file path. The filesystem is checked for
+     * file types that depend on what is at the path.
      */
-    static pbxspec::PBX::FileType::shared_ptr
-    Resolve(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, std::string const &filePath);
+    pbxspec::PBX::FileType::shared_ptr
+    resolve(libutil::Filesystem const *filesystem, std::string const &filePath) const;
 
     /*
      * Determine the file type of a file reference. If a file reference is available, use
      * this method instead of the one with just the file type, as the reference can override
      * the automatically determined file type from the file path.
      */
-    static pbxspec::PBX::FileType::shared_ptr
-    Resolve(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxproj::PBX::FileReference::shared_ptr const &fileReference, std::string const &filePath);
+    pbxspec::PBX::FileType::shared_ptr
+    resolve(libutil::Filesystem const *filesystem, pbxproj::PBX::FileReference::shared_ptr const &fileReference, std::string const &filePath) const;
 
     /*
      * Determine the file type of a version group. Uses the explicit file type or falls back
      * to autodetecting the file type from the path provided.
      */
-    static pbxspec::PBX::FileType::shared_ptr
-    Resolve(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxproj::XC::VersionGroup::shared_ptr const &versionGroup, std::string const &filePath);
+    pbxspec::PBX::FileType::shared_ptr
+    resolve(libutil::Filesystem const *filesystem, pbxproj::XC::VersionGroup::shared_ptr const &versionGroup, std::string const &filePath) const;
+
+private:
+    void candidates(std::string const &fileExtension, std::string const &fileName, std::vector<size_t> *candidates) const;
+
+public:
+    /*
+     * Compile a resolver for the file types in the specified domains. The file
+     * types are sorted once, so more specific file types are checked first.
+     */
+    static FileTypeResolver::shared_ptr
+    Create(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains);
 };
 
 }
@@ -20,15 +20,23 @@ namespace Phase {
 
 class Environment {
 private:
+    libutil::Filesystem const       *_filesystem;
     Build::Environment               _buildEnvironment;
     Build::Context                   _buildContext;
     pbxproj::PBX::Target::shared_ptr _target;
     Target::Environment              _targetEnvironment;
 
 public:
-    Environment(Build::Environment const &buildEnvironment, Build::Context const &buildContext, pbxproj::PBX::Target::shared_ptr const &target, Target::Environment const &targetEnvironment);
+    Environment(libutil::Filesystem const *filesystem, Build::Environment const &buildEnvironment, Build::Context const &buildContext, pbxproj::PBX::Target::shared_ptr const &target, Target::Environment const &targetEnvironment);
     ~Environment();
 
+public:
+    /*
+     * The filesystem to check while resolving the target's phases.
+     */
+    libutil::Filesystem const *filesystem() const
+    { return _filesystem; }
+
 public:
     Build::Environment const &buildEnvironment() const
     { return _buildEnvironment; }
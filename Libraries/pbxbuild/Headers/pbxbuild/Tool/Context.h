@@ -30,6 +30,8 @@ private:
 
 private:
     SearchPaths                         _searchPaths;
+    libutil::Filesystem const          *_filesystem;
+    std::shared_ptr<SearchPaths::Cache> _searchPathsCache;
 
 private:
     HeadermapInfo                       _headermapInfo;
@@ -47,7 +49,9 @@ public:
         xcsdk::SDK::Toolchain::vector const &toolchains,
         std::vector<std::string> const &executablePaths,
         std::string const &workingDirectory,
-        SearchPaths const &searchPaths);
+        SearchPaths const &searchPaths,
+        libutil::Filesystem const *filesystem,
+        std::shared_ptr<SearchPaths::Cache> const &searchPathsCache);
     ~Context();
 
 public:
@@ -63,6 +67,10 @@ public:
 public:
     SearchPaths const &searchPaths() const
     { return _searchPaths; }
+    libutil::Filesystem const *filesystem() const
+    { return _filesystem; }
+    std::shared_ptr<SearchPaths::Cache> const &searchPathsCache() const
+    { return _searchPathsCache; }
 
 public:
     HeadermapInfo const &headermapInfo() const
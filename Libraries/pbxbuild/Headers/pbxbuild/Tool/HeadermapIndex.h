@@ -0,0 +1,175 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __pbxbuild_Tool_HeadermapIndex_h
+#define __pbxbuild_Tool_HeadermapIndex_h
+
+#include <pbxbuild/Base.h>
+#include <pbxbuild/FileTypeResolver.h>
+
+#include <map>
+#include <mutex>
+
+namespace pbxbuild {
+namespace Tool {
+
+/*
+ * The headers in a project, by name, and the targets they belong to. Built
+ * once for a project and shared by the headermaps of all of its targets.
+ */
+class HeadermapIndex {
+public:
+    typedef std::shared_ptr<HeadermapIndex> shared_ptr;
+
+public:
+    /*
+     * A header file in the project.
+     */
+    class Header {
+    private:
+        std::string _name;
+        std::string _directory;
+
+    public:
+        Header(std::string const &name, std::string const &directory);
+
+    public:
+        /*
+         * The file name of the header.
+         */
+        std::string const &name() const
+        { return _name; }
+
+        /*
+         * The directory containing the header, with a trailing slash.
+         */
+        std::string const &directory() const
+        { return _directory; }
+    };
+
+    /*
+     * A header file in the headers build phase of a target.
+     */
+    class TargetHeader {
+    private:
+        pbxproj::PBX::Target::shared_ptr _target;
+        Header                           _header;
+        std::string                      _frameworkName;
+        bool                             _isPublic;
+        bool                             _isPrivate;
+        bool                             _isNonFramework;
+
+    public:
+        TargetHeader(pbxproj::PBX::Target::shared_ptr const &target, Header const &header, std::string const &frameworkName, bool isPublic, bool isPrivate, bool isNonFramework);
+
+    public:
+        pbxproj::PBX::Target::shared_ptr const &target() const
+        { return _target; }
+        Header const &header() const
+        { return _header; }
+
+    public:
+        /*
+         * The header name prefixed with the target's product name.
+         */
+        std::string const &frameworkName() const
+        { return _frameworkName; }
+
+    public:
+        bool isPublic() const
+        { return _isPublic; }
+        bool isPrivate() const
+        { return _isPrivate; }
+
+        /*
+         * If the target's product is not a framework.
+         */
+        bool isNonFramework() const
+        { return _isNonFramework; }
+    };
+
+public:
+    /*
+     * Caches indexes for the projects in a build. Since file references are
+     * relative to source trees, an index is shared by targets where those
+     * source trees resolve to the same paths.
+     */
+    class Cache {
+    private:
+        struct Project {
+            std::vector<pbxsetting::Value>                                 sourceTrees;
+            std::map<std::vector<std::string>, HeadermapIndex::shared_ptr> indexes;
+        };
+
+    private:
+        std::mutex                                                     _mutex;
+        std::unordered_map<pbxproj::PBX::Project::shared_ptr, Project> _projects;
+
+    public:
+        Cache();
+        ~Cache();
+
+    public:
+        /*
+         * Create or fetch the index for a project.
+         */
+        HeadermapIndex::shared_ptr
+        index(libutil::Filesystem const *filesystem, FileTypeResolver const &fileTypeResolver, pbxproj::PBX::Project::shared_ptr const &project, pbxsetting::Environment const &environment);
+    };
+
+private:
+    std::vector<Header>       _projectHeaders;
+    std::vector<TargetHeader> _targetHeaders;
+
+private:
+    std::vector<uint8_t>      _projectHeadermap;
+    std::vector<uint8_t>      _allTargetHeadermap;
+    std::vector<uint8_t>      _allNonFrameworkTargetHeadermap;
+
+public:
+    HeadermapIndex(std::vector<Header> const &projectHeaders, std::vector<TargetHeader> const &targetHeaders);
+    ~HeadermapIndex();
+
+public:
+    /*
+     * All header file references in the project.
+     */
+    std::vector<Header> const &projectHeaders() const
+    { return _projectHeaders; }
+
+    /*
+     * All headers in the headers build phases of the project's targets,
+     * in target order.
+     */
+    std::vector<TargetHeader> const &targetHeaders() const
+    { return _targetHeaders; }
+
+public:
+    /*
+     * Serialized headermaps that are the same for every target in the project.
+     */
+    std::vector<uint8_t> const &projectHeadermap() const
+    { return _projectHeadermap; }
+    std::vector<uint8_t> const &allTargetHeadermap() const
+    { return _allTargetHeadermap; }
+    std::vector<uint8_t> const &allNonFrameworkTargetHeadermap() const
+    { return _allNonFrameworkTargetHeadermap; }
+
+public:
+    /*
+     * Scan a project for its headers.
+     */
+    static HeadermapIndex::shared_ptr
+    Create(libutil::Filesystem const *filesystem, FileTypeResolver const &fileTypeResolver, pbxproj::PBX::Project::shared_ptr const &project, pbxsetting::Environment const &environment);
+};
+
+}
+}
+
+#endif // !__pbxbuild_Tool_HeadermapIndex_h
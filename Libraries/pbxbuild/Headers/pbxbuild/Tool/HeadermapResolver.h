@@ -13,6 +13,8 @@
 #include <pbxbuild/Base.h>
 #include <pbxbuild/Tool/Invocation.h>
 #include <pbxbuild/Phase/Environment.h>
+#include <pbxbuild/Tool/HeadermapIndex.h>
+#include <pbxbuild/FileTypeResolver.h>
 
 namespace pbxbuild {
 namespace Tool {
@@ -22,12 +24,14 @@ class Context;
 
 class HeadermapResolver {
 private:
-    pbxspec::PBX::Tool::shared_ptr     _tool;
-    pbxspec::PBX::Compiler::shared_ptr _compiler;
-    pbxspec::Manager::shared_ptr       _specManager;
+    libutil::Filesystem const                   *_filesystem;
+    pbxspec::PBX::Tool::shared_ptr               _tool;
+    pbxspec::PBX::Compiler::shared_ptr           _compiler;
+    FileTypeResolver::shared_ptr                 _fileTypeResolver;
+    std::shared_ptr<Tool::HeadermapIndex::Cache> _headermapIndexes;
 
 public:
-    HeadermapResolver(pbxspec::PBX::Tool::shared_ptr const &tool, pbxspec::PBX::Compiler::shared_ptr const &compiler, pbxspec::Manager::shared_ptr const &specManager);
+    HeadermapResolver(libutil::Filesystem const *filesystem, pbxspec::PBX::Tool::shared_ptr const &tool, pbxspec::PBX::Compiler::shared_ptr const &compiler, FileTypeResolver::shared_ptr const &fileTypeResolver, std::shared_ptr<Tool::HeadermapIndex::Cache> const &headermapIndexes);
 
 public:
     void resolve(
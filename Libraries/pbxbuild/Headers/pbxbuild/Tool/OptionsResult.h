@@ -11,11 +11,13 @@
 #define __pbxbuild_Tool_OptionsResult_h
 
 #include <pbxbuild/Base.h>
+#include <pbxbuild/Tool/SearchPaths.h>
 
 namespace pbxbuild {
 namespace Tool {
 
 class Environment;
+class Context;
 
 class OptionsResult {
 private:
@@ -37,15 +39,17 @@ public:
 
 public:
     static OptionsResult Create(
+        libutil::Filesystem const *filesystem,
         pbxsetting::Environment const &environment,
         std::string const &workingDirectory,
         std::vector<pbxspec::PBX::PropertyOption::shared_ptr> const &options,
         pbxspec::PBX::FileType::shared_ptr const &fileType,
-        std::unordered_set<std::string> const &deletedSettings = std::unordered_set<std::string>());
+        std::unordered_set<std::string> const &deletedSettings = std::unordered_set<std::string>(),
+        Tool::SearchPaths::Cache *searchPathsCache = nullptr);
 
     static OptionsResult Create(
         Tool::Environment const &toolEnvironment,
-        std::string const &workingDirectory,
+        Tool::Context const *toolContext,
         pbxspec::PBX::FileType::shared_ptr const &fileType);
 };
 
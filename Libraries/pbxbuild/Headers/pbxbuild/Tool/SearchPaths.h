@@ -12,12 +12,62 @@
 
 #include <pbxbuild/Base.h>
 
+#include <map>
+#include <mutex>
+
+namespace libutil { class Filesystem; }
+
 namespace pbxbuild {
 namespace Tool {
 
 class Context;
 
 class SearchPaths {
+public:
+    /*
+     * Caches the expansion of search paths for a build. Most targets share
+     * the same search paths, so each directory tree is only walked once.
+     */
+    class Cache {
+    private:
+        struct Entry {
+            bool                     exists;
+            std::vector<std::string> directories;
+        };
+
+    private:
+        std::mutex                                    _mutex;
+        std::map<std::pair<std::string, bool>, Entry> _entries;
+
+    public:
+        Cache();
+        ~Cache();
+
+    public:
+        /*
+         * If a path is a directory. Not recursive.
+         */
+        bool isDirectory(libutil::Filesystem const *filesystem, std::string const &path);
+
+        /*
+         * The subdirectories of a directory, relative to it, in the order a
+         * recursive enumeration would find them.
+         */
+        std::vector<std::string> subdirectories(libutil::Filesystem const *filesystem, std::string const &path);
+
+    public:
+        /*
+         * Drop entries for paths inside of, or containing, any of the given
+         * paths. Needed when targets are built while others are still being
+         * resolved, since building can create new search paths.
+         */
+        void invalidate(std::vector<std::string> const &paths);
+
+    private:
+        Entry entry(libutil::Filesystem const *filesystem, std::string const &path, bool recursive);
+        static Entry Walk(libutil::Filesystem const *filesystem, std::string const &path, bool recursive);
+    };
+
 private:
     std::vector<std::string> _headerSearchPaths;
     std::vector<std::string> _userHeaderSearchPaths;
@@ -43,11 +93,11 @@ public:
 
 public:
     static Tool::SearchPaths
-    Create(pbxsetting::Environment const &environment, std::string const &workingDirectory);
+    Create(libutil::Filesystem const *filesystem, pbxsetting::Environment const &environment, std::string const &workingDirectory, Cache *cache = nullptr);
 
 public:
     static std::vector<std::string>
-    ExpandRecursive(std::vector<std::string> const &paths, pbxsetting::Environment const &environment, std::string const &workingDirectory);
+    ExpandRecursive(libutil::Filesystem const *filesystem, std::vector<std::string> const &paths, pbxsetting::Environment const &environment, std::string const &workingDirectory, Cache *cache = nullptr);
 };
 
 }
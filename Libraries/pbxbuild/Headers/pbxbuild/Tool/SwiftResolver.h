@@ -22,10 +22,11 @@ class Context;
 
 class SwiftResolver {
 private:
+    libutil::Filesystem const         *_filesystem;
     pbxspec::PBX::Compiler::shared_ptr _compiler;
 
 private:
-    explicit SwiftResolver(pbxspec::PBX::Compiler::shared_ptr const &compiler);
+    SwiftResolver(libutil::Filesystem const *filesystem, pbxspec::PBX::Compiler::shared_ptr const &compiler);
 
 public:
     void resolve(
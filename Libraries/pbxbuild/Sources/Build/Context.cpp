@@ -11,6 +11,14 @@
 
 namespace Build = pbxbuild::Build;
 namespace Target = pbxbuild::Target;
+namespace Tool = pbxbuild::Tool;
+
+Build::Context::TargetEnvironments::
+TargetEnvironments() :
+    created(0),
+    reused (0)
+{
+}
 
 Build::Context::
 Context(
@@ -29,23 +37,54 @@ Context(
     _configuration       (configuration),
     _defaultConfiguration(defaultConfiguration),
     _overrideLevels      (overrideLevels),
-    _targetEnvironments  (std::make_shared<std::unordered_map<pbxproj::PBX::Target::shared_ptr, Target::Environment>>())
+    _targetEnvironments  (std::make_shared<TargetEnvironments>()),
+    _headermapIndexes    (std::make_shared<Tool::HeadermapIndex::Cache>()),
+    _searchPathsCache    (std::make_shared<Tool::SearchPaths::Cache>())
 {
 }
 
 ext::optional<pbxbuild::Target::Environment> Build::Context::
 targetEnvironment(Build::Environment const &buildEnvironment, pbxproj::PBX::Target::shared_ptr const &target) const
 {
-    auto TEI = _targetEnvironments->find(target);
-    if (TEI != _targetEnvironments->end()) {
-        return TEI->second;
-    } else {
-        ext::optional<Target::Environment> targetEnvironment = Target::Environment::Create(buildEnvironment, *this, target);
-        if (targetEnvironment) {
-            _targetEnvironments->insert(std::make_pair(target, *targetEnvironment));
+    {
+        std::unique_lock<std::mutex> lock(_targetEnvironments->mutex);
+
+        /* Wait for another caller already creating the same environment. */
+        _targetEnvironments->condition.wait(lock, [&]() {
+            return _targetEnvironments->creating.find(target) == _targetEnvironments->creating.end();
+        });
+
+        auto TEI = _targetEnvironments->environments.find(target);
+        if (TEI != _targetEnvironments->environments.end()) {
+            _targetEnvironments->reused++;
+            return TEI->second;
         }
-        return targetEnvironment;
+
+        _targetEnvironments->creating.insert(target);
     }
+
+    /* Create outside the lock so other targets aren't blocked meanwhile. */
+    ext::optional<Target::Environment> targetEnvironment = Target::Environment::Create(buildEnvironment, *this, target);
+
+    std::lock_guard<std::mutex> lock(_targetEnvironments->mutex);
+    _targetEnvironments->created++;
+    _targetEnvironments->creating.erase(target);
+    _targetEnvironments->condition.notify_all();
+    return _targetEnvironments->environments.insert({ target, targetEnvironment }).first->second;
+}
+
+size_t Build::Context::
+targetEnvironmentsCreated() const
+{
+    std::lock_guard<std::mutex> lock(_targetEnvironments->mutex);
+    return _targetEnvironments->created;
+}
+
+size_t Build::Context::
+targetEnvironmentsReused() const
+{
+    std::lock_guard<std::mutex> lock(_targetEnvironments->mutex);
+    return _targetEnvironments->reused;
 }
 
 pbxproj::PBX::Target::shared_ptr Build::Context::
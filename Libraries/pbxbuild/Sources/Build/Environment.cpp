@@ -17,10 +17,26 @@ Build::Environment::
 Environment(pbxspec::Manager::shared_ptr const &specManager, std::shared_ptr<xcsdk::SDK::Manager> const &sdkManager, pbxsetting::Environment const &baseEnvironment) :
     _specManager(specManager),
     _sdkManager(sdkManager),
-    _baseEnvironment(baseEnvironment)
+    _baseEnvironment(baseEnvironment),
+    _fileTypeResolvers(std::make_shared<FileTypeResolvers>())
 {
 }
 
+pbxbuild::FileTypeResolver::shared_ptr Build::Environment::
+fileTypeResolver(std::vector<std::string> const &domains) const
+{
+    std::lock_guard<std::mutex> lock(_fileTypeResolvers->mutex);
+
+    auto it = _fileTypeResolvers->resolvers.find(domains);
+    if (it != _fileTypeResolvers->resolvers.end()) {
+        return it->second;
+    }
+
+    FileTypeResolver::shared_ptr resolver = FileTypeResolver::Create(_specManager, domains);
+    _fileTypeResolvers->resolvers.insert({ domains, resolver });
+    return resolver;
+}
+
 ext::optional<Build::Environment> Build::Environment::
 Default(Filesystem const *filesystem)
 {
@@ -9,15 +9,19 @@
 
 #include <pbxbuild/FileTypeResolver.h>
 #include <pbxbuild/DirectedGraph.h>
+#include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
+#include <libutil/MappedBuffer.h>
 #include <libutil/Wildcard.h>
 
-#include <fstream>
+#include <algorithm>
 
 using pbxbuild::FileTypeResolver;
 using pbxbuild::DirectedGraph;
+using libutil::Filesystem;
 using libutil::FSUtil;
-using libutil::Wildcard;
+using libutil::MappedBuffer;
+using libutil::CompiledWildcard;
 
 static ext::optional<std::vector<pbxspec::PBX::FileType::shared_ptr>>
 SortedFileTypes(std::vector<pbxspec::PBX::FileType::shared_ptr> const &fileTypes)
@@ -35,51 +39,157 @@ SortedFileTypes(std::vector<pbxspec::PBX::FileType::shared_ptr> const &fileTypes
     return graph.ordered();
 }
 
-pbxspec::PBX::FileType::shared_ptr FileTypeResolver::
-Resolve(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, std::string const &filePath)
+static std::string
+FoldCase(std::string const &string)
+{
+    std::string folded = string;
+    for (char &c : folded) {
+        if (c >= 'A' && c <= 'Z') {
+            c = c - 'A' + 'a';
+        }
+    }
+    return folded;
+}
+
+FileTypeResolver::
+FileTypeResolver(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxspec::PBX::FileType::vector const &fileTypes) :
+    _specManager     (specManager),
+    _domains         (domains),
+    _fileTypes       (fileTypes),
+    _prefixes        (1),
+    _filenamePatterns(fileTypes.size()),
+    _file            (specManager->fileType("file", domains)),
+    _folder          (specManager->fileType("folder", domains))
+{
+    for (size_t n = 0; n < _fileTypes.size(); n++) {
+        pbxspec::PBX::FileType::shared_ptr const &fileType = _fileTypes[n];
+
+        if (fileType->filenamePatterns()) {
+            for (std::string const &pattern : *fileType->filenamePatterns()) {
+                _filenamePatterns[n].push_back(CompiledWildcard(pattern));
+            }
+        }
+
+        if (fileType->extensions()) {
+            /* Extensions are compared case insensitively, e.g. ".S" as ".s". */
+            std::unordered_set<std::string> seen;
+            for (std::string const &extension : *fileType->extensions()) {
+                std::string folded = FoldCase(extension);
+                if (seen.insert(folded).second) {
+                    _extensions[folded].push_back(n);
+                }
+            }
+        } else if (fileType->prefix()) {
+            for (std::string const &prefix : *fileType->prefix()) {
+                size_t node = 0;
+                for (char c : prefix) {
+                    auto it = _prefixes[node].children.find(c);
+                    if (it != _prefixes[node].children.end()) {
+                        node = it->second;
+                    } else {
+                        _prefixes.push_back(PrefixNode());
+                        _prefixes[node].children.insert({ c, _prefixes.size() - 1 });
+                        node = _prefixes.size() - 1;
+                    }
+                }
+
+                std::vector<size_t> *nodeFileTypes = &_prefixes[node].fileTypes;
+                if (std::find(nodeFileTypes->begin(), nodeFileTypes->end(), n) == nodeFileTypes->end()) {
+                    nodeFileTypes->push_back(n);
+                }
+            }
+        } else if (fileType->filenamePatterns() || fileType->permissions() || fileType->magicWords()) {
+            /* Can't be indexed; checked against every file. */
+            _unindexed.push_back(n);
+        } else {
+            /* Matches no checks, so can never match. */
+        }
+    }
+}
+
+FileTypeResolver::
+~FileTypeResolver()
 {
-    bool isReadable = FSUtil::TestForRead(filePath);
-    bool isFolder = isReadable && FSUtil::TestForDirectory(filePath);
+}
+
+void FileTypeResolver::
+candidates(std::string const &fileExtension, std::string const &fileName, std::vector<size_t> *candidates) const
+{
+    auto it = _extensions.find(FoldCase(fileExtension));
+    if (it != _extensions.end()) {
+        candidates->insert(candidates->end(), it->second.begin(), it->second.end());
+    }
+
+    if (!_prefixes[0].children.empty()) {
+        size_t node = 0;
+        for (char c : fileName) {
+            auto child = _prefixes[node].children.find(c);
+            if (child == _prefixes[node].children.end()) {
+                break;
+            }
+
+            node = child->second;
+            candidates->insert(candidates->end(), _prefixes[node].fileTypes.begin(), _prefixes[node].fileTypes.end());
+        }
+    }
 
+    candidates->insert(candidates->end(), _unindexed.begin(), _unindexed.end());
+
+    /* Check candidates in sorted order, so more specific file types win. */
+    std::sort(candidates->begin(), candidates->end());
+    candidates->erase(std::unique(candidates->begin(), candidates->end()), candidates->end());
+}
+
+pbxspec::PBX::FileType::shared_ptr FileTypeResolver::
+resolve(Filesystem const *filesystem, std::string const &filePath) const
+{
     std::string fileExtension = FSUtil::GetFileExtension(filePath);
     std::string fileName = FSUtil::GetBaseName(filePath);
 
-    std::ifstream fileHandle;
-    std::vector<uint8_t> fileContents;
+    /*
+     * The filesystem is only checked once a candidate file type needs it.
+     */
+    ext::optional<bool> isReadableCache;
+    ext::optional<bool> isFolderCache;
+    auto isReadable = [&]() -> bool {
+        if (!isReadableCache) {
+            isReadableCache = filesystem->isReadable(filePath);
+        }
+        return *isReadableCache;
+    };
+    auto isFolder = [&]() -> bool {
+        if (!isFolderCache) {
+            isFolderCache = isReadable() && filesystem->isDirectory(filePath);
+        }
+        return *isFolderCache;
+    };
+
+    ext::optional<bool> isMappedCache;
+    MappedBuffer fileContents;
+    auto isMapped = [&]() -> bool {
+        if (!isMappedCache) {
+            isMappedCache = filesystem->map(&fileContents, filePath);
+        }
+        return *isMappedCache;
+    };
 
-    // Reverse first so more specific file types are processed first.
-    std::vector<pbxspec::PBX::FileType::shared_ptr> const &fileTypes = specManager->fileTypes(domains);
-    ext::optional<std::vector<pbxspec::PBX::FileType::shared_ptr>> result = SortedFileTypes(fileTypes);
-    if (!result) {
-        fprintf(stderr, "error: cycle creating file type graph\n");
-        return nullptr;
-    }
+    std::vector<size_t> candidates;
+    this->candidates(fileExtension, fileName, &candidates);
+
+    for (size_t index : candidates) {
+        pbxspec::PBX::FileType::shared_ptr const &fileType = _fileTypes[index];
 
-    std::vector<pbxspec::PBX::FileType::shared_ptr> const &sortedFileTypes = *result;
-    for (pbxspec::PBX::FileType::shared_ptr const &fileType : sortedFileTypes) {
-        if (isReadable && fileType->isFolder() != isFolder) {
+        if (isReadable() && fileType->isFolder() != isFolder()) {
             continue;
         }
 
         bool empty = true;
 
         if (fileType->extensions()) {
+            /* Candidates with extensions were found by their extension. */
             empty = false;
-            bool matched = false;
-
-            for (std::string const &extension : *fileType->extensions()) {
-                // TODO(grp): Is this correct? Needed for handling ".S" as ".s", but might be over-broad.
-                if (strcasecmp(extension.c_str(), fileExtension.c_str()) == 0) {
-                    matched = true;
-                }
-            }
-
-            if (!matched) {
-                continue;
-            }
         }
 
-
         if (fileType->prefix()) {
             empty = false;
             bool matched = false;
@@ -99,9 +209,10 @@ Resolve(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string
             empty = false;
             bool matched = false;
 
-            for (std::string const &pattern : *fileType->filenamePatterns()) {
-                if (Wildcard::Match(pattern, fileName)) {
+            for (CompiledWildcard const &pattern : _filenamePatterns[index]) {
+                if (pattern.match(fileName)) {
                     matched = true;
+                    break;
                 }
             }
 
@@ -110,17 +221,17 @@ Resolve(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string
             }
         }
 
-        if (isReadable && fileType->permissions()) {
+        if (fileType->permissions() && isReadable()) {
             empty = false;
             bool matched = false;
 
             std::string const &permissions = *fileType->permissions();
             if (permissions == "read") {
-                matched = isReadable;
+                matched = isReadable();
             } else if (permissions == "write") {
-                matched = FSUtil::TestForWrite(filePath);
+                matched = filesystem->isWritable(filePath);
             } else if (permissions == "executable") {
-                matched = FSUtil::TestForExecute(filePath);
+                matched = filesystem->isExecutable(filePath);
             } else {
                 fprintf(stderr, "warning: unhandled permission %s\n", permissions.c_str());
             }
@@ -132,29 +243,12 @@ Resolve(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string
 
         // TODO(grp): Support TypeCodes. Not very important.
 
-        if (isReadable && fileType->magicWords()) {
+        if (fileType->magicWords() && isReadable()) {
             empty = false;
             bool matched = false;
 
             for (std::vector<uint8_t> const &magicWord : *fileType->magicWords()) {
-                if (fileContents.size() < magicWord.size()) {
-                    if (!fileHandle.is_open()) {
-                        fileHandle.open(fileName, std::ios::in | std::ios::binary);
-                        if (!fileHandle.good()) {
-                            continue;
-                        }
-                    }
-
-                    size_t offset = fileContents.size();
-                    fileContents.resize(magicWord.size());
-                    fileHandle.read((char *)&fileContents[offset], magicWord.size() - offset);
-                    if (!fileHandle.good()) {
-                        fileContents.resize(offset);
-                        continue;
-                    }
-                }
-
-                if (std::equal(magicWord.begin(), magicWord.end(), fileContents.begin())) {
+                if (isMapped() && fileContents.size() >= magicWord.size() && std::equal(magicWord.begin(), magicWord.end(), fileContents.begin())) {
                     matched = true;
                 }
             }
@@ -177,36 +271,47 @@ Resolve(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string
         return fileType;
     }
 
-    pbxspec::PBX::FileType::shared_ptr fileType = (isFolder ? specManager->fileType("folder", domains) : specManager->fileType("file", domains));
-    return fileType;
+    return (isFolder() ? _folder : _file);
 }
 
 pbxspec::PBX::FileType::shared_ptr FileTypeResolver::
-Resolve(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxproj::PBX::FileReference::shared_ptr const &fileReference, std::string const &filePath)
+resolve(Filesystem const *filesystem, pbxproj::PBX::FileReference::shared_ptr const &fileReference, std::string const &filePath) const
 {
     if (!fileReference->explicitFileType().empty()) {
-        if (pbxspec::PBX::FileType::shared_ptr const &fileType = specManager->fileType(fileReference->explicitFileType(), domains)) {
+        if (pbxspec::PBX::FileType::shared_ptr const &fileType = _specManager->fileType(fileReference->explicitFileType(), _domains)) {
             return fileType;
         }
     }
 
     if (!fileReference->lastKnownFileType().empty()) {
-        if (pbxspec::PBX::FileType::shared_ptr const &fileType = specManager->fileType(fileReference->lastKnownFileType(), domains)) {
+        if (pbxspec::PBX::FileType::shared_ptr const &fileType = _specManager->fileType(fileReference->lastKnownFileType(), _domains)) {
             return fileType;
         }
     }
 
-    return Resolve(specManager, domains, filePath);
+    return resolve(filesystem, filePath);
 }
 
 pbxspec::PBX::FileType::shared_ptr FileTypeResolver::
-Resolve(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxproj::XC::VersionGroup::shared_ptr const &versionGroup, std::string const &filePath)
+resolve(Filesystem const *filesystem, pbxproj::XC::VersionGroup::shared_ptr const &versionGroup, std::string const &filePath) const
 {
     if (!versionGroup->versionGroupType().empty()) {
-        if (pbxspec::PBX::FileType::shared_ptr const &fileType = specManager->fileType(versionGroup->versionGroupType(), domains)) {
+        if (pbxspec::PBX::FileType::shared_ptr const &fileType = _specManager->fileType(versionGroup->versionGroupType(), _domains)) {
             return fileType;
         }
     }
 
-    return Resolve(specManager, domains, filePath);
+    return resolve(filesystem, filePath);
+}
+
+FileTypeResolver::shared_ptr FileTypeResolver::
+Create(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains)
+{
+    ext::optional<std::vector<pbxspec::PBX::FileType::shared_ptr>> sortedFileTypes = SortedFileTypes(specManager->fileTypes(domains));
+    if (!sortedFileTypes) {
+        fprintf(stderr, "error: cycle creating file type graph\n");
+        return nullptr;
+    }
+
+    return FileTypeResolver::shared_ptr(new FileTypeResolver(specManager, domains, *sortedFileTypes));
 }
@@ -12,7 +12,8 @@
 namespace Phase = pbxbuild::Phase;
 
 Phase::Environment::
-Environment(Build::Environment const &buildEnvironment, Build::Context const &buildContext, pbxproj::PBX::Target::shared_ptr const &target, Target::Environment const &targetEnvironment) :
+Environment(libutil::Filesystem const *filesystem, Build::Environment const &buildEnvironment, Build::Context const &buildContext, pbxproj::PBX::Target::shared_ptr const &target, Target::Environment const &targetEnvironment) :
+    _filesystem       (filesystem),
     _buildEnvironment (buildEnvironment),
     _buildContext     (buildContext),
     _target           (target),
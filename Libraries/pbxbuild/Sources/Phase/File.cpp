@@ -51,6 +51,11 @@ ResolveBuildFiles(Phase::Environment const &phaseEnvironment, pbxsetting::Enviro
 
     std::vector<Phase::File> result;
 
+    FileTypeResolver::shared_ptr fileTypeResolver = buildEnvironment.fileTypeResolver({ pbxspec::Manager::AnyDomain() });
+    if (fileTypeResolver == nullptr) {
+        return result;
+    }
+
     for (pbxproj::PBX::BuildFile::shared_ptr const &buildFile : buildFiles) {
         if (buildFile->fileRef() == nullptr) {
             fprintf(stderr, "error: build file is missing file reference\n");
@@ -68,7 +73,7 @@ ResolveBuildFiles(Phase::Environment const &phaseEnvironment, pbxsetting::Enviro
                 pbxproj::PBX::FileReference::shared_ptr const &fileReference = std::static_pointer_cast <pbxproj::PBX::FileReference> (buildFile->fileRef());
 
                 std::string path = environment.expand(fileReference->resolve());
-                pbxspec::PBX::FileType::shared_ptr fileType = FileTypeResolver::Resolve(buildEnvironment.specManager(), { pbxspec::Manager::AnyDomain() }, fileReference, path);
+                pbxspec::PBX::FileType::shared_ptr fileType = fileTypeResolver->resolve(phaseEnvironment.filesystem(), fileReference, path);
 
                 Target::BuildRules::BuildRule::shared_ptr buildRule = buildRules.resolve(fileType, path);
                 Phase::File file = Phase::File(buildFile, buildRule, fileType, path, std::string(), fileNameDisambiguator);
@@ -96,7 +101,7 @@ ResolveBuildFiles(Phase::Environment const &phaseEnvironment, pbxsetting::Enviro
 
                 pbxproj::PBX::FileReference::shared_ptr const &fileReference = remote->second;
                 std::string path = remoteEnvironment->environment().expand(fileReference->resolve());
-                pbxspec::PBX::FileType::shared_ptr fileType = FileTypeResolver::Resolve(buildEnvironment.specManager(), { pbxspec::Manager::AnyDomain() }, fileReference, path);
+                pbxspec::PBX::FileType::shared_ptr fileType = fileTypeResolver->resolve(phaseEnvironment.filesystem(), fileReference, path);
 
                 Target::BuildRules::BuildRule::shared_ptr buildRule = buildRules.resolve(fileType, path);
                 Phase::File file = Phase::File(buildFile, buildRule, fileType, path, std::string(), std::string());
@@ -114,7 +119,7 @@ ResolveBuildFiles(Phase::Environment const &phaseEnvironment, pbxsetting::Enviro
                     std::string const &localization = fileReference->name();
 
                     std::string path = environment.expand(fileReference->resolve());
-                    pbxspec::PBX::FileType::shared_ptr fileType = FileTypeResolver::Resolve(buildEnvironment.specManager(), { pbxspec::Manager::AnyDomain() }, fileReference, path);
+                    pbxspec::PBX::FileType::shared_ptr fileType = fileTypeResolver->resolve(phaseEnvironment.filesystem(), fileReference, path);
 
                     Target::BuildRules::BuildRule::shared_ptr buildRule = buildRules.resolve(fileType, path);
                     Phase::File file = Phase::File(buildFile, buildRule, fileType, path, localization, fileNameDisambiguator);
@@ -126,7 +131,7 @@ ResolveBuildFiles(Phase::Environment const &phaseEnvironment, pbxsetting::Enviro
                 pbxproj::XC::VersionGroup::shared_ptr const &versionGroup = std::static_pointer_cast <pbxproj::XC::VersionGroup> (buildFile->fileRef());
 
                 std::string path = environment.expand(versionGroup->resolve());
-                pbxspec::PBX::FileType::shared_ptr fileType = FileTypeResolver::Resolve(buildEnvironment.specManager(), { pbxspec::Manager::AnyDomain() }, versionGroup, path);
+                pbxspec::PBX::FileType::shared_ptr fileType = fileTypeResolver->resolve(phaseEnvironment.filesystem(), versionGroup, path);
 
                 Target::BuildRules::BuildRule::shared_ptr buildRule = buildRules.resolve(fileType, path);
                 Phase::File file = Phase::File(buildFile, buildRule, fileType, path, std::string(), fileNameDisambiguator);
@@ -39,19 +39,24 @@ Phase::PhaseInvocations::
 Phase::PhaseInvocations Phase::PhaseInvocations::
 Create(Phase::Environment const &phaseEnvironment, pbxproj::PBX::Target::shared_ptr const &target)
 {
+    Build::Context const &buildContext = phaseEnvironment.buildContext();
     Target::Environment const &targetEnvironment = phaseEnvironment.targetEnvironment();
     pbxsetting::Environment const &environment = targetEnvironment.environment();
 
     /* Create the tool context for building. */
     Tool::SearchPaths searchPaths = Tool::SearchPaths::Create(
+        phaseEnvironment.filesystem(),
         targetEnvironment.environment(),
-        targetEnvironment.workingDirectory());
+        targetEnvironment.workingDirectory(),
+        buildContext.searchPathsCache().get());
     Tool::Context toolContext = Tool::Context(
         targetEnvironment.sdk(),
         targetEnvironment.toolchains(),
         targetEnvironment.executablePaths(),
         targetEnvironment.workingDirectory(),
-        searchPaths);
+        searchPaths,
+        phaseEnvironment.filesystem(),
+        buildContext.searchPathsCache());
 
     Phase::Context phaseContext(toolContext);
 
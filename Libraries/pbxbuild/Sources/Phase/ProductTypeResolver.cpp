@@ -17,11 +17,15 @@
 #include <pbxbuild/Tool/TouchResolver.h>
 #include <pbxbuild/Tool/ToolResolver.h>
 #include <libutil/FSUtil.h>
+#include <libutil/Path.h>
+
+#include <unordered_map>
 
 namespace Target = pbxbuild::Target;
 namespace Phase = pbxbuild::Phase;
 namespace Tool = pbxbuild::Tool;
 using libutil::FSUtil;
+using libutil::Path;
 
 Phase::ProductTypeResolver::
 ProductTypeResolver(pbxspec::PBX::ProductType::shared_ptr const &productType) :
@@ -34,28 +38,27 @@ Phase::ProductTypeResolver::
 {
 }
 
-static bool
-StartsWith(std::string const &str, std::string const &prefix)
-{
-    if (prefix.size() > str.size()) {
-        return false;
-    }
-
-    return std::equal(prefix.begin(), prefix.end(), str.begin());
-}
-
 static std::unordered_set<std::string>
 DirectoriesContainingOutputs(std::vector<Tool::Invocation> const &invocations, std::unordered_set<std::string> const &directories)
 {
     std::unordered_set<std::string> populatedDirectories;
 
-    // TODO(grp): This could use a trie. Almost like an interview question!
+    std::unordered_map<Path, std::vector<std::string>> candidates;
+    for (std::string const &directory : directories) {
+        candidates[Path(directory)].push_back(directory);
+    }
+
+    /*
+     * Each output's containing directories are interned along with it, so
+     * walking up from the output finds every candidate it's inside.
+     */
     for (Tool::Invocation const &invocation : invocations) {
         for (std::string const &output : invocation.outputs()) {
-            for (std::string const &directory : directories) {
-                if (StartsWith(output, directory + "/")) {
+            for (Path directory = Path(output).parent(); !directory.empty(); directory = directory.parent()) {
+                auto it = candidates.find(directory);
+                if (it != candidates.end()) {
                     /* Found an output in this directory. */
-                    populatedDirectories.insert(directory);
+                    populatedDirectories.insert(it->second.begin(), it->second.end());
                 }
             }
         }
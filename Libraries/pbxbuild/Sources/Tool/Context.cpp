@@ -17,12 +17,16 @@ Context(
     xcsdk::SDK::Toolchain::vector const &toolchains,
     std::vector<std::string> const &executablePaths,
     std::string const &workingDirectory,
-    Tool::SearchPaths const &searchPaths) :
+    Tool::SearchPaths const &searchPaths,
+    libutil::Filesystem const *filesystem,
+    std::shared_ptr<Tool::SearchPaths::Cache> const &searchPathsCache) :
     _sdk             (sdk),
     _toolchains      (toolchains),
     _executablePaths (executablePaths),
     _workingDirectory(workingDirectory),
-    _searchPaths     (searchPaths)
+    _searchPaths     (searchPaths),
+    _filesystem      (filesystem),
+    _searchPathsCache(searchPathsCache)
 {
 }
 
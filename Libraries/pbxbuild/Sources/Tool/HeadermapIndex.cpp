@@ -0,0 +1,195 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <pbxbuild/Tool/HeadermapIndex.h>
+#include <pbxbuild/HeaderMap.h>
+#include <libutil/FSUtil.h>
+
+namespace Tool = pbxbuild::Tool;
+using pbxbuild::HeaderMap;
+using pbxbuild::FileTypeResolver;
+using libutil::FSUtil;
+
+Tool::HeadermapIndex::Header::
+Header(std::string const &name, std::string const &directory) :
+    _name     (name),
+    _directory(directory)
+{
+}
+
+Tool::HeadermapIndex::TargetHeader::
+TargetHeader(pbxproj::PBX::Target::shared_ptr const &target, Header const &header, std::string const &frameworkName, bool isPublic, bool isPrivate, bool isNonFramework) :
+    _target        (target),
+    _header        (header),
+    _frameworkName (frameworkName),
+    _isPublic      (isPublic),
+    _isPrivate     (isPrivate),
+    _isNonFramework(isNonFramework)
+{
+}
+
+Tool::HeadermapIndex::
+HeadermapIndex(std::vector<Header> const &projectHeaders, std::vector<TargetHeader> const &targetHeaders) :
+    _projectHeaders(projectHeaders),
+    _targetHeaders (targetHeaders)
+{
+    HeaderMap projectHeadermap;
+    for (Header const &header : _projectHeaders) {
+        projectHeadermap.add(header.name(), header.directory(), header.name());
+    }
+    _projectHeadermap = projectHeadermap.write();
+
+    HeaderMap allTargetHeadermap;
+    HeaderMap allNonFrameworkTargetHeadermap;
+    for (TargetHeader const &targetHeader : _targetHeaders) {
+        if (targetHeader.isPublic() || targetHeader.isPrivate()) {
+            Header const &header = targetHeader.header();
+            allTargetHeadermap.add(targetHeader.frameworkName(), header.directory(), header.name());
+            if (targetHeader.isNonFramework()) {
+                allNonFrameworkTargetHeadermap.add(targetHeader.frameworkName(), header.directory(), header.name());
+            }
+        }
+    }
+    _allTargetHeadermap = allTargetHeadermap.write();
+    _allNonFrameworkTargetHeadermap = allNonFrameworkTargetHeadermap.write();
+}
+
+Tool::HeadermapIndex::
+~HeadermapIndex()
+{
+}
+
+static bool
+IsHeaderFileType(pbxspec::PBX::FileType::shared_ptr const &fileType)
+{
+    return (fileType != nullptr && (fileType->identifier() == "sourcecode.c.h" || fileType->identifier() == "sourcecode.cpp.h"));
+}
+
+Tool::HeadermapIndex::shared_ptr Tool::HeadermapIndex::
+Create(libutil::Filesystem const *filesystem, FileTypeResolver const &fileTypeResolver, pbxproj::PBX::Project::shared_ptr const &project, pbxsetting::Environment const &environment)
+{
+    std::vector<Header> projectHeaders;
+    std::vector<TargetHeader> targetHeaders;
+
+    for (pbxproj::PBX::FileReference::shared_ptr const &fileReference : project->fileReferences()) {
+        std::string filePath = environment.expand(fileReference->resolve());
+        if (!IsHeaderFileType(fileTypeResolver.resolve(filesystem, fileReference, filePath))) {
+            continue;
+        }
+
+        projectHeaders.push_back(Header(FSUtil::GetBaseName(filePath), FSUtil::GetDirectoryName(filePath) + "/"));
+    }
+
+    for (pbxproj::PBX::Target::shared_ptr const &target : project->targets()) {
+        // TODO(grp): This is a little messy. Maybe check the product type specification, or the product reference's file type?
+        bool isNonFramework = (target->type() == pbxproj::PBX::Target::kTypeNative && std::static_pointer_cast<pbxproj::PBX::NativeTarget>(target)->productType().find("framework") == std::string::npos);
+
+        for (pbxproj::PBX::BuildPhase::shared_ptr const &buildPhase : target->buildPhases()) {
+            if (buildPhase->type() != pbxproj::PBX::BuildPhase::kTypeHeaders) {
+                continue;
+            }
+
+            for (pbxproj::PBX::BuildFile::shared_ptr const &buildFile : buildPhase->files()) {
+                if (buildFile->fileRef() == nullptr || buildFile->fileRef()->type() != pbxproj::PBX::GroupItem::kTypeFileReference) {
+                    continue;
+                }
+
+                pbxproj::PBX::FileReference::shared_ptr const &fileReference = std::static_pointer_cast <pbxproj::PBX::FileReference> (buildFile->fileRef());
+                std::string filePath = environment.expand(fileReference->resolve());
+                if (!IsHeaderFileType(fileTypeResolver.resolve(filesystem, fileReference, filePath))) {
+                    continue;
+                }
+
+                Header header = Header(FSUtil::GetBaseName(filePath), FSUtil::GetDirectoryName(filePath) + "/");
+                std::string frameworkName = target->productName() + "/" + header.name();
+
+                std::vector<std::string> const &attributes = buildFile->attributes();
+                bool isPublic  = std::find(attributes.begin(), attributes.end(), "Public") != attributes.end();
+                bool isPrivate = std::find(attributes.begin(), attributes.end(), "Private") != attributes.end();
+
+                targetHeaders.push_back(TargetHeader(target, header, frameworkName, isPublic, isPrivate, isNonFramework));
+            }
+        }
+    }
+
+    return std::make_shared<HeadermapIndex>(projectHeaders, targetHeaders);
+}
+
+Tool::HeadermapIndex::Cache::
+Cache()
+{
+}
+
+Tool::HeadermapIndex::Cache::
+~Cache()
+{
+}
+
+static void
+AddSourceTrees(pbxsetting::Value const &value, std::unordered_set<std::string> *seen, std::vector<pbxsetting::Value> *sourceTrees)
+{
+    for (pbxsetting::Value::Entry const &entry : value.entries()) {
+        if (entry.type == pbxsetting::Value::Entry::Value) {
+            pbxsetting::Value sourceTree = pbxsetting::Value({ entry });
+            if (seen->insert(sourceTree.raw()).second) {
+                sourceTrees->push_back(sourceTree);
+            }
+        }
+    }
+}
+
+Tool::HeadermapIndex::shared_ptr Tool::HeadermapIndex::Cache::
+index(libutil::Filesystem const *filesystem, FileTypeResolver const &fileTypeResolver, pbxproj::PBX::Project::shared_ptr const &project, pbxsetting::Environment const &environment)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto PI = _projects.find(project);
+    if (PI == _projects.end()) {
+        /*
+         * Find the settings that file references in the project are relative
+         * to. Only those settings can change the paths in the index.
+         */
+        std::unordered_set<std::string> seen;
+        std::vector<pbxsetting::Value> sourceTrees;
+
+        for (pbxproj::PBX::FileReference::shared_ptr const &fileReference : project->fileReferences()) {
+            AddSourceTrees(fileReference->resolve(), &seen, &sourceTrees);
+        }
+
+        for (pbxproj::PBX::Target::shared_ptr const &target : project->targets()) {
+            for (pbxproj::PBX::BuildPhase::shared_ptr const &buildPhase : target->buildPhases()) {
+                if (buildPhase->type() != pbxproj::PBX::BuildPhase::kTypeHeaders) {
+                    continue;
+                }
+
+                for (pbxproj::PBX::BuildFile::shared_ptr const &buildFile : buildPhase->files()) {
+                    if (buildFile->fileRef() != nullptr) {
+                        AddSourceTrees(buildFile->fileRef()->resolve(), &seen, &sourceTrees);
+                    }
+                }
+            }
+        }
+
+        PI = _projects.insert({ project, Project{ sourceTrees, { } } }).first;
+    }
+
+    std::vector<std::string> key;
+    for (pbxsetting::Value const &sourceTree : PI->second.sourceTrees) {
+        key.push_back(environment.expand(sourceTree));
+    }
+
+    auto II = PI->second.indexes.find(key);
+    if (II != PI->second.indexes.end()) {
+        return II->second;
+    }
+
+    HeadermapIndex::shared_ptr index = HeadermapIndex::Create(filesystem, fileTypeResolver, project, environment);
+    PI->second.indexes.insert({ key, index });
+    return index;
+}
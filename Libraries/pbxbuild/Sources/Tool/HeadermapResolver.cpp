@@ -9,6 +9,7 @@
 
 #include <pbxbuild/Tool/HeadermapResolver.h>
 #include <pbxbuild/Tool/HeadermapInfo.h>
+#include <pbxbuild/Tool/HeadermapIndex.h>
 #include <pbxbuild/Tool/SearchPaths.h>
 #include <pbxbuild/Tool/Context.h>
 #include <pbxbuild/FileTypeResolver.h>
@@ -22,15 +23,17 @@ using pbxbuild::FileTypeResolver;
 using libutil::FSUtil;
 
 Tool::HeadermapResolver::
-HeadermapResolver(pbxspec::PBX::Tool::shared_ptr const &tool, pbxspec::PBX::Compiler::shared_ptr const &compiler, pbxspec::Manager::shared_ptr const &specManager) :
-    _tool       (tool),
-    _compiler   (compiler),
-    _specManager(specManager)
+HeadermapResolver(libutil::Filesystem const *filesystem, pbxspec::PBX::Tool::shared_ptr const &tool, pbxspec::PBX::Compiler::shared_ptr const &compiler, FileTypeResolver::shared_ptr const &fileTypeResolver, std::shared_ptr<Tool::HeadermapIndex::Cache> const &headermapIndexes) :
+    _filesystem      (filesystem),
+    _tool            (tool),
+    _compiler        (compiler),
+    _fileTypeResolver(fileTypeResolver),
+    _headermapIndexes(headermapIndexes)
 {
 }
 
 static std::vector<std::string>
-HeadermapSearchPaths(pbxspec::Manager::shared_ptr const &specManager, pbxsetting::Environment const &environment, pbxproj::PBX::Target::shared_ptr const &target, Tool::SearchPaths const &searchPaths, std::string const &workingDirectory)
+HeadermapSearchPaths(pbxsetting::Environment const &environment, pbxproj::PBX::Target::shared_ptr const &target, Tool::SearchPaths const &searchPaths, std::string const &workingDirectory)
 {
     std::unordered_set<std::string> allHeaderSearchPaths;
     std::vector<std::string> orderedHeaderSearchPaths;
@@ -90,9 +93,6 @@ resolve(
 
     HeaderMap targetName;
     HeaderMap ownTargetHeaders;
-    HeaderMap projectHeaders;
-    HeaderMap allTargetHeaders;
-    HeaderMap allNonFrameworkTargetHeaders;
 
     bool includeFlatEntriesForTargetBeingBuilt     = pbxsetting::Type::ParseBoolean(compilerEnvironment.resolve("HEADERMAP_INCLUDES_FLAT_ENTRIES_FOR_TARGET_BEING_BUILT"));
     bool includeFrameworkEntriesForAllProductTypes = pbxsetting::Type::ParseBoolean(compilerEnvironment.resolve("HEADERMAP_INCLUDES_FRAMEWORK_ENTRIES_FOR_ALL_PRODUCT_TYPES"));
@@ -101,9 +101,7 @@ resolve(
     // TODO(grp): Populate generated headers.
     HeaderMap generatedFiles;
 
-    pbxproj::PBX::Project::shared_ptr project = target->project();
-
-    std::vector<std::string> headermapSearchPaths = HeadermapSearchPaths(_specManager, compilerEnvironment, target, toolContext->searchPaths(), toolContext->workingDirectory());
+    std::vector<std::string> headermapSearchPaths = HeadermapSearchPaths(compilerEnvironment, target, toolContext->searchPaths(), toolContext->workingDirectory());
     for (std::string const &path : headermapSearchPaths) {
         FSUtil::EnumerateDirectory(path, [&](std::string const &fileName) -> bool {
             // TODO(grp): Use FileTypeResolver when reliable.
@@ -117,73 +115,40 @@ resolve(
         });
     }
 
-    for (pbxproj::PBX::FileReference::shared_ptr const &fileReference : project->fileReferences()) {
-        std::string filePath = compilerEnvironment.expand(fileReference->resolve());
-        pbxspec::PBX::FileType::shared_ptr fileType = FileTypeResolver::Resolve(_specManager, { pbxspec::Manager::AnyDomain() }, fileReference, filePath);
-        if (fileType == nullptr || (fileType->identifier() != "sourcecode.c.h" && fileType->identifier() != "sourcecode.cpp.h")) {
-            continue;
-        }
+    /*
+     * The project's headers are indexed once and shared between its targets.
+     */
+    Tool::HeadermapIndex::shared_ptr index = _headermapIndexes->index(_filesystem, *_fileTypeResolver, target->project(), compilerEnvironment);
 
-        std::string fileName = FSUtil::GetBaseName(filePath);
-        std::string fileDirectory = FSUtil::GetDirectoryName(filePath) + "/";
-
-        projectHeaders.add(fileName, fileDirectory, fileName);
-        if (includeProjectHeaders) {
-            targetName.add(fileName, fileDirectory, fileName);
+    if (includeProjectHeaders) {
+        for (Tool::HeadermapIndex::Header const &header : index->projectHeaders()) {
+            targetName.add(header.name(), header.directory(), header.name());
         }
     }
 
-    for (pbxproj::PBX::Target::shared_ptr const &projectTarget : project->targets()) {
-       for (pbxproj::PBX::BuildPhase::shared_ptr const &buildPhase : projectTarget->buildPhases()) {
-            if (buildPhase->type() != pbxproj::PBX::BuildPhase::kTypeHeaders) {
-                continue;
-            }
+    for (Tool::HeadermapIndex::TargetHeader const &targetHeader : index->targetHeaders()) {
+        Tool::HeadermapIndex::Header const &header = targetHeader.header();
+        bool isPublic  = targetHeader.isPublic();
+        bool isPrivate = targetHeader.isPrivate();
 
-            for (pbxproj::PBX::BuildFile::shared_ptr const &buildFile : buildPhase->files()) {
-                if (buildFile->fileRef() == nullptr || buildFile->fileRef()->type() != pbxproj::PBX::GroupItem::kTypeFileReference) {
-                    continue;
-                }
+        if (targetHeader.target() == target) {
+            ownTargetHeaders.add(header.name(), header.directory(), header.name());
 
-                pbxproj::PBX::FileReference::shared_ptr const &fileReference = std::static_pointer_cast <pbxproj::PBX::FileReference> (buildFile->fileRef());
-                std::string filePath = compilerEnvironment.expand(fileReference->resolve());
-                pbxspec::PBX::FileType::shared_ptr fileType = FileTypeResolver::Resolve(_specManager, { pbxspec::Manager::AnyDomain() }, fileReference, filePath);
-                if (fileType == nullptr || (fileType->identifier() != "sourcecode.c.h" && fileType->identifier() != "sourcecode.cpp.h")) {
-                    continue;
+            if (!isPublic && !isPrivate) {
+                ownTargetHeaders.add(targetHeader.frameworkName(), header.directory(), header.name());
+                if (includeFlatEntriesForTargetBeingBuilt) {
+                    targetName.add(targetHeader.frameworkName(), header.directory(), header.name());
                 }
+            }
+        }
 
-                std::string fileName = FSUtil::GetBaseName(filePath);
-                std::string fileDirectory = FSUtil::GetDirectoryName(filePath) + "/";
-                std::string frameworkName = projectTarget->productName() + "/" + fileName;
-
-                std::vector<std::string> const &attributes = buildFile->attributes();
-                bool isPublic  = std::find(attributes.begin(), attributes.end(), "Public") != attributes.end();
-                bool isPrivate = std::find(attributes.begin(), attributes.end(), "Private") != attributes.end();
-
-                if (projectTarget == target) {
-                    ownTargetHeaders.add(fileName, fileDirectory, fileName);
-
-                    if (!isPublic && !isPrivate) {
-                        ownTargetHeaders.add(frameworkName, fileDirectory, fileName);
-                        if (includeFlatEntriesForTargetBeingBuilt) {
-                            targetName.add(frameworkName, fileDirectory, fileName);
-                        }
-                    }
-                }
+        if (isPublic || isPrivate) {
+            if (includeFrameworkEntriesForAllProductTypes) {
+                targetName.add(targetHeader.frameworkName(), header.directory(), header.name());
+            }
 
-                if (isPublic || isPrivate) {
-                    allTargetHeaders.add(frameworkName, fileDirectory, fileName);
-                    if (includeFrameworkEntriesForAllProductTypes) {
-                        targetName.add(frameworkName, fileDirectory, fileName);
-                    }
-
-                    // TODO(grp): This is a little messy. Maybe check the product type specification, or the product reference's file type?
-                    if (projectTarget->type() == pbxproj::PBX::Target::kTypeNative && std::static_pointer_cast<pbxproj::PBX::NativeTarget>(projectTarget)->productType().find("framework") == std::string::npos) {
-                        allNonFrameworkTargetHeaders.add(frameworkName, fileDirectory, fileName);
-                        if (!includeFrameworkEntriesForAllProductTypes) {
-                            targetName.add(frameworkName, fileDirectory, fileName);
-                        }
-                    }
-                }
+            if (targetHeader.isNonFramework() && !includeFrameworkEntriesForAllProductTypes) {
+                targetName.add(targetHeader.frameworkName(), header.directory(), header.name());
             }
         }
     }
@@ -198,10 +163,10 @@ resolve(
     std::vector<AuxiliaryFile> auxiliaryFiles = {
         AuxiliaryFile(headermapFile, targetName.write(), false),
         AuxiliaryFile(headermapFileForOwnTargetHeaders, ownTargetHeaders.write(), false),
-        AuxiliaryFile(headermapFileForAllTargetHeaders, allTargetHeaders.write(), false),
-        AuxiliaryFile(headermapFileForAllNonFrameworkTargetHeaders, allNonFrameworkTargetHeaders.write(), false),
+        AuxiliaryFile(headermapFileForAllTargetHeaders, index->allTargetHeadermap(), false),
+        AuxiliaryFile(headermapFileForAllNonFrameworkTargetHeaders, index->allNonFrameworkTargetHeadermap(), false),
         AuxiliaryFile(headermapFileForGeneratedFiles, generatedFiles.write(), false),
-        AuxiliaryFile(headermapFileForProjectFiles, projectHeaders.write(), false),
+        AuxiliaryFile(headermapFileForProjectFiles, index->projectHeadermap(), false),
     };
 
     Tool::Invocation invocation;
@@ -239,6 +204,7 @@ std::unique_ptr<Tool::HeadermapResolver> Tool::HeadermapResolver::
 Create(Phase::Environment const &phaseEnvironment, pbxspec::PBX::Compiler::shared_ptr const &compiler)
 {
     Build::Environment const &buildEnvironment = phaseEnvironment.buildEnvironment();
+    Build::Context const &buildContext = phaseEnvironment.buildContext();
     Target::Environment const &targetEnvironment = phaseEnvironment.targetEnvironment();
 
     pbxspec::PBX::Tool::shared_ptr headermapTool = buildEnvironment.specManager()->tool(Tool::HeadermapResolver::ToolIdentifier(), targetEnvironment.specDomains());
@@ -247,5 +213,10 @@ Create(Phase::Environment const &phaseEnvironment, pbxspec::PBX::Compiler::share
         return nullptr;
     }
 
-    return std::unique_ptr<Tool::HeadermapResolver>(new Tool::HeadermapResolver(headermapTool, compiler, buildEnvironment.specManager()));
+    FileTypeResolver::shared_ptr fileTypeResolver = buildEnvironment.fileTypeResolver({ pbxspec::Manager::AnyDomain() });
+    if (fileTypeResolver == nullptr) {
+        return nullptr;
+    }
+
+    return std::unique_ptr<Tool::HeadermapResolver>(new Tool::HeadermapResolver(phaseEnvironment.filesystem(), headermapTool, compiler, fileTypeResolver, buildContext.headermapIndexes()));
 }
@@ -10,6 +10,7 @@
 #include <pbxbuild/Tool/OptionsResult.h>
 #include <pbxbuild/Tool/SearchPaths.h>
 #include <pbxbuild/Tool/Environment.h>
+#include <pbxbuild/Tool/Context.h>
 
 namespace Tool = pbxbuild::Tool;
 
@@ -75,13 +76,13 @@ AddOptionArgumentValue(std::vector<std::string> *arguments, pbxsetting::Environm
 }
 
 static void
-AddOptionArgumentValues(std::vector<std::string> *arguments, pbxsetting::Environment const &environment, std::string const &workingDirectory, std::vector<pbxsetting::Value> const &args, pbxspec::PBX::PropertyOption::shared_ptr const &option)
+AddOptionArgumentValues(std::vector<std::string> *arguments, pbxsetting::Environment const &environment, std::string const &workingDirectory, libutil::Filesystem const *filesystem, Tool::SearchPaths::Cache *searchPathsCache, std::vector<pbxsetting::Value> const &args, pbxspec::PBX::PropertyOption::shared_ptr const &option)
 {
     if ((option->type() == "StringList" || option->type() == "stringlist") ||
         (option->type() == "PathList" || option->type() == "pathlist")) {
         std::vector<std::string> values = pbxsetting::Type::ParseList(environment.resolve(option->name()));
         if (option->flattenRecursiveSearchPathsInValue()) {
-            values = Tool::SearchPaths::ExpandRecursive(values, environment, workingDirectory);
+            values = Tool::SearchPaths::ExpandRecursive(filesystem, values, environment, workingDirectory, searchPathsCache);
         }
 
         for (std::string const &value : values) {
@@ -106,7 +107,7 @@ ArgumentValuesFromArray(plist::Array const *args)
 }
 
 static void
-AddOptionValuesArguments(std::vector<std::string> *arguments, pbxsetting::Environment const &environment, std::string const &workingDirectory, plist::Array const *values, std::string const &value, pbxspec::PBX::PropertyOption::shared_ptr const &option)
+AddOptionValuesArguments(std::vector<std::string> *arguments, pbxsetting::Environment const &environment, std::string const &workingDirectory, libutil::Filesystem const *filesystem, Tool::SearchPaths::Cache *searchPathsCache, plist::Array const *values, std::string const &value, pbxspec::PBX::PropertyOption::shared_ptr const &option)
 {
     if (values == nullptr) {
         return;
@@ -123,10 +124,10 @@ AddOptionValuesArguments(std::vector<std::string> *arguments, pbxsetting::Enviro
                 if (entryValue->value() == value) {
                     if (auto entryFlag = entry->value <plist::String> ("CommandLineFlag")) {
                         std::vector<pbxsetting::Value> argsValues = { pbxsetting::Value::Parse(entryFlag->value()) };
-                        AddOptionArgumentValues(arguments, environment, workingDirectory, argsValues, option);
+                        AddOptionArgumentValues(arguments, environment, workingDirectory, filesystem, searchPathsCache, argsValues, option);
                     } else if (auto entryArgs = entry->value <plist::Array> ("CommandLineArgs")) {
                         std::vector<pbxsetting::Value> argsValues = ArgumentValuesFromArray(entryArgs);
-                        AddOptionArgumentValues(arguments, environment, workingDirectory, argsValues, option);
+                        AddOptionArgumentValues(arguments, environment, workingDirectory, filesystem, searchPathsCache, argsValues, option);
                     }
                 }
             }
@@ -135,7 +136,7 @@ AddOptionValuesArguments(std::vector<std::string> *arguments, pbxsetting::Enviro
 }
 
 static void
-AddOptionArgsArguments(std::vector<std::string> *arguments, pbxsetting::Environment const &environment, std::string const &workingDirectory, plist::Object const *argsValue, std::string const &value, pbxspec::PBX::PropertyOption::shared_ptr const &option)
+AddOptionArgsArguments(std::vector<std::string> *arguments, pbxsetting::Environment const &environment, std::string const &workingDirectory, libutil::Filesystem const *filesystem, Tool::SearchPaths::Cache *searchPathsCache, plist::Object const *argsValue, std::string const &value, pbxspec::PBX::PropertyOption::shared_ptr const &option)
 {
     /*
      * `CommandLineArgs` and `AdditionalLinkerArgs` are either arrays of arguments or dictionaries
@@ -144,25 +145,27 @@ AddOptionArgsArguments(std::vector<std::string> *arguments, pbxsetting::Environm
 
     if (auto args = plist::CastTo <plist::Array> (argsValue)) {
         std::vector<pbxsetting::Value> argsValues = ArgumentValuesFromArray(args);
-        AddOptionArgumentValues(arguments, environment, workingDirectory, argsValues, option);
+        AddOptionArgumentValues(arguments, environment, workingDirectory, filesystem, searchPathsCache, argsValues, option);
     } else if (auto argsValues = plist::CastTo <plist::Dictionary> (argsValue)) {
         if (auto args = argsValues->value <plist::Array> (value)) {
             std::vector<pbxsetting::Value> argsValues = ArgumentValuesFromArray(args);
-            AddOptionArgumentValues(arguments, environment, workingDirectory, argsValues, option);
+            AddOptionArgumentValues(arguments, environment, workingDirectory, filesystem, searchPathsCache, argsValues, option);
         } else if (auto args = argsValues->value <plist::Array> ("<<otherwise>>")) {
             std::vector<pbxsetting::Value> argsValues = ArgumentValuesFromArray(args);
-            AddOptionArgumentValues(arguments, environment, workingDirectory, argsValues, option);
+            AddOptionArgumentValues(arguments, environment, workingDirectory, filesystem, searchPathsCache, argsValues, option);
         }
     }
 }
 
 Tool::OptionsResult Tool::OptionsResult::
 Create(
+    libutil::Filesystem const *filesystem,
     pbxsetting::Environment const &environment,
     std::string const &workingDirectory,
     std::vector<pbxspec::PBX::PropertyOption::shared_ptr> const &options,
     pbxspec::PBX::FileType::shared_ptr const &fileType,
-    std::unordered_set<std::string> const &deletedSettings)
+    std::unordered_set<std::string> const &deletedSettings,
+    Tool::SearchPaths::Cache *searchPathsCache)
 {
     std::vector<std::string> arguments;
     std::unordered_map<std::string, std::string> environmentVariables;
@@ -208,25 +211,25 @@ Create(
 
                     /* Pass both the command line flag and the option value itself. */
                     std::vector<pbxsetting::Value> values = { flag, pbxsetting::Value::Variable("value") };
-                    AddOptionArgumentValues(&arguments, environment, workingDirectory, values, option);
+                    AddOptionArgumentValues(&arguments, environment, workingDirectory, filesystem, searchPathsCache, values, option);
                 }
             }
         }
 
-        AddOptionValuesArguments(&arguments, environment, workingDirectory, plist::CastTo<plist::Array>(option->values()), value, option);
-        AddOptionValuesArguments(&arguments, environment, workingDirectory, plist::CastTo<plist::Array>(option->allowedValues()), value, option);
+        AddOptionValuesArguments(&arguments, environment, workingDirectory, filesystem, searchPathsCache, plist::CastTo<plist::Array>(option->values()), value, option);
+        AddOptionValuesArguments(&arguments, environment, workingDirectory, filesystem, searchPathsCache, plist::CastTo<plist::Array>(option->allowedValues()), value, option);
 
         if (!value.empty()) {
             /* Pass the prefix then the option value in the same argument. */
             if (option->commandLinePrefixFlag()) {
                 pbxsetting::Value const &prefix = *option->commandLinePrefixFlag();
                 pbxsetting::Value prefixValue = prefix + pbxsetting::Value::Variable("value");
-                AddOptionArgumentValues(&arguments, environment, workingDirectory, { prefixValue }, option);
+                AddOptionArgumentValues(&arguments, environment, workingDirectory, filesystem, searchPathsCache, { prefixValue }, option);
             }
         }
 
-        AddOptionArgsArguments(&arguments, environment, workingDirectory, option->commandLineArgs(), value, option);
-        AddOptionArgsArguments(&linkerArgs, environment, workingDirectory, option->additionalLinkerArgs(), value, option);
+        AddOptionArgsArguments(&arguments, environment, workingDirectory, filesystem, searchPathsCache, option->commandLineArgs(), value, option);
+        AddOptionArgsArguments(&linkerArgs, environment, workingDirectory, filesystem, searchPathsCache, option->additionalLinkerArgs(), value, option);
 
         if (option->setValueInEnvironmentVariable()) {
             std::string const &variable = environment.expand(*option->setValueInEnvironmentVariable());
@@ -245,13 +248,15 @@ Create(
 Tool::OptionsResult Tool::OptionsResult::
 Create(
     Tool::Environment const &toolEnvironment,
-    std::string const &workingDirectory,
+    Tool::Context const *toolContext,
     pbxspec::PBX::FileType::shared_ptr const &fileType)
 {
     return Create(
+        toolContext->filesystem(),
         toolEnvironment.environment(),
-        workingDirectory,
+        toolContext->workingDirectory(),
         toolEnvironment.tool()->options().value_or(pbxspec::PBX::PropertyOption::vector()),
         fileType,
-        toolEnvironment.tool()->deletedProperties().value_or(std::unordered_set<std::string>()));
+        toolEnvironment.tool()->deletedProperties().value_or(std::unordered_set<std::string>()),
+        toolContext->searchPathsCache().get());
 }
@@ -10,13 +10,12 @@
 #include <pbxbuild/Tool/PrecompiledHeaderInfo.h>
 #include <libutil/FSUtil.h>
 #include <libutil/Wildcard.h>
-#include <libutil/md5.h>
+#include <libutil/Hash.h>
 
-#include <sstream>
-#include <iomanip>
 
 namespace Tool = pbxbuild::Tool;
 using libutil::FSUtil;
+using libutil::Hash;
 using libutil::Wildcard;
 
 Tool::PrecompiledHeaderInfo::
@@ -58,18 +57,7 @@ hash() const
     // TODO(grp): Generate this hash properly.
     std::string content = serialize();
 
-    md5_state_t state;
-    md5_init(&state);
-    md5_append(&state, reinterpret_cast<const md5_byte_t *>(content.data()), content.size());
-    uint8_t digest[16];
-    md5_finish(&state, reinterpret_cast<md5_byte_t *>(&digest));
-
-    std::ostringstream ss;
-    ss << std::hex << std::setfill('0');
-    for (uint8_t c : digest) {
-        ss << std::setw(2) << static_cast<int>(c);
-    }
-    return ss.str();
+    return Hash::Hex(content);
 }
 
 std::string Tool::PrecompiledHeaderInfo::
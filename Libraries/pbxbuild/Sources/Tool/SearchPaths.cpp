@@ -9,9 +9,14 @@
 
 #include <pbxbuild/Tool/SearchPaths.h>
 #include <pbxbuild/Tool/Context.h>
+#include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
 
+#include <set>
+#include <unordered_map>
+
 namespace Tool = pbxbuild::Tool;
+using libutil::Filesystem;
 using libutil::FSUtil;
 
 Tool::SearchPaths::
@@ -27,8 +32,135 @@ SearchPaths(
 {
 }
 
+Tool::SearchPaths::Cache::
+Cache()
+{
+}
+
+Tool::SearchPaths::Cache::
+~Cache()
+{
+}
+
+/*
+ * Appends the subdirectories of a directory, then recurses into each.
+ */
+static void
+AppendSubdirectories(std::vector<std::string> *result, std::unordered_map<std::string, std::vector<std::string>> const &subdirectories, std::string const &relative)
+{
+    auto it = subdirectories.find(relative);
+    if (it == subdirectories.end()) {
+        return;
+    }
+
+    result->insert(result->end(), it->second.begin(), it->second.end());
+    for (std::string const &subdirectory : it->second) {
+        AppendSubdirectories(result, subdirectories, subdirectory);
+    }
+}
+
+Tool::SearchPaths::Cache::Entry Tool::SearchPaths::Cache::
+Walk(Filesystem const *filesystem, std::string const &path, bool recursive)
+{
+    Entry result;
+    result.exists = filesystem->isDirectory(path);
+
+    if (!recursive || !result.exists) {
+        return result;
+    }
+
+    /*
+     * Symbolic links to directories are listed but not followed, like the
+     * enumeration itself. Each directory's subdirectories are collected first
+     * so the result is in the same order however the enumeration goes.
+     */
+    std::unordered_map<std::string, std::vector<std::string>> subdirectories;
+
+    filesystem->enumerateRecursive(path, [&](std::string const &full) -> bool {
+        Filesystem::Status status = filesystem->status(full);
+        if (status.isDirectory) {
+            std::string relative = full.substr(path.size() + 1);
+            std::string::size_type slash = relative.rfind('/');
+            std::string parent = (slash == std::string::npos ? std::string() : relative.substr(0, slash));
+            subdirectories[parent].push_back(relative);
+        }
+        return true;
+    });
+
+    AppendSubdirectories(&result.directories, subdirectories, std::string());
+    return result;
+}
+
+Tool::SearchPaths::Cache::Entry Tool::SearchPaths::Cache::
+entry(Filesystem const *filesystem, std::string const &path, bool recursive)
+{
+    std::pair<std::string, bool> key = { path, recursive };
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(key);
+        if (it != _entries.end()) {
+            return it->second;
+        }
+    }
+
+    /* Walk outside the lock so other paths can be looked up meanwhile. */
+    Entry entry = Walk(filesystem, path, recursive);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.insert({ key, entry }).first->second;
+}
+
+bool Tool::SearchPaths::Cache::
+isDirectory(Filesystem const *filesystem, std::string const &path)
+{
+    return entry(filesystem, path, false).exists;
+}
+
+std::vector<std::string> Tool::SearchPaths::Cache::
+subdirectories(Filesystem const *filesystem, std::string const &path)
+{
+    return entry(filesystem, path, true).directories;
+}
+
+void Tool::SearchPaths::Cache::
+invalidate(std::vector<std::string> const &paths)
+{
+    std::set<std::string> changed = std::set<std::string>(paths.begin(), paths.end());
+    if (changed.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        /* Recursive roots can keep a trailing slash. */
+        std::string path = it->first.first;
+        while (path.size() > 1 && path.back() == '/') {
+            path.pop_back();
+        }
+
+        /* A changed path at or inside of the entry. */
+        std::string prefix = path + "/";
+        auto inside = changed.lower_bound(prefix);
+        bool modified = (changed.find(path) != changed.end() ||
+            (inside != changed.end() && inside->compare(0, prefix.size(), prefix) == 0));
+
+        /* A changed path containing the entry, such as a copied directory. */
+        for (std::string::size_type slash = path.rfind('/'); !modified && slash != std::string::npos && slash > 0; slash = path.rfind('/', slash - 1)) {
+            modified = (changed.find(path.substr(0, slash)) != changed.end());
+        }
+
+        if (modified) {
+            it = _entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 static void
-AppendPaths(std::vector<std::string> *args, pbxsetting::Environment const &environment, std::string const &workingDirectory, std::vector<std::string> const &paths)
+AppendPaths(std::vector<std::string> *args, Filesystem const *filesystem, pbxsetting::Environment const &environment, std::string const &workingDirectory, Tool::SearchPaths::Cache *cache, std::vector<std::string> const &paths)
 {
     for (std::string path : paths) {
         // TODO(grp): Is this the right place to insert the SDKROOT? Should all path lists have this, or just *_SEARCH_PATHS?
@@ -39,7 +171,7 @@ AppendPaths(std::vector<std::string> *args, pbxsetting::Environment const &envir
             std::string sdkPath = FSUtil::NormalizePath(environment.resolve("SDKROOT") + path);
 
             // TODO(grp): Testing if the directory exists seems fragile.
-            if (FSUtil::TestForDirectory(sdkPath)) {
+            if (cache->isDirectory(filesystem, sdkPath)) {
                 path = sdkPath;
             }
         }
@@ -49,19 +181,14 @@ AppendPaths(std::vector<std::string> *args, pbxsetting::Environment const &envir
             std::string root = path.substr(0, path.size() - recursive.size());
             args->push_back(root);
 
+            // TODO(grp): Use build settings for included and excluded recursive paths.
+            // Included: INCLUDED_RECURSIVE_SEARCH_PATH_SUBDIRECTORIES
+            // Excluded: EXCLUDED_RECURSIVE_SEARCH_PATH_SUBDIRECTORIES
+            // Follow: RECURSIVE_SEARCH_PATHS_FOLLOW_SYMLINKS
             std::string absoluteRoot = FSUtil::ResolveRelativePath(root, workingDirectory);
-            FSUtil::EnumerateRecursive(absoluteRoot, [&](std::string const &path) -> bool {
-                // TODO(grp): Use build settings for included and excluded recursive paths.
-                // Included: INCLUDED_RECURSIVE_SEARCH_PATH_SUBDIRECTORIES
-                // Excluded: EXCLUDED_RECURSIVE_SEARCH_PATH_SUBDIRECTORIES
-                // Follow: RECURSIVE_SEARCH_PATHS_FOLLOW_SYMLINKS
-
-                if (FSUtil::TestForDirectory(path)) {
-                    std::string relativePath = root + "/" + path.substr(absoluteRoot.size() + 1);
-                    args->push_back(relativePath);
-                }
-                return true;
-            });
+            for (std::string const &subdirectory : cache->subdirectories(filesystem, absoluteRoot)) {
+                args->push_back(root + "/" + subdirectory);
+            }
         } else {
             args->push_back(path);
         }
@@ -69,29 +196,39 @@ AppendPaths(std::vector<std::string> *args, pbxsetting::Environment const &envir
 }
 
 std::vector<std::string> Tool::SearchPaths::
-ExpandRecursive(std::vector<std::string> const &paths, pbxsetting::Environment const &environment, std::string const &workingDirectory)
+ExpandRecursive(Filesystem const *filesystem, std::vector<std::string> const &paths, pbxsetting::Environment const &environment, std::string const &workingDirectory, Cache *cache)
 {
+    Cache localCache;
+    if (cache == nullptr) {
+        cache = &localCache;
+    }
+
     std::vector<std::string> result;
-    AppendPaths(&result, environment, workingDirectory, paths);
+    AppendPaths(&result, filesystem, environment, workingDirectory, cache, paths);
     return result;
 }
 
 Tool::SearchPaths Tool::SearchPaths::
-Create(pbxsetting::Environment const &environment, std::string const &workingDirectory)
+Create(Filesystem const *filesystem, pbxsetting::Environment const &environment, std::string const &workingDirectory, Cache *cache)
 {
+    Cache localCache;
+    if (cache == nullptr) {
+        cache = &localCache;
+    }
+
     std::vector<std::string> headerSearchPaths;
-    AppendPaths(&headerSearchPaths, environment, workingDirectory, pbxsetting::Type::ParseList(environment.resolve("PRODUCT_TYPE_HEADER_SEARCH_PATHS")));
-    AppendPaths(&headerSearchPaths, environment, workingDirectory, pbxsetting::Type::ParseList(environment.resolve("HEADER_SEARCH_PATHS")));
+    AppendPaths(&headerSearchPaths, filesystem, environment, workingDirectory, cache, pbxsetting::Type::ParseList(environment.resolve("PRODUCT_TYPE_HEADER_SEARCH_PATHS")));
+    AppendPaths(&headerSearchPaths, filesystem, environment, workingDirectory, cache, pbxsetting::Type::ParseList(environment.resolve("HEADER_SEARCH_PATHS")));
 
     std::vector<std::string> userHeaderSearchPaths;
-    AppendPaths(&userHeaderSearchPaths, environment, workingDirectory, pbxsetting::Type::ParseList(environment.resolve("USER_HEADER_SEARCH_PATHS")));
+    AppendPaths(&userHeaderSearchPaths, filesystem, environment, workingDirectory, cache, pbxsetting::Type::ParseList(environment.resolve("USER_HEADER_SEARCH_PATHS")));
 
     std::vector<std::string> frameworkSearchPaths;
-    AppendPaths(&frameworkSearchPaths, environment, workingDirectory, pbxsetting::Type::ParseList(environment.resolve("FRAMEWORK_SEARCH_PATHS")));
-    AppendPaths(&frameworkSearchPaths, environment, workingDirectory, pbxsetting::Type::ParseList(environment.resolve("PRODUCT_TYPE_FRAMEWORK_SEARCH_PATHS")));
+    AppendPaths(&frameworkSearchPaths, filesystem, environment, workingDirectory, cache, pbxsetting::Type::ParseList(environment.resolve("FRAMEWORK_SEARCH_PATHS")));
+    AppendPaths(&frameworkSearchPaths, filesystem, environment, workingDirectory, cache, pbxsetting::Type::ParseList(environment.resolve("PRODUCT_TYPE_FRAMEWORK_SEARCH_PATHS")));
 
     std::vector<std::string> librarySearchPaths;
-    AppendPaths(&librarySearchPaths, environment, workingDirectory, pbxsetting::Type::ParseList(environment.resolve("LIBRARY_SEARCH_PATHS")));
+    AppendPaths(&librarySearchPaths, filesystem, environment, workingDirectory, cache, pbxsetting::Type::ParseList(environment.resolve("LIBRARY_SEARCH_PATHS")));
 
     return Tool::SearchPaths(headerSearchPaths, userHeaderSearchPaths, frameworkSearchPaths, librarySearchPaths);
 }
@@ -13,20 +13,23 @@
 #include <pbxbuild/Tool/OptionsResult.h>
 #include <pbxbuild/Tool/Tokens.h>
 #include <pbxbuild/Tool/Context.h>
+#include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
 
 namespace Tool = pbxbuild::Tool;
 namespace Phase = pbxbuild::Phase;
+using libutil::Filesystem;
 using libutil::FSUtil;
 
 Tool::SwiftResolver::
-SwiftResolver(pbxspec::PBX::Compiler::shared_ptr const &compiler) :
-    _compiler(compiler)
+SwiftResolver(libutil::Filesystem const *filesystem, pbxspec::PBX::Compiler::shared_ptr const &compiler) :
+    _filesystem(filesystem),
+    _compiler  (compiler)
 {
 }
 
 static std::string
-SwiftLibraryPath(pbxsetting::Environment const &environment, xcsdk::SDK::Target::shared_ptr const &sdk, xcsdk::SDK::Toolchain::vector const &toolchains)
+SwiftLibraryPath(Filesystem const *filesystem, pbxsetting::Environment const &environment, xcsdk::SDK::Target::shared_ptr const &sdk, xcsdk::SDK::Toolchain::vector const &toolchains)
 {
     std::string path = environment.resolve("SWIFT_LIBRARY_PATH");
     if (!path.empty()) {
@@ -54,7 +57,7 @@ SwiftLibraryPath(pbxsetting::Environment const &environment, xcsdk::SDK::Target:
             std::string path = toolchain->path() + "/" + "usr" + "/" + "lib" + "/" + subpath;
 
             /* If the Swift library exists, return the directory containing it. */
-            if (FSUtil::TestForPresence(path)) {
+            if (filesystem->exists(path)) {
                 return FSUtil::GetDirectoryName(path);
             }
         }
@@ -238,7 +241,7 @@ resolve(
      * Resolve the tool options.
      */
     Tool::Environment toolEnvironment = Tool::Environment::Create(_compiler, baseEnvironment, toolContext->workingDirectory(), inputs);
-    Tool::OptionsResult options = Tool::OptionsResult::Create(toolEnvironment, toolContext->workingDirectory(), nullptr);
+    Tool::OptionsResult options = Tool::OptionsResult::Create(toolEnvironment, toolContext, nullptr);
     Tool::Tokens::ToolExpansions tokens = Tool::Tokens::ExpandTool(toolEnvironment, options);
 
     pbxsetting::Environment const &environment = toolEnvironment.environment();
@@ -355,7 +358,7 @@ resolve(
     // TODO(grp): For multi-arch builds the below flags get added twice.
 
     /* Add Swift libraries to linker arguments. */
-    std::string swiftLibraryPath = SwiftLibraryPath(environment, toolContext->sdk(), toolContext->toolchains());
+    std::string swiftLibraryPath = SwiftLibraryPath(_filesystem, environment, toolContext->sdk(), toolContext->toolchains());
     if (!swiftLibraryPath.empty()) {
         compilationInfo->linkerArguments().push_back("-L" + swiftLibraryPath);
     } else {
@@ -383,6 +386,6 @@ Create(Phase::Environment const &phaseEnvironment)
         return nullptr;
     }
 
-    return std::unique_ptr<Tool::SwiftResolver>(new Tool::SwiftResolver(swiftTool));
+    return std::unique_ptr<Tool::SwiftResolver>(new Tool::SwiftResolver(phaseEnvironment.filesystem(), swiftTool));
 }
 
@@ -0,0 +1,111 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxbuild/Build/Context.h>
+#include <pbxbuild/Build/Environment.h>
+#include <pbxbuild/WorkspaceContext.h>
+#include <libutil/MemoryFilesystem.h>
+
+#include <atomic>
+#include <thread>
+
+namespace Build = pbxbuild::Build;
+using pbxbuild::WorkspaceContext;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+/*
+ * A project with one target and no configuration for the build.
+ */
+static MemoryFilesystem
+ProjectFilesystem()
+{
+    return MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("project.xcodeproj", {
+            MemoryFilesystem::Entry::File("project.pbxproj", Contents(
+                "// !$*UTF8*$!\n"
+                "{\n"
+                "    archiveVersion = 1;\n"
+                "    objectVersion = 46;\n"
+                "    objects = {\n"
+                "        PROJECT = { isa = PBXProject; buildConfigurationList = PROJECTLIST; mainGroup = GROUP; targets = ( TARGET ); };\n"
+                "        PROJECTLIST = { isa = XCConfigurationList; buildConfigurations = ( PROJECTDEBUG ); defaultConfigurationName = Debug; };\n"
+                "        PROJECTDEBUG = { isa = XCBuildConfiguration; name = Debug; buildSettings = { }; };\n"
+                "        GROUP = { isa = PBXGroup; children = ( ); sourceTree = \"<group>\"; };\n"
+                "        TARGET = { isa = PBXAggregateTarget; name = Target; buildConfigurationList = TARGETLIST; buildPhases = ( ); dependencies = ( ); };\n"
+                "        TARGETLIST = { isa = XCConfigurationList; buildConfigurations = ( TARGETDEBUG ); defaultConfigurationName = Debug; };\n"
+                "        TARGETDEBUG = { isa = XCBuildConfiguration; name = Debug; buildSettings = { }; };\n"
+                "    };\n"
+                "    rootObject = PROJECT;\n"
+                "}\n")),
+        }),
+    });
+}
+
+TEST(Context, TargetEnvironmentReused)
+{
+    MemoryFilesystem filesystem = ProjectFilesystem();
+
+    pbxproj::PBX::Project::shared_ptr project = pbxproj::PBX::Project::Open(&filesystem, "/project.xcodeproj");
+    ASSERT_NE(nullptr, project);
+    ASSERT_EQ(1, project->targets().size());
+    pbxproj::PBX::Target::shared_ptr const &target = project->targets().front();
+
+    pbxsetting::Environment baseEnvironment;
+    WorkspaceContext workspaceContext = WorkspaceContext::Project(&filesystem, baseEnvironment, project);
+
+    /* No SDKs are needed: a missing configuration stops creation early. */
+    Build::Environment buildEnvironment = Build::Environment(nullptr, nullptr, baseEnvironment);
+    Build::Context buildContext = Build::Context(workspaceContext, nullptr, nullptr, "build", "Release", false, { });
+
+    /* Failures are remembered too, so the target is only resolved once. */
+    EXPECT_FALSE(buildContext.targetEnvironment(buildEnvironment, target));
+    EXPECT_FALSE(buildContext.targetEnvironment(buildEnvironment, target));
+    EXPECT_EQ(1, buildContext.targetEnvironmentsCreated());
+    EXPECT_EQ(1, buildContext.targetEnvironmentsReused());
+}
+
+TEST(Context, TargetEnvironmentCreatedOnce)
+{
+    MemoryFilesystem filesystem = ProjectFilesystem();
+
+    pbxproj::PBX::Project::shared_ptr project = pbxproj::PBX::Project::Open(&filesystem, "/project.xcodeproj");
+    ASSERT_NE(nullptr, project);
+    pbxproj::PBX::Target::shared_ptr const &target = project->targets().front();
+
+    pbxsetting::Environment baseEnvironment;
+    WorkspaceContext workspaceContext = WorkspaceContext::Project(&filesystem, baseEnvironment, project);
+    Build::Environment buildEnvironment = Build::Environment(nullptr, nullptr, baseEnvironment);
+    Build::Context buildContext = Build::Context(workspaceContext, nullptr, nullptr, "build", "Release", false, { });
+
+    /* Callers arriving while the environment is created wait for it. */
+    std::atomic<bool> start = { false };
+    std::vector<std::thread> threads;
+    for (size_t n = 0; n < 8; n++) {
+        threads.push_back(std::thread([&]() {
+            while (!start) {
+                std::this_thread::yield();
+            }
+            buildContext.targetEnvironment(buildEnvironment, target);
+        }));
+    }
+    start = true;
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(1, buildContext.targetEnvironmentsCreated());
+    EXPECT_EQ(7, buildContext.targetEnvironmentsReused());
+}
@@ -0,0 +1,103 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxbuild/FileTypeResolver.h>
+#include <libutil/MemoryFilesystem.h>
+
+using pbxbuild::FileTypeResolver;
+using libutil::MemoryFilesystem;
+
+/*
+ * Allows defining specifications inline without dealing with escaping
+ * embedded quotes or having to quote each line in the string.
+ */
+#define SPECIFICATIONS(...) Specifications(#__VA_ARGS__)
+
+static pbxspec::Manager::shared_ptr
+Specifications(std::string const &ascii)
+{
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("test.xcspec", std::vector<uint8_t>(ascii.begin(), ascii.end())),
+    });
+
+    pbxspec::Manager::shared_ptr specManager = pbxspec::Manager::Create();
+    specManager->registerDomains(&filesystem, { { "test", "/test.xcspec" } });
+    return specManager;
+}
+
+static std::string
+Resolve(FileTypeResolver::shared_ptr const &resolver, std::string const &path)
+{
+    MemoryFilesystem filesystem = MemoryFilesystem({ });
+    pbxspec::PBX::FileType::shared_ptr fileType = resolver->resolve(&filesystem, path);
+    return (fileType != nullptr ? fileType->identifier() : std::string());
+}
+
+TEST(FileTypeResolver, Resolve)
+{
+    pbxspec::Manager::shared_ptr specManager = SPECIFICATIONS((
+        { Type = FileType; Identifier = file; },
+        { Type = FileType; Identifier = folder; IsFolder = YES; },
+        { Type = FileType; Identifier = text; BasedOn = file; Extensions = (txt); },
+        { Type = FileType; Identifier = text.special; BasedOn = text; Extensions = (txt, text); },
+        { Type = FileType; Identifier = sourcecode.c.h; BasedOn = file; Extensions = (h); },
+        { Type = FileType; Identifier = text.readme; BasedOn = file; Prefix = (README); },
+        { Type = FileType; Identifier = text.make; BasedOn = file; FilenamePatterns = ("Makefile*"); },
+    ));
+
+    FileTypeResolver::shared_ptr resolver = FileTypeResolver::Create(specManager, { "test" });
+    ASSERT_NE(nullptr, resolver);
+
+    /* More specific file types are preferred. */
+    EXPECT_EQ("text.special", Resolve(resolver, "/missing/a.txt"));
+    EXPECT_EQ("text.special", Resolve(resolver, "/missing/a.text"));
+
+    /* Extensions are case insensitive. */
+    EXPECT_EQ("sourcecode.c.h", Resolve(resolver, "/missing/a.h"));
+    EXPECT_EQ("sourcecode.c.h", Resolve(resolver, "/missing/a.H"));
+
+    /* Prefixes and patterns match the file name. */
+    EXPECT_EQ("text.readme", Resolve(resolver, "/missing/README.md"));
+    EXPECT_EQ("text.make", Resolve(resolver, "/missing/Makefile.am"));
+    EXPECT_EQ("file", Resolve(resolver, "/missing/NOTREADME"));
+
+    /* Unknown files fall back to a generic file. */
+    EXPECT_EQ("file", Resolve(resolver, "/missing/a.unknown"));
+    EXPECT_EQ("file", Resolve(resolver, "/missing/a"));
+}
+
+TEST(FileTypeResolver, MagicWord)
+{
+    pbxspec::Manager::shared_ptr specManager = SPECIFICATIONS((
+        { Type = FileType; Identifier = file; },
+        { Type = FileType; Identifier = folder; IsFolder = YES; },
+        { Type = FileType; Identifier = archive.ar; BasedOn = file; MagicWord = ("!<arch>"); },
+    ));
+
+    FileTypeResolver::shared_ptr resolver = FileTypeResolver::Create(specManager, { "test" });
+    ASSERT_NE(nullptr, resolver);
+
+    std::string archive = "!<arch>\ncontents";
+    std::string other = "contents";
+    std::string prefix = "!<ar";
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("archive", std::vector<uint8_t>(archive.begin(), archive.end())),
+        MemoryFilesystem::Entry::File("other", std::vector<uint8_t>(other.begin(), other.end())),
+        MemoryFilesystem::Entry::File("prefix", std::vector<uint8_t>(prefix.begin(), prefix.end())),
+    });
+
+    /* Contents are read through the filesystem. */
+    EXPECT_EQ("archive.ar", resolver->resolve(&filesystem, "/archive")->identifier());
+
+    /* Files too short for the magic word, or without it, don't match. */
+    EXPECT_EQ("file", resolver->resolve(&filesystem, "/other")->identifier());
+    EXPECT_EQ("file", resolver->resolve(&filesystem, "/prefix")->identifier());
+    EXPECT_EQ("file", resolver->resolve(&filesystem, "/missing")->identifier());
+}
@@ -0,0 +1,126 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxbuild/Tool/HeadermapIndex.h>
+#include <pbxbuild/FileTypeResolver.h>
+#include <libutil/MemoryFilesystem.h>
+
+namespace Tool = pbxbuild::Tool;
+using pbxbuild::FileTypeResolver;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+static pbxsetting::Environment
+Environment(std::vector<pbxsetting::Setting> const &settings)
+{
+    pbxsetting::Environment environment;
+    environment.insertBack(pbxsetting::Level(settings), false);
+    return environment;
+}
+
+/*
+ * The directory of a project header, by name.
+ */
+static std::string
+HeaderDirectory(Tool::HeadermapIndex::shared_ptr const &index, std::string const &name)
+{
+    for (Tool::HeadermapIndex::Header const &header : index->projectHeaders()) {
+        if (header.name() == name) {
+            return header.directory();
+        }
+    }
+
+    return std::string();
+}
+
+TEST(HeadermapIndex, Cache)
+{
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("test.xcspec", Contents(
+            "(\n"
+            "    { Type = FileType; Identifier = file; },\n"
+            "    { Type = FileType; Identifier = sourcecode.c.h; BasedOn = file; Extensions = (h); },\n"
+            ")\n")),
+        MemoryFilesystem::Entry::Directory("project.xcodeproj", {
+            MemoryFilesystem::Entry::File("project.pbxproj", Contents(
+                "// !$*UTF8*$!\n"
+                "{\n"
+                "    archiveVersion = 1;\n"
+                "    objectVersion = 46;\n"
+                "    objects = {\n"
+                "        PROJECT = { isa = PBXProject; buildConfigurationList = PROJECTLIST; mainGroup = GROUP; targets = ( TARGET ); };\n"
+                "        PROJECTLIST = { isa = XCConfigurationList; buildConfigurations = ( PROJECTDEBUG ); defaultConfigurationName = Debug; };\n"
+                "        PROJECTDEBUG = { isa = XCBuildConfiguration; name = Debug; buildSettings = { }; };\n"
+                "        GROUP = { isa = PBXGroup; children = ( PUBLIC, PROJECTONLY, SOURCE ); sourceTree = \"<group>\"; };\n"
+                "        PUBLIC = { isa = PBXFileReference; path = include/public.h; sourceTree = SOURCE_ROOT; };\n"
+                "        PROJECTONLY = { isa = PBXFileReference; path = project.h; sourceTree = \"<group>\"; };\n"
+                "        SOURCE = { isa = PBXFileReference; path = source.c; sourceTree = SOURCE_ROOT; };\n"
+                "        TARGET = { isa = PBXNativeTarget; name = Library; productName = Library; productType = \"com.apple.product-type.library.static\"; buildConfigurationList = TARGETLIST; buildPhases = ( HEADERS ); dependencies = ( ); };\n"
+                "        TARGETLIST = { isa = XCConfigurationList; buildConfigurations = ( TARGETDEBUG ); defaultConfigurationName = Debug; };\n"
+                "        TARGETDEBUG = { isa = XCBuildConfiguration; name = Debug; buildSettings = { }; };\n"
+                "        HEADERS = { isa = PBXHeadersBuildPhase; files = ( PUBLICFILE ); };\n"
+                "        PUBLICFILE = { isa = PBXBuildFile; fileRef = PUBLIC; settings = { ATTRIBUTES = ( Public ); }; };\n"
+                "    };\n"
+                "    rootObject = PROJECT;\n"
+                "}\n")),
+        }),
+    });
+
+    pbxspec::Manager::shared_ptr specManager = pbxspec::Manager::Create();
+    specManager->registerDomains(&filesystem, { { "test", "/test.xcspec" } });
+    FileTypeResolver::shared_ptr fileTypeResolver = FileTypeResolver::Create(specManager, { "test" });
+    ASSERT_NE(nullptr, fileTypeResolver);
+
+    pbxproj::PBX::Project::shared_ptr project = pbxproj::PBX::Project::Open(&filesystem, "/project.xcodeproj");
+    ASSERT_NE(nullptr, project);
+
+    pbxsetting::Environment first = Environment({ pbxsetting::Setting::Create("SOURCE_ROOT", "/first") });
+    pbxsetting::Environment unrelated = Environment({ pbxsetting::Setting::Create("SOURCE_ROOT", "/first"), pbxsetting::Setting::Create("OTHER", "value") });
+    pbxsetting::Environment second = Environment({ pbxsetting::Setting::Create("SOURCE_ROOT", "/second") });
+
+    Tool::HeadermapIndex::Cache cache;
+    Tool::HeadermapIndex::shared_ptr cached = cache.index(&filesystem, *fileTypeResolver, project, first);
+    ASSERT_NE(nullptr, cached);
+
+    /* Headers are found, but not other files. */
+    EXPECT_EQ(2, cached->projectHeaders().size());
+    EXPECT_EQ("/first/include/", HeaderDirectory(cached, "public.h"));
+    EXPECT_EQ("/first/", HeaderDirectory(cached, "project.h"));
+    ASSERT_EQ(1, cached->targetHeaders().size());
+    EXPECT_EQ("Library/public.h", cached->targetHeaders()[0].frameworkName());
+    EXPECT_TRUE(cached->targetHeaders()[0].isPublic());
+    EXPECT_TRUE(cached->targetHeaders()[0].isNonFramework());
+
+    /* The cached headermaps are the same as ones built from scratch. */
+    Tool::HeadermapIndex::shared_ptr fresh = Tool::HeadermapIndex::Create(&filesystem, *fileTypeResolver, project, first);
+    EXPECT_EQ(fresh->projectHeadermap(), cached->projectHeadermap());
+    EXPECT_EQ(fresh->allTargetHeadermap(), cached->allTargetHeadermap());
+    EXPECT_EQ(fresh->allNonFrameworkTargetHeadermap(), cached->allNonFrameworkTargetHeadermap());
+
+    /* Settings that no file reference uses share the index. */
+    EXPECT_EQ(cached, cache.index(&filesystem, *fileTypeResolver, project, unrelated));
+
+    /* A different source tree builds a new index. */
+    Tool::HeadermapIndex::shared_ptr moved = cache.index(&filesystem, *fileTypeResolver, project, second);
+    ASSERT_NE(nullptr, moved);
+    EXPECT_NE(cached, moved);
+    EXPECT_EQ("/second/include/", HeaderDirectory(moved, "public.h"));
+    EXPECT_NE(cached->projectHeadermap(), moved->projectHeadermap());
+
+    fresh = Tool::HeadermapIndex::Create(&filesystem, *fileTypeResolver, project, second);
+    EXPECT_EQ(fresh->projectHeadermap(), moved->projectHeadermap());
+    EXPECT_EQ(fresh->allTargetHeadermap(), moved->allTargetHeadermap());
+    EXPECT_EQ(fresh->allNonFrameworkTargetHeadermap(), moved->allNonFrameworkTargetHeadermap());
+}
@@ -10,6 +10,7 @@
 #include <gtest/gtest.h>
 #include <plist/plist.h>
 #include <pbxbuild/Tool/OptionsResult.h>
+#include <libutil/MemoryFilesystem.h>
 
 namespace Tool = pbxbuild::Tool;
 
@@ -51,6 +52,9 @@ Environment(std::vector<pbxsetting::Setting> const &settings)
     return environment;
 }
 
+/* Default filesystem, empty. */
+static libutil::MemoryFilesystem const Filesystem = libutil::MemoryFilesystem({ });
+
 /* Default working directory. */
 static std::string const WorkingDirectory = "";
 
@@ -102,7 +106,7 @@ TEST(OptionsResolver, Boolean)
         pbxsetting::Setting::Create("FLAG", "flag"),
     });
 
-    auto result = Tool::OptionsResult::Create(environment, WorkingDirectory, options, FileType);
+    auto result = Tool::OptionsResult::Create(&Filesystem, environment, WorkingDirectory, options, FileType);
     EXPECT_EQ(result.arguments(), std::vector<std::string>({
         "true",
         "lower",
@@ -171,7 +175,7 @@ TEST(OptionsResolver, String)
         pbxsetting::Setting::Create("FLAG", "flag"),
     });
 
-    auto result = Tool::OptionsResult::Create(environment, WorkingDirectory, options, FileType);
+    auto result = Tool::OptionsResult::Create(&Filesystem, environment, WorkingDirectory, options, FileType);
     EXPECT_EQ(result.arguments(), std::vector<std::string>({
         "--string-normal", "string-normal",
         "--string-lower", "string-lower",
@@ -224,7 +228,7 @@ TEST(OptionsResolver, StringList)
         pbxsetting::Setting::Create("STRINGLIST_EMPTY", ""),
     });
 
-    auto result = Tool::OptionsResult::Create(environment, WorkingDirectory, options, FileType);
+    auto result = Tool::OptionsResult::Create(&Filesystem, environment, WorkingDirectory, options, FileType);
     EXPECT_EQ(result.arguments(), std::vector<std::string>({
         "--stringlist-normal", "stringlist-normal1", "--stringlist-normal", "stringlist-normal2",
         "--stringlist-lower", "stringlist-lower1", "--stringlist-lower", "stringlist-lower2",
@@ -275,7 +279,7 @@ TEST(OptionsResolver, FlagIfFalse)
         pbxsetting::Setting::Create("FLAG", "flag"),
     });
 
-    auto result = Tool::OptionsResult::Create(environment, WorkingDirectory, options, FileType);
+    auto result = Tool::OptionsResult::Create(&Filesystem, environment, WorkingDirectory, options, FileType);
     EXPECT_EQ(result.arguments(), std::vector<std::string>({
         "false",
         "expand-flag",
@@ -332,7 +336,7 @@ TEST(OptionsResolver, PrefixFlag)
         pbxsetting::Setting::Create("FLAG", "flag"),
     });
 
-    auto result = Tool::OptionsResult::Create(environment, WorkingDirectory, options, FileType);
+    auto result = Tool::OptionsResult::Create(&Filesystem, environment, WorkingDirectory, options, FileType);
     EXPECT_EQ(result.arguments(), std::vector<std::string>({
         "--prefix=prefix",
         "empty-prefix",
@@ -385,7 +389,7 @@ TEST(OptionsResolver, CommandLineArgsArray)
         pbxsetting::Setting::Create("FLAG", "flag"),
     });
 
-    auto result = Tool::OptionsResult::Create(environment, WorkingDirectory, options, FileType);
+    auto result = Tool::OptionsResult::Create(&Filesystem, environment, WorkingDirectory, options, FileType);
     EXPECT_EQ(result.arguments(), std::vector<std::string>({
         "yes", "yes-YES",
         "no", "no-NO",
@@ -444,7 +448,7 @@ TEST(OptionsResolver, CommandLineArgsDictionary)
         pbxsetting::Setting::Create("FLAG", "flag"),
     });
 
-    auto result = Tool::OptionsResult::Create(environment, WorkingDirectory, options, FileType);
+    auto result = Tool::OptionsResult::Create(&Filesystem, environment, WorkingDirectory, options, FileType);
     EXPECT_EQ(result.arguments(), std::vector<std::string>({
         "yes", "yes-flag",
         "value", "value-flag",
@@ -500,7 +504,7 @@ TEST(OptionsResolver, ValuesArguments)
         pbxsetting::Setting::Create("ALLOWED_VALUES_FLAG", "flag"),
     });
 
-    auto result = Tool::OptionsResult::Create(environment, WorkingDirectory, options, FileType);
+    auto result = Tool::OptionsResult::Create(&Filesystem, environment, WorkingDirectory, options, FileType);
     EXPECT_EQ(result.arguments(), std::vector<std::string>({
         "array", "array-array",
         "flag-flag",
@@ -544,7 +548,7 @@ TEST(OptionsResolver, AdditionalLinkerArgs)
         pbxsetting::Setting::Create("ARGS_DICT_DICT_INVALID", "other"),
     });
 
-    auto result = Tool::OptionsResult::Create(environment, WorkingDirectory, options, FileType);
+    auto result = Tool::OptionsResult::Create(&Filesystem, environment, WorkingDirectory, options, FileType);
     EXPECT_EQ(result.linkerArgs(), std::vector<std::string>({
         "array",
         "value", "value-value",
@@ -583,7 +587,7 @@ TEST(OptionsResolver, EnvironmentVariables)
         pbxsetting::Setting::Create("ENVIRONMENT_VARIABLE_EMPTY", ""),
     });
 
-    auto result = Tool::OptionsResult::Create(environment, WorkingDirectory, options, FileType);
+    auto result = Tool::OptionsResult::Create(&Filesystem, environment, WorkingDirectory, options, FileType);
     std::unordered_map<std::string, std::string> expectedEnvironmentVariables = {
         { "DIRECT", "direct" },
         { "INDIRECT", "indirect" },
@@ -621,7 +625,7 @@ TEST(OptionsResolver, Architectures)
         pbxsetting::Setting::Create("arch", "armv7"),
     });
 
-    auto result = Tool::OptionsResult::Create(environment, WorkingDirectory, options, FileType);
+    auto result = Tool::OptionsResult::Create(&Filesystem, environment, WorkingDirectory, options, FileType);
     EXPECT_EQ(result.arguments(), std::vector<std::string>({
         "arm",
     }));
@@ -0,0 +1,74 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxbuild/Tool/SearchPaths.h>
+#include <libutil/MemoryFilesystem.h>
+
+namespace Tool = pbxbuild::Tool;
+using libutil::MemoryFilesystem;
+
+TEST(SearchPaths, CacheOrder)
+{
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("root", {
+            MemoryFilesystem::Entry::Directory("a", {
+                MemoryFilesystem::Entry::Directory("x", {
+                    MemoryFilesystem::Entry::Directory("q", { }),
+                }),
+                MemoryFilesystem::Entry::Directory("y", { }),
+            }),
+            MemoryFilesystem::Entry::File("file", { }),
+            MemoryFilesystem::Entry::Directory("b", {
+                MemoryFilesystem::Entry::Directory("z", { }),
+            }),
+        }),
+    });
+
+    /* Each directory's subdirectories come before their own. */
+    Tool::SearchPaths::Cache cache;
+    EXPECT_EQ(std::vector<std::string>({ "a", "b", "a/x", "a/y", "a/x/q", "b/z" }), cache.subdirectories(&filesystem, "/root"));
+    EXPECT_EQ(std::vector<std::string>({ }), cache.subdirectories(&filesystem, "/root/file"));
+    EXPECT_EQ(std::vector<std::string>({ }), cache.subdirectories(&filesystem, "/missing"));
+}
+
+TEST(SearchPaths, CacheInvalidate)
+{
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("root", {
+            MemoryFilesystem::Entry::Directory("a", { }),
+        }),
+    });
+
+    Tool::SearchPaths::Cache cache;
+    EXPECT_EQ(std::vector<std::string>({ "a" }), cache.subdirectories(&filesystem, "/root"));
+    EXPECT_FALSE(cache.isDirectory(&filesystem, "/root/b"));
+    EXPECT_FALSE(cache.isDirectory(&filesystem, "/root/c/d"));
+
+    /* Created after the first lookup: still cached. */
+    ASSERT_TRUE(filesystem.createDirectory("/root/b"));
+    ASSERT_TRUE(filesystem.createDirectory("/root/c/d"));
+    EXPECT_EQ(std::vector<std::string>({ "a" }), cache.subdirectories(&filesystem, "/root"));
+    EXPECT_FALSE(cache.isDirectory(&filesystem, "/root/b"));
+
+    /* Unrelated paths keep the entries. */
+    cache.invalidate({ "/other/b", "/root-b" });
+    EXPECT_EQ(std::vector<std::string>({ "a" }), cache.subdirectories(&filesystem, "/root"));
+    EXPECT_FALSE(cache.isDirectory(&filesystem, "/root/b"));
+
+    /* Found once a path inside of them is invalidated. */
+    cache.invalidate({ "/root/b/output" });
+    EXPECT_EQ(std::vector<std::string>({ "a", "b", "c", "c/d" }), cache.subdirectories(&filesystem, "/root"));
+    EXPECT_TRUE(cache.isDirectory(&filesystem, "/root/b"));
+    EXPECT_FALSE(cache.isDirectory(&filesystem, "/root/c/d"));
+
+    /* Or a path containing them. */
+    cache.invalidate({ "/root/c" });
+    EXPECT_TRUE(cache.isDirectory(&filesystem, "/root/c/d"));
+}
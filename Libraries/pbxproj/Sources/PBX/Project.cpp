@@ -18,6 +18,7 @@
 
 using pbxproj::PBX::Project;
 using libutil::Filesystem;
+using libutil::MappedBuffer;
 using libutil::FSUtil;
 using libutil::SysUtil;
 
@@ -199,8 +200,8 @@ Open(Filesystem const *filesystem, std::string const &path)
         return nullptr;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, realPath)) {
+    MappedBuffer contents;
+    if (!filesystem->map(&contents, realPath)) {
         fprintf(stderr, "error: project file %s is not readable\n", projectFileName.c_str());
         return nullptr;
     }
@@ -208,7 +209,7 @@ Open(Filesystem const *filesystem, std::string const &path)
     //
     // Parse property list
     //
-    auto result = plist::Format::Any::Deserialize(contents);
+    auto result = plist::Format::Any::Deserialize(contents.data(), contents.size());
     if (result.first == nullptr) {
         fprintf(stderr, "error: project file %s is not parseable: %s\n", projectFileName.c_str(), result.second.c_str());
         return nullptr;
@@ -11,9 +11,11 @@
 #define __pbxsetting_Condition_h
 
 #include <pbxsetting/Base.h>
+#include <libutil/Wildcard.h>
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace pbxsetting {
 
@@ -22,6 +24,12 @@ public:
 private:
     std::unordered_map<std::string, std::string> _values;
 
+private:
+    /*
+     * The values, parsed once as patterns to match other conditions.
+     */
+    std::vector<std::pair<std::string, libutil::CompiledWildcard>> _patterns;
+
 public:
     Condition(std::unordered_map<std::string, std::string> const &values);
     ~Condition();
@@ -8,15 +8,17 @@
  */
 
 #include <pbxsetting/Condition.h>
-#include <libutil/Wildcard.h>
 
 using pbxsetting::Condition;
-using libutil::Wildcard;
+using libutil::CompiledWildcard;
 
 Condition::
 Condition(std::unordered_map<std::string, std::string> const &values) :
     _values(values)
 {
+    for (auto const &entry : _values) {
+        _patterns.push_back({ entry.first, CompiledWildcard(entry.second) });
+    }
 }
 
 Condition::
@@ -27,14 +29,14 @@ Condition::
 bool Condition::
 match(Condition const &condition) const
 {
-    auto OV = condition._values;
-    for (auto const &TE : _values) {
+    std::unordered_map<std::string, std::string> const &OV = condition._values;
+    for (auto const &TE : _patterns) {
         auto OE = OV.find(TE.first);
         if (OE == OV.end()) {
             return false;
         }
 
-        if (!Wildcard::Match(TE.second, OE->second)) {
+        if (!TE.second.match(OE->second)) {
             return false;
         }
     }
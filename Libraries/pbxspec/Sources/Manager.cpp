@@ -12,6 +12,10 @@
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 using pbxspec::Manager;
 using pbxspec::Context;
 using pbxspec::PBX::Specification;
@@ -29,6 +33,7 @@ using pbxspec::PBX::ProductType;
 using pbxspec::PBX::PropertyConditionFlavor;
 using pbxspec::PBX::Tool;
 using libutil::Filesystem;
+using libutil::MappedBuffer;
 using libutil::FSUtil;
 
 Manager::Manager()
@@ -350,11 +355,86 @@ inheritSpecification(PBX::Specification::shared_ptr const &specification)
     return true;
 }
 
+/*
+ * A single specification file to import, and the staging table it parses into.
+ */
+struct SpecificationImport {
+    Context                                   context;
+    std::string                               path;
+    ext::optional<Specification::vector>      specifications;
+};
+
+static void
+EnumerateSpecificationImports(Filesystem const *filesystem, std::string const &domain, std::string const &path, std::vector<SpecificationImport> *imports)
+{
+    if (filesystem->isDirectory(path)) {
+        filesystem->enumerateRecursive(path, [&](std::string const &filename) -> bool {
+            /* Support both *.xcspec and *.pbfilespec as a few of the latter remain in use. */
+            std::string extension = FSUtil::GetFileExtension(filename);
+            if (extension != "xcspec" && extension != "pbfilespec") {
+                return true;
+            }
+
+            if (!filesystem->isDirectory(filename)) {
+                /* For *.pbfilespec files, default to FileType specifications. */
+                bool file = (extension == "pbfilespec");
+                Context context = {
+                    .domain = domain,
+                    .defaultType = (file ? "FileType" : std::string()),
+                };
+
+                imports->push_back({ context, filename, ext::nullopt });
+            }
+            return true;
+        });
+    } else if (filesystem->exists(path)) {
+        Context context = {
+            .domain = domain,
+        };
+
+        imports->push_back({ context, path, ext::nullopt });
+    }
+}
+
+static void
+ParseSpecificationImports(Filesystem const *filesystem, std::vector<SpecificationImport> *imports)
+{
+    /*
+     * Each import parses into its own staging slot, so workers share nothing
+     * but the next index to claim. Results are read back in import order.
+     */
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t n = next++; n < imports->size(); n = next++) {
+            SpecificationImport *import = &(*imports)[n];
+            import->specifications = Specification::Open(filesystem, &import->context, import->path);
+        }
+    };
+
+    size_t concurrency = std::max<size_t>(1, std::thread::hardware_concurrency());
+    size_t threads = std::min(concurrency, imports->size());
+
+    std::vector<std::thread> pool;
+    for (size_t n = 1; n < threads; n++) {
+        pool.emplace_back(worker);
+    }
+
+    /* The calling thread participates too. */
+    worker();
+
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+}
+
 void Manager::
 registerDomains(Filesystem const *filesystem, std::vector<std::pair<std::string, std::string>> const &domains)
 {
-    PBX::Specification::vector specifications;
-
+    /*
+     * Find all specification files to import. Enumeration is cheap compared
+     * to parsing, so it happens up front and in the order the domains are given.
+     */
+    std::vector<SpecificationImport> imports;
     for (auto const &domain : domains) {
         /*
          * Avoid double domain registration. Unncessary and causes warnings.
@@ -363,45 +443,21 @@ registerDomains(Filesystem const *filesystem, std::vector<std::pair<std::string,
             continue;
         }
 
-        Context context = {
-            .domain = domain.first,
-        };
-
-        if (filesystem->isDirectory(domain.second)) {
-            filesystem->enumerateRecursive(domain.second, [&](std::string const &filename) -> bool {
-                /* Support both *.xcspec and *.pbfilespec as a few of the latter remain in use. */
-                if (FSUtil::GetFileExtension(filename) != "xcspec" && FSUtil::GetFileExtension(filename) != "pbfilespec") {
-                    return true;
-                }
-
-                /* For *.pbfilespec files, default to FileType specifications. */
-                bool file = FSUtil::GetFileExtension(filename) == "pbfilespec";
-                context.defaultType = (file ? "FileType" : std::string());
+        EnumerateSpecificationImports(filesystem, domain.first, domain.second, &imports);
+    }
 
-                if (!filesystem->isDirectory(filename)) {
-#if 0
-                    fprintf(stderr, "importing specification '%s'\n", filename.c_str());
-#endif
+    /*
+     * Parse all specification files concurrently. Domains are independent
+     * until inheritance is resolved below, so no shared state is touched.
+     */
+    ParseSpecificationImports(filesystem, &imports);
 
-                    ext::optional<PBX::Specification::vector> fileSpecifications = Specification::Open(filesystem, &context, filename);
-                    if (fileSpecifications) {
-                        specifications.insert(specifications.end(), fileSpecifications->begin(), fileSpecifications->end());
-                    } else {
-                        fprintf(stderr, "warning: failed to import specification '%s'\n", filename.c_str());
-                    }
-                }
-                return true;
-            });
-        } else if (filesystem->exists(domain.second)) {
-#if 0
-            fprintf(stderr, "importing specification '%s'\n", domain.second.c_str());
-#endif
-            ext::optional<PBX::Specification::vector> fileSpecifications = Specification::Open(filesystem, &context, domain.second);
-            if (fileSpecifications) {
-                specifications.insert(specifications.end(), fileSpecifications->begin(), fileSpecifications->end());
-            } else {
-                fprintf(stderr, "warning: failed to import specification '%s'\n", domain.second.c_str());
-            }
+    PBX::Specification::vector specifications;
+    for (SpecificationImport const &import : imports) {
+        if (import.specifications) {
+            specifications.insert(specifications.end(), import.specifications->begin(), import.specifications->end());
+        } else {
+            fprintf(stderr, "warning: failed to import specification '%s'\n", import.path.c_str());
         }
     }
 
@@ -423,7 +479,8 @@ registerDomains(Filesystem const *filesystem, std::vector<std::pair<std::string,
     }
 
     /*
-     * Inherit from existing and newly added specifications.
+     * Inherit from existing and newly added specifications. This is a single
+     * serial pass in import order, so the result doesn't depend on parse timing.
      */
     for (PBX::Specification::shared_ptr const &specification : specifications) {
         if (!inheritSpecification(specification)) {
@@ -436,12 +493,12 @@ registerDomains(Filesystem const *filesystem, std::vector<std::pair<std::string,
 bool Manager::
 registerBuildRules(Filesystem const *filesystem, std::string const &path)
 {
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, path)) {
+    MappedBuffer contents;
+    if (!filesystem->map(&contents, path)) {
         return false;
     }
 
-    std::unique_ptr<plist::Object> plist = plist::Format::Any::Deserialize(contents).first;
+    std::unique_ptr<plist::Object> plist = plist::Format::Any::Deserialize(contents.data(), contents.size()).first;
     if (plist == nullptr) {
         return false;
     }
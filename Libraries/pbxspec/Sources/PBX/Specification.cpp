@@ -25,6 +25,7 @@
 using pbxspec::PBX::Specification;
 using pbxspec::Manager;
 using libutil::Filesystem;
+using libutil::MappedBuffer;
 
 Specification::
 Specification()
@@ -199,8 +200,8 @@ Open(Filesystem const *filesystem, Context *context, std::string const &filename
         return ext::nullopt;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, realPath)) {
+    MappedBuffer contents;
+    if (!filesystem->map(&contents, realPath)) {
         fprintf(stderr, "error: unable to read specification plist\n");
         return ext::nullopt;
     }
@@ -208,7 +209,7 @@ Open(Filesystem const *filesystem, Context *context, std::string const &filename
     //
     // Parse property list
     //
-    std::unique_ptr<plist::Object> plist = plist::Format::Any::Deserialize(contents).first;
+    std::unique_ptr<plist::Object> plist = plist::Format::Any::Deserialize(contents.data(), contents.size()).first;
     if (plist == nullptr) {
         fprintf(stderr, "error: unable to parse specification plist\n");
         return ext::nullopt;
@@ -32,11 +32,24 @@ private:
 
 public:
     static Encoding
-    Detect(std::vector<uint8_t> const &contents);
+    Detect(uint8_t const *data, size_t size);
+    static Encoding
+    Detect(std::vector<uint8_t> const &contents)
+    { return Detect(contents.data(), contents.size()); }
 
 public:
     static std::vector<uint8_t>
-    Convert(std::vector<uint8_t> const &contents, Encoding from, Encoding to);
+    Convert(uint8_t const *data, size_t size, Encoding from, Encoding to);
+    static std::vector<uint8_t>
+    Convert(std::vector<uint8_t> const &contents, Encoding from, Encoding to)
+    { return Convert(contents.data(), contents.size(), from, to); }
+
+    /*
+     * Contents as UTF-8 without a BOM. Contents already in UTF-8 are used
+     * in place; anything else is converted into the buffer provided.
+     */
+    static std::pair<uint8_t const *, size_t>
+    ConvertToUTF8(uint8_t const *data, size_t size, Encoding from, std::vector<uint8_t> *buffer);
 
 public:
     static std::vector<uint8_t>
@@ -43,7 +43,7 @@ public:
     { return _error; }
 
 protected:
-    bool parse(std::vector<uint8_t> const &contents);
+    bool parse(uint8_t const *data, size_t size);
 
 protected:
     inline size_t depth() const
@@ -26,7 +26,7 @@ public:
     SimpleXMLParser();
 
 public:
-    Dictionary *parse(std::vector<uint8_t> const &contents);
+    Dictionary *parse(uint8_t const *data, size_t size);
 
 private:
     virtual void onBeginParse();
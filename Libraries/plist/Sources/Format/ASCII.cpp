@@ -35,9 +35,9 @@ namespace plist { namespace Format {
 
 template<>
 std::unique_ptr<ASCII> Format<ASCII>::
-Identify(std::vector<uint8_t> const &contents)
+Identify(uint8_t const *data, size_t size)
 {
-    Encoding encoding = Encodings::Detect(contents);
+    Encoding encoding = Encodings::Detect(data, size);
 
     /*
      * Identification of ASCII is as follows:
@@ -64,7 +64,7 @@ Identify(std::vector<uint8_t> const &contents)
     enum State state = kStateBegin, pstate = state;
     bool identifier = false;
 
-    for (auto bp = contents.begin(); bp != contents.end();) {
+    for (auto bp = data; bp != data + size;) {
         /* Conceal zeroes for UTF-16/32 encodings. */
         if (*bp == 0 || (state != kStateComment &&
                          state != kStateInlineComment &&
@@ -139,7 +139,7 @@ Identify(std::vector<uint8_t> const &contents)
                 case 0xef: /* UTF-8 */
                 case 0xbb:
                 case 0xbf:
-                    if (bp - contents.begin() < 4) {
+                    if (bp - data < 4) {
                         bp++;
                         continue;
                     } else {
@@ -220,16 +220,17 @@ Identify(std::vector<uint8_t> const &contents)
 
 template<>
 std::pair<std::unique_ptr<Object>, std::string> Format<ASCII>::
-Deserialize(std::vector<uint8_t> const &contents, ASCII const &format)
+Deserialize(uint8_t const *data, size_t size, ASCII const &format)
 {
     std::unique_ptr<Object> root = nullptr;
     std::string             error;
 
-    std::vector<uint8_t> const data = Encodings::Convert(contents, format.encoding(), Encoding::UTF8);
+    std::vector<uint8_t> buffer;
+    std::pair<uint8_t const *, size_t> contents = Encodings::ConvertToUTF8(data, size, format.encoding(), &buffer);
 
     /* Create lexer. */
     ASCIIPListLexer lexer;
-    ASCIIPListLexerInit(&lexer, reinterpret_cast<char const *>(data.data()), data.size(), kASCIIPListLexerStyleASCII);
+    ASCIIPListLexerInit(&lexer, reinterpret_cast<char const *>(contents.first), contents.second, kASCIIPListLexerStyleASCII);
 
     /* Parse contents. */
     ASCIIParser parser;
@@ -69,6 +69,14 @@
 
 /** Helpers **/
 
+/*
+ * The character at a position, or '\0' past the end. The input is not
+ * necessarily terminated, for example when it is mapped from a file.
+ */
+static inline char
+charat(ASCIIPListLexer const *lexer, char const *p)
+{ return (p < lexer->endBuffer ? *p : '\0'); }
+
 static inline bool
 istokenseparator(char ch, ASCIIPListLexer *lexer)
 {
@@ -108,7 +116,7 @@ ASCIIPListLexerReadInlineComment(ASCIIPListLexer *lexer)
     char const *b, *p = lexer->pointer + 2;
 
     lexer->tokenBegin = (p - lexer->inputBuffer);
-    for (b = p; *p != '\0' && *p != '\n' && *p != '\r'; p++)
+    for (b = p; p < lexer->endBuffer && *p != '\0' && *p != '\n' && *p != '\r'; p++)
         ;
     lexer->tokenLength = p - b;
     lexer->pointer = p;
@@ -122,11 +130,11 @@ ASCIIPListLexerReadLongComment(ASCIIPListLexer *lexer)
     char const *b, *p = lexer->pointer + 2;
 
     lexer->tokenBegin = (p - lexer->inputBuffer);
-    for (b = p; *p != '\0'; p++) {
+    for (b = p; p < lexer->endBuffer && *p != '\0'; p++) {
         if (p[0] == '\n') {
             lexer->line++;
             lexer->lineStart = p + 1;
-        } else if (p[0] == '*' && p[1] == '/') {
+        } else if (p[0] == '*' && charat(lexer, p + 1) == '/') {
             lexer->tokenLength = p - b;
             lexer->pointer = p + 2;
             return kASCIIPListLexerTokenLongComment;
@@ -142,14 +150,14 @@ ASCIIPListLexerReadSingleQuotedString(ASCIIPListLexer *lexer)
     char const *b, *p = lexer->pointer + 1;
 
     lexer->tokenBegin = (p - lexer->inputBuffer);
-    for (b = p; *p != '\'' && *p != '\0'; p++) {
+    for (b = p; p < lexer->endBuffer && *p != '\'' && *p != '\0'; p++) {
         if (*p == '\n') {
             lexer->line++;
             lexer->lineStart = p + 1;
         }
     }
 
-    if (*p != '\'') {
+    if (charat(lexer, p) != '\'') {
         return kASCIIPListLexerUnterminatedQuotedString;
     }
 
@@ -165,7 +173,7 @@ ASCIIPListLexerReadDoubleQuotedString(ASCIIPListLexer *lexer)
     char const *b, *p = lexer->pointer + 1;
 
     lexer->tokenBegin = (p - lexer->inputBuffer);
-    for (b = p; *p != '\"' && *p != '\0'; p++) {
+    for (b = p; p < lexer->endBuffer && *p != '\"' && *p != '\0'; p++) {
         if (*p == '\n') {
             lexer->line++;
             lexer->lineStart = p + 1;
@@ -174,7 +182,7 @@ ASCIIPListLexerReadDoubleQuotedString(ASCIIPListLexer *lexer)
         }
     }
 
-    if (*p != '\"') {
+    if (charat(lexer, p) != '\"') {
         return kASCIIPListLexerUnterminatedQuotedString;
     }
 
@@ -190,7 +198,7 @@ ASCIIPListLexerReadData(ASCIIPListLexer *lexer)
     char const *b, *p = lexer->pointer + 1;
 
     lexer->tokenBegin = (p - lexer->inputBuffer);
-    for (b = p; *p != '>' && *p != '\0'; p++) {
+    for (b = p; p < lexer->endBuffer && *p != '>' && *p != '\0'; p++) {
         if (*p == '\n') {
             lexer->line++;
             lexer->lineStart = p + 1;
@@ -204,7 +212,7 @@ ASCIIPListLexerReadData(ASCIIPListLexer *lexer)
         }
     }
 
-    if (*p != '>')
+    if (charat(lexer, p) != '>')
         return kASCIIPListLexerUnterminatedData;
 
     lexer->tokenLength = p - b;
@@ -234,33 +242,33 @@ ASCIIPListLexerReadNumber(ASCIIPListLexer *lexer)
 
     lexer->tokenBegin = (p - lexer->inputBuffer);
 
-    if (*p == '+' || *p == '-')
+    if (charat(lexer, p) == '+' || charat(lexer, p) == '-')
         p++;
 
-    if (!isdigit(*p))
+    if (!isdigit(charat(lexer, p)))
         return kASCIIPListLexerInvalidToken;
 
-    while (isdigit(*p))
+    while (isdigit(charat(lexer, p)))
         p++;
 
-    if (*p == '.') {
+    if (charat(lexer, p) == '.') {
         integer = false;
 
         p++;
-        while (isdigit(*p)) {
+        while (isdigit(charat(lexer, p))) {
             p++;
         }
     }
 
-    if (*p == 'e' || *p == 'E') {
+    if (charat(lexer, p) == 'e' || charat(lexer, p) == 'E') {
         integer = false;
 
         p++;
-        if (*p == '+' || *p == '-') {
+        if (charat(lexer, p) == '+' || charat(lexer, p) == '-') {
             p++;
         }
 
-        while (isdigit(*p)) {
+        while (isdigit(charat(lexer, p))) {
             p++;
         }
     }
@@ -284,16 +292,16 @@ ASCIIPListLexerReadKeyword(ASCIIPListLexer *lexer)
     lexer->tokenBegin = p - lexer->inputBuffer;
 
     if (lexer->style == kASCIIPListLexerStyleJSON) {
-        if (*p == 't' && strncmp(p, "true", 4) == 0 &&
-            istokenseparator(*(p + 4), lexer)) {
+        if (*p == 't' && lexer->endBuffer - p >= 4 && strncmp(p, "true", 4) == 0 &&
+            istokenseparator(charat(lexer, p + 4), lexer)) {
             p += 4;
             rc = kASCIIPListLexerTokenBoolTrue;
-        } else if (*p == 'f' && strncmp(p, "false", 5) == 0 &&
-                   istokenseparator(*(p + 5), lexer)) {
+        } else if (*p == 'f' && lexer->endBuffer - p >= 5 && strncmp(p, "false", 5) == 0 &&
+                   istokenseparator(charat(lexer, p + 5), lexer)) {
             p += 5;
             rc = kASCIIPListLexerTokenBoolFalse;
-        } else if (*p == 'n' && strncmp(p, "null", 4) == 0 &&
-                   istokenseparator(*(p + 4), lexer)) {
+        } else if (*p == 'n' && lexer->endBuffer - p >= 4 && strncmp(p, "null", 4) == 0 &&
+                   istokenseparator(charat(lexer, p + 4), lexer)) {
             p += 4;
             rc = kASCIIPListLexerTokenNull;
         }
@@ -302,8 +310,9 @@ ASCIIPListLexerReadKeyword(ASCIIPListLexer *lexer)
         /*
             * '$' is encountered in pbxproj files.
             */
-        while (isalnum(*p) || *p == '_' || *p == '.' || *p == '$' ||
-                              *p == '-' || *p == ':' || *p == '/') {
+        while (p < lexer->endBuffer &&
+               (isalnum(*p) || *p == '_' || *p == '.' || *p == '$' ||
+                               *p == '-' || *p == ':' || *p == '/')) {
             if (*p & 0x80) {
                 rc = kASCIIPListLexerInvalidToken;
                 break;
@@ -327,10 +336,10 @@ ASCIIPListLexerReadToken(ASCIIPListLexer *lexer)
     while (p < lexer->endBuffer) {
         switch (*p) {
             case '/': /* Comments */
-                if (p[1] == '/') {
+                if (charat(lexer, p + 1) == '/') {
                     lexer->pointer = p;
                     return ASCIIPListLexerReadInlineComment(lexer);
-                } else if (p[1] == '*') {
+                } else if (charat(lexer, p + 1) == '*') {
                     lexer->pointer = p;
                     return ASCIIPListLexerReadLongComment(lexer);
                 } else {
@@ -18,13 +18,19 @@ BaseXMLParser::BaseXMLParser() :
     _parser (nullptr),
     _depth  (0)
 {
+    /*
+     * libxml2's lazy global initialization is not thread safe, but parsers
+     * may be created on multiple threads at once. Initialize it exactly once.
+     */
+    static bool initialized = (::xmlInitParser(), true);
+    (void)initialized;
 }
 
 bool BaseXMLParser::
-parse(std::vector<uint8_t> const &contents)
+parse(uint8_t const *data, size_t size)
 {
     _depth  = 0;
-    _parser = ::xmlReaderForMemory(reinterpret_cast<char const *>(contents.data()), contents.size(), nullptr, nullptr, XML_PARSE_NOENT | XML_PARSE_NONET);
+    _parser = ::xmlReaderForMemory(reinterpret_cast<char const *>(data), size, nullptr, nullptr, XML_PARSE_NOENT | XML_PARSE_NONET);
     if (_parser == nullptr) {
         return false;
     }
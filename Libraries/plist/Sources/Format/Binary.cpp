@@ -48,15 +48,15 @@ namespace plist { namespace Format {
 
 template<>
 std::unique_ptr<Binary> Format<Binary>::
-Identify(std::vector<uint8_t> const &contents)
+Identify(uint8_t const *data, size_t size)
 {
     size_t length = strlen(ABPLIST_MAGIC ABPLIST_VERSION);
 
-    if (contents.size() < length) {
+    if (size < length) {
         return nullptr;
     }
 
-    if (std::memcmp(contents.data(), ABPLIST_MAGIC ABPLIST_VERSION, length) == 0) {
+    if (std::memcmp(data, ABPLIST_MAGIC ABPLIST_VERSION, length) == 0) {
         return std::unique_ptr<Binary>(new Binary(Binary::Create()));
     }
 
@@ -68,7 +68,8 @@ struct BinaryParseContext {
     ABPStreamCallBacks            streamCallBacks;
     ABPCreateCallBacks            createCallBacks;
 
-    std::vector<uint8_t> const   *contents;
+    uint8_t const                *data;
+    size_t                        size;
     off_t                         offset;
 
     std::unordered_set<Object *>  seen;
@@ -88,13 +89,13 @@ ReadSeek(void *opaque, off_t offset, int whence)
             self->offset += offset;
             break;
         case SEEK_END:
-            self->offset = self->contents->size() + offset;
+            self->offset = self->size + offset;
         default:
             break;
     }
 
     /* Error if past the end. */
-    if (self->offset > self->contents->size()) {
+    if (self->offset > (off_t)self->size) {
         return -1;
     }
 
@@ -108,13 +109,13 @@ ReadData(void *opaque, void *buffer, size_t size)
     auto self = reinterpret_cast <BinaryParseContext *> (opaque);
 
     /* Adjust size for remaining contents. */
-    size_t remaining = self->contents->size() - self->offset;
+    size_t remaining = self->size - self->offset;
     if (remaining < size) {
         size = remaining;
     }
 
     /* Copy into read buffer. */
-    ::memcpy(buffer, self->contents->data() + self->offset, size);
+    ::memcpy(buffer, self->data + self->offset, size);
 
     self->offset += size;
     return size;
@@ -289,7 +290,7 @@ Error(void *opaque, char const *message)
 
 template<>
 std::pair<std::unique_ptr<Object>, std::string> Format<Binary>::
-Deserialize(std::vector<uint8_t> const &contents, Binary const &format)
+Deserialize(uint8_t const *data, size_t size, Binary const &format)
 {
     BinaryParseContext parseContext;
 
@@ -305,7 +306,8 @@ Deserialize(std::vector<uint8_t> const &contents, Binary const &format)
     parseContext.createCallBacks.create  = &Create;
     parseContext.createCallBacks.error   = &Error;
 
-    parseContext.contents                = &contents;
+    parseContext.data                    = data;
+    parseContext.size                    = size;
     parseContext.offset                  = 0;
 
     ::ABPReaderInit(&parseContext.context, &parseContext.streamCallBacks, &parseContext.createCallBacks);
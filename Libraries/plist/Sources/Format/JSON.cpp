@@ -27,7 +27,7 @@ namespace plist { namespace Format {
 
 template<>
 std::unique_ptr<JSON> Format<JSON>::
-Identify(std::vector<uint8_t> const &contents)
+Identify(uint8_t const *data, size_t size)
 {
     /* JSON is not a standard format. */
     return nullptr;
@@ -35,14 +35,14 @@ Identify(std::vector<uint8_t> const &contents)
 
 template<>
 std::pair<std::unique_ptr<Object>, std::string> Format<JSON>::
-Deserialize(std::vector<uint8_t> const &contents, JSON const &format)
+Deserialize(uint8_t const *data, size_t size, JSON const &format)
 {
     std::unique_ptr<Object> root = nullptr;
     std::string             error;
 
     /* Create lexer. */
     ASCIIPListLexer lexer;
-    ASCIIPListLexerInit(&lexer, reinterpret_cast<char const *>(contents.data()), contents.size(), kASCIIPListLexerStyleJSON);
+    ASCIIPListLexerInit(&lexer, reinterpret_cast<char const *>(data), size, kASCIIPListLexerStyleJSON);
 
     /* Parse contents. */
     JSONParser parser;
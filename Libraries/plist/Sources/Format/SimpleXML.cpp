@@ -26,7 +26,7 @@ namespace plist { namespace Format {
 
 template<>
 std::unique_ptr<SimpleXML> Format<SimpleXML>::
-Identify(std::vector<uint8_t> const &contents)
+Identify(uint8_t const *data, size_t size)
 {
     /*
      * To identify XML document, we look for a <? or <!, ignoring
@@ -35,7 +35,7 @@ Identify(std::vector<uint8_t> const &contents)
 
     uint8_t last = '\0';
 
-    for (auto bp = contents.begin(); bp != contents.end();) {
+    for (auto bp = data; bp != data + size;) {
         /* Conceal zeroes for UTF-16/32 encodings. */
         if (*bp == 0 || isspace(*bp)) {
             bp++;
@@ -46,9 +46,9 @@ Identify(std::vector<uint8_t> const &contents)
                 /* Found <? or <! */
             }
 
-            Encoding encoding = Encodings::Detect(contents);
+            Encoding encoding = Encodings::Detect(data, size);
             return std::unique_ptr<SimpleXML>(new SimpleXML(SimpleXML::Create(encoding)));
-        } else if (bp - contents.begin() < 4) {
+        } else if (bp - data < 4) {
             /*
              * We conceal some BOM chars for UTF encodings in the first
              * four bytes.
@@ -74,12 +74,13 @@ Identify(std::vector<uint8_t> const &contents)
 
 template<>
 std::pair<std::unique_ptr<Object>, std::string> Format<SimpleXML>::
-Deserialize(std::vector<uint8_t> const &contents, SimpleXML const &format)
+Deserialize(uint8_t const *data, size_t size, SimpleXML const &format)
 {
-    std::vector<uint8_t> const data = Encodings::Convert(contents, format.encoding(), Encoding::UTF8);
+    std::vector<uint8_t> buffer;
+    std::pair<uint8_t const *, size_t> contents = Encodings::ConvertToUTF8(data, size, format.encoding(), &buffer);
 
     SimpleXMLParser parser;
-    std::unique_ptr<Object> root = std::unique_ptr<Object>(parser.parse(data));
+    std::unique_ptr<Object> root = std::unique_ptr<Object>(parser.parse(contents.first, contents.second));
     if (root == nullptr) {
         return std::make_pair(nullptr, parser.error());
     }
@@ -22,12 +22,12 @@ SimpleXMLParser::SimpleXMLParser() :
 }
 
 Dictionary *SimpleXMLParser::
-parse(std::vector<uint8_t> const &contents)
+parse(uint8_t const *data, size_t size)
 {
     if (_root != nullptr)
         return nullptr;
 
-    if (!BaseXMLParser::parse(contents))
+    if (!BaseXMLParser::parse(data, size))
         return nullptr;
 
     return _root;
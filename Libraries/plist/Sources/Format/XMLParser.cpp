@@ -21,12 +21,12 @@ XMLParser::XMLParser() :
 }
 
 Object *XMLParser::
-parse(std::vector<uint8_t> const &contents)
+parse(uint8_t const *data, size_t size)
 {
     if (_root != nullptr)
         return nullptr;
 
-    if (!BaseXMLParser::parse(contents))
+    if (!BaseXMLParser::parse(data, size))
         return nullptr;
 
     return _root;
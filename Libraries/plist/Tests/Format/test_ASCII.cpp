@@ -11,6 +11,11 @@
 #include <plist/Format/ASCII.h>
 #include <plist/Objects.h>
 
+#include <cstring>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
 using plist::Format::ASCII;
 using plist::Format::Encoding;
 using plist::String;
@@ -26,6 +31,29 @@ Contents(std::string const &string)
     return std::vector<uint8_t>(string.begin(), string.end());
 }
 
+/*
+ * Parse contents that end exactly at an inaccessible page, as a mapped file
+ * with no trailing zero would. Reading past the end crashes.
+ */
+static void
+DeserializeExact(std::string const &string, bool parses)
+{
+    size_t page = ::sysconf(_SC_PAGESIZE);
+    ASSERT_LE(string.size(), page);
+
+    void *pages = ::mmap(nullptr, page * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(MAP_FAILED, pages);
+    ASSERT_EQ(0, ::mprotect(static_cast<uint8_t *>(pages) + page, page, PROT_NONE));
+
+    uint8_t *data = static_cast<uint8_t *>(pages) + page - string.size();
+    memcpy(data, string.data(), string.size());
+
+    auto deserialize = ASCII::Deserialize(data, string.size(), ASCII::Create(false, Encoding::UTF8));
+    EXPECT_EQ(parses, deserialize.first != nullptr) << string;
+
+    ::munmap(pages, page * 2);
+}
+
 TEST(ASCII, QuotedString)
 {
     auto contents = Contents("\"str*ng\"\n");
@@ -146,3 +174,20 @@ TEST(ASCII, CommentWithStarAndSlash)
     dictionary->set("key", String::New("value"));
     EXPECT_TRUE(deserialize.first->equals(dictionary.get()));
 }
+
+TEST(ASCII, ExactlySizedBuffer)
+{
+    DeserializeExact("{ key = value; }", true);
+    DeserializeExact("{ key = \"value\"; } // comment", true);
+    DeserializeExact("{ key = value; } /* comment */", true);
+    DeserializeExact("string", true);
+    DeserializeExact("123", true);
+
+    /* Unterminated tokens must stop at the end of the buffer. */
+    DeserializeExact("{ key = value; } /* comment", false);
+    DeserializeExact("{ key = value; } /", false);
+    DeserializeExact("{ key = \"value", false);
+    DeserializeExact("{ key = \"value\\", false);
+    DeserializeExact("{ key = 'value", false);
+    DeserializeExact("{ key = <0a0b", false);
+}
@@ -168,3 +168,22 @@ TEST(Encoding, ConvertStripBOM)
         EXPECT_FALSE(std::equal(BOM.begin(), BOM.end(), converted.begin()));
     }
 }
+
+TEST(Encoding, ConvertToUTF8)
+{
+    for (auto const &source : AllContent) {
+        std::vector<uint8_t> content = source.second;
+        std::vector<uint8_t> BOM = Encodings::BOM(source.first);
+        content.insert(content.begin(), BOM.begin(), BOM.end());
+
+        std::vector<uint8_t> buffer;
+        std::pair<uint8_t const *, size_t> converted = Encodings::ConvertToUTF8(content.data(), content.size(), source.first, &buffer);
+        EXPECT_EQ(std::vector<uint8_t>(converted.first, converted.first + converted.second), Content_UTF8);
+
+        /* UTF-8 is used in place, after the BOM. */
+        if (source.first == Encoding::UTF8) {
+            EXPECT_EQ(content.data() + BOM.size(), converted.first);
+            EXPECT_TRUE(buffer.empty());
+        }
+    }
+}
@@ -32,6 +32,7 @@
 
 using xcassets::Asset::Asset;
 using libutil::Filesystem;
+using libutil::MappedBuffer;
 using libutil::FSUtil;
 
 Asset::
@@ -238,15 +239,15 @@ load(Filesystem const *filesystem)
         /*
          * Read in the contents file.
          */
-        std::vector<uint8_t> contents;
-        if (!filesystem->read(&contents, contentsPath)) {
+        MappedBuffer contents;
+        if (!filesystem->map(&contents, contentsPath)) {
             return false;
         }
 
         /*
          * If the Contents.json file exists, it must be JSON.
          */
-        auto deserialized = plist::Format::JSON::Deserialize(contents, plist::Format::JSON::Create());
+        auto deserialized = plist::Format::JSON::Deserialize(contents.data(), contents.size(), plist::Format::JSON::Create());
         if (!deserialized.first) {
             return false;
         }
@@ -41,6 +41,8 @@ private:
     std::string _formatter;
     std::string _executor;
     bool        _generate;
+    std::string _actionCache;
+    int         _actionCacheSize;
 
 private:
     bool        _parallelizeTargets;
@@ -138,6 +140,12 @@ public:
     /* Extension. */
     bool generate() const
     { return _generate; }
+    /* Extension. */
+    std::string const &actionCache() const
+    { return _actionCache; }
+    /* Extension. Size limit in megabytes. */
+    int actionCacheSize() const
+    { return _actionCacheSize; }
 
 public:
     bool parallelizeTargets() const
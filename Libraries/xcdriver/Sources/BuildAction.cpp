@@ -10,18 +10,21 @@
 #include <xcdriver/BuildAction.h>
 #include <xcdriver/Action.h>
 #include <xcdriver/Options.h>
+#include <xcexecution/ActionCache.h>
 #include <xcexecution/NinjaExecutor.h>
 #include <xcexecution/SimpleExecutor.h>
 #include <xcformatter/DefaultFormatter.h>
 #include <builtin/builtin.h>
 #include <libutil/Base.h>
 #include <libutil/Filesystem.h>
+#include <libutil/FSUtil.h>
 
 #include <unistd.h>
 
 using xcdriver::BuildAction;
 using xcdriver::Options;
 using libutil::Filesystem;
+using libutil::FSUtil;
 
 BuildAction::
 BuildAction()
@@ -52,14 +55,18 @@ CreateExecutor(
     std::string const &executor,
     std::shared_ptr<xcformatter::Formatter> const &formatter,
     bool dryRun,
-    bool generate)
+    bool generate,
+    bool verbose,
+    int jobs,
+    bool parallelizeTargets,
+    std::shared_ptr<xcexecution::ActionCache> const &actionCache)
 {
     if (executor == "simple" || executor.empty()) {
         auto registry = builtin::Registry::Default();
-        auto executor = xcexecution::SimpleExecutor::Create(formatter, dryRun, registry);
+        auto executor = xcexecution::SimpleExecutor::Create(formatter, dryRun, verbose, registry, jobs > 0 ? jobs : 0, parallelizeTargets, actionCache);
         return libutil::static_unique_pointer_cast<xcexecution::Executor>(std::move(executor));
     } else if (executor == "ninja") {
-        auto executor = xcexecution::NinjaExecutor::Create(formatter, dryRun, generate);
+        auto executor = xcexecution::NinjaExecutor::Create(formatter, dryRun, generate, verbose, actionCache);
         return libutil::static_unique_pointer_cast<xcexecution::Executor>(std::move(executor));
     }
 
@@ -77,7 +84,7 @@ VerifySupportedOptions(Options const &options)
         fprintf(stderr, "warning: destination option not implemented\n");
     }
 
-    if (options.parallelizeTargets() || options.jobs() > 0) {
+    if ((options.parallelizeTargets() || options.jobs() > 0) && options.executor() == "ninja") {
         fprintf(stderr, "warning: job control option not implemented\n");
     }
 
@@ -122,10 +129,24 @@ Run(Filesystem *filesystem, Options const &options)
         return -1;
     }
 
+    /*
+     * Create the action cache, if one was requested.
+     */
+    std::shared_ptr<xcexecution::ActionCache> actionCache;
+    if (!options.actionCache().empty()) {
+        uint64_t sizeLimit = xcexecution::ActionCache::DefaultSizeLimit();
+        if (options.actionCacheSize() > 0) {
+            sizeLimit = static_cast<uint64_t>(options.actionCacheSize()) * 1024 * 1024;
+        }
+
+        std::string path = FSUtil::ResolveRelativePath(options.actionCache(), FSUtil::GetCurrentDirectory());
+        actionCache = std::make_shared<xcexecution::ActionCache>(path, sizeLimit);
+    }
+
     /*
      * Create the executor used to perform the build.
      */
-    std::unique_ptr<xcexecution::Executor> executor = CreateExecutor(options.executor(), formatter, options.dryRun(), options.generate());
+    std::unique_ptr<xcexecution::Executor> executor = CreateExecutor(options.executor(), formatter, options.dryRun(), options.generate(), options.verbose(), options.jobs(), options.parallelizeTargets(), actionCache);
     if (executor == nullptr) {
         fprintf(stderr, "error: unknown executor %s\n", options.executor().c_str());
         return -1;
@@ -153,6 +174,15 @@ Run(Filesystem *filesystem, Options const &options)
      * Perform the build!
      */
     bool success = executor->build(filesystem, *buildEnvironment, parameters);
+
+    /*
+     * Report how the action cache was used, and keep it within its limit.
+     */
+    if (actionCache != nullptr && actionCache->hits() + actionCache->misses() > 0) {
+        fprintf(stderr, "Action cache: %zu hits, %zu misses\n", actionCache->hits(), actionCache->misses());
+        actionCache->trim();
+    }
+
     if (!success) {
         return 1;
     }
@@ -21,6 +21,7 @@ Options() :
     _version                   (false),
     _allTargets                (false),
     _generate                  (false),
+    _actionCacheSize           (0),
     _parallelizeTargets        (false),
     _jobs                      (0),
     _dryRun                    (false),
@@ -143,6 +144,10 @@ parseArgument(std::vector<std::string> const &args, std::vector<std::string>::co
         return libutil::Options::NextString(&_formatter, args, it);
     } else if (arg == "-generate") {
         return libutil::Options::MarkBool(&_generate, arg);
+    } else if (arg == "-actionCache") {
+        return libutil::Options::NextString(&_actionCache, args, it);
+    } else if (arg == "-actionCacheSize") {
+        return libutil::Options::NextInt(&_actionCacheSize, args, it);
     } else if (!arg.empty() && arg[0] != '-') {
         if (arg.find('=') != std::string::npos) {
             _settings.push_back(pbxsetting::Setting::Parse(arg));
@@ -0,0 +1,126 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __xcexecution_ActionCache_h
+#define __xcexecution_ActionCache_h
+
+#include <xcexecution/Base.h>
+#include <pbxbuild/Tool/Invocation.h>
+
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <ext/optional>
+
+namespace xcexecution {
+
+/*
+ * A local cache of the outputs of commands, keyed by the command and the
+ * contents of its inputs. A command with the same key as a cached one can
+ * restore its outputs instead of running. The cache is a directory that
+ * can be shared between builds, checkouts, and processes.
+ */
+class ActionCache {
+private:
+    std::string         _path;
+    uint64_t            _sizeLimit;
+
+private:
+    std::atomic<size_t> _hits;
+    std::atomic<size_t> _misses;
+
+public:
+    ActionCache(std::string const &path, uint64_t sizeLimit);
+    ~ActionCache();
+
+public:
+    /*
+     * The directory holding the cache.
+     */
+    std::string const &path() const
+    { return _path; }
+
+    /*
+     * The size in bytes the cache is trimmed to.
+     */
+    uint64_t sizeLimit() const
+    { return _sizeLimit; }
+
+public:
+    /*
+     * Lookups in this process that restored outputs, and that didn't.
+     */
+    size_t hits() const
+    { return _hits; }
+    size_t misses() const
+    { return _misses; }
+
+public:
+    /*
+     * The key for a command. Fails if any input can't be read.
+     */
+    ext::optional<std::string>
+    key(
+        std::string const &executable,
+        std::vector<std::string> const &arguments,
+        std::unordered_map<std::string, std::string> const &environment,
+        std::string const &workingDirectory,
+        std::vector<std::string> const &inputs) const;
+
+    /*
+     * The key for an invocation, using its declared inputs.
+     */
+    ext::optional<std::string>
+    key(pbxbuild::Tool::Invocation const &invocation) const;
+
+public:
+    /*
+     * Restore the outputs cached for a key. Returns false if there are
+     * none, in which case the command needs to run.
+     */
+    bool restore(std::string const &key, std::vector<std::string> const &outputs);
+
+    /*
+     * Cache the outputs of a command that succeeded. Only regular files
+     * can be cached; fails without caching anything otherwise.
+     */
+    bool store(std::string const &key, std::vector<std::string> const &outputs);
+
+    /*
+     * Remove the least recently used entries until the cache is within
+     * its size limit.
+     */
+    void trim();
+
+public:
+    /*
+     * Read the hits and misses recorded by every process using the cache.
+     */
+    bool statistics(size_t *hits, size_t *misses) const;
+
+public:
+    /*
+     * If an invocation declares all of its inputs and outputs, so it can
+     * be cached. Invocations that discover inputs while running cannot.
+     */
+    static bool
+    Cacheable(pbxbuild::Tool::Invocation const &invocation);
+
+public:
+    /*
+     * The default size limit, in bytes.
+     */
+    static uint64_t
+    DefaultSizeLimit();
+};
+
+}
+
+#endif // !__xcexecution_ActionCache_h
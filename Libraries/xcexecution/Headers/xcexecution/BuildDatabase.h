@@ -0,0 +1,196 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __xcexecution_BuildDatabase_h
+#define __xcexecution_BuildDatabase_h
+
+#include <xcexecution/Base.h>
+#include <pbxbuild/Tool/Invocation.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <ext/optional>
+
+namespace libutil { class Filesystem; }
+
+namespace xcexecution {
+
+/*
+ * Records the invocations that last ran for a target, so the next build
+ * can skip any invocation whose command, inputs, and outputs are unchanged.
+ */
+class BuildDatabase {
+public:
+    /*
+     * The state of a file when an invocation was recorded.
+     */
+    class FileState {
+    private:
+        std::string _path;
+        bool        _exists;
+        int64_t     _seconds;
+        int64_t     _nanoseconds;
+        uint64_t    _size;
+
+    public:
+        FileState(std::string const &path, bool exists, int64_t seconds, int64_t nanoseconds, uint64_t size);
+
+    public:
+        std::string const &path() const
+        { return _path; }
+        bool exists() const
+        { return _exists; }
+
+    public:
+        /*
+         * The modification time and size of the file, if it exists.
+         */
+        int64_t seconds() const
+        { return _seconds; }
+        int64_t nanoseconds() const
+        { return _nanoseconds; }
+        uint64_t size() const
+        { return _size; }
+
+    public:
+        bool operator==(FileState const &rhs) const;
+        bool operator!=(FileState const &rhs) const;
+
+    public:
+        /*
+         * Read the current state of a file.
+         */
+        static FileState
+        Current(std::string const &path);
+    };
+
+    /*
+     * What an invocation ran with, the last time it succeeded.
+     */
+    class Entry {
+    private:
+        std::string            _signature;
+        std::vector<FileState> _inputs;
+        std::vector<FileState> _outputs;
+        uint64_t               _duration;
+
+    public:
+        Entry(std::string const &signature, std::vector<FileState> const &inputs, std::vector<FileState> const &outputs, uint64_t duration);
+
+    public:
+        /*
+         * Identifies the command, arguments, and environment of the invocation.
+         */
+        std::string const &signature() const
+        { return _signature; }
+
+        /*
+         * The declared and discovered inputs of the invocation.
+         */
+        std::vector<FileState> const &inputs() const
+        { return _inputs; }
+
+        /*
+         * The outputs of the invocation.
+         */
+        std::vector<FileState> const &outputs() const
+        { return _outputs; }
+
+        /*
+         * How long the invocation took to run, in milliseconds.
+         */
+        uint64_t duration() const
+        { return _duration; }
+
+    public:
+        /*
+         * If the invocation has the same signature, and the recorded inputs
+         * and outputs are all unchanged.
+         */
+        bool upToDate(pbxbuild::Tool::Invocation const &invocation) const;
+
+    public:
+        /*
+         * Record an invocation after it has run. Reads the dependency info
+         * the invocation wrote to find inputs it didn't declare.
+         */
+        static Entry
+        Create(libutil::Filesystem const *filesystem, pbxbuild::Tool::Invocation const &invocation, uint64_t duration);
+    };
+
+private:
+    std::unordered_map<std::string, Entry> _entries;
+
+public:
+    BuildDatabase();
+    ~BuildDatabase();
+
+public:
+    /*
+     * The recorded invocations, by key.
+     */
+    std::unordered_map<std::string, Entry> const &entries() const
+    { return _entries; }
+
+public:
+    /*
+     * The recorded entry for an invocation, if any.
+     */
+    Entry const *entry(pbxbuild::Tool::Invocation const &invocation) const;
+
+public:
+    /*
+     * Record an invocation that succeeded.
+     */
+    void insert(pbxbuild::Tool::Invocation const &invocation, Entry const &entry);
+
+    /*
+     * Forget an invocation, so it runs in the next build.
+     */
+    void remove(pbxbuild::Tool::Invocation const &invocation);
+
+    /*
+     * Forget any invocations not in the provided set of keys.
+     */
+    void retain(std::unordered_set<std::string> const &keys);
+
+public:
+    /*
+     * Serialize the database.
+     */
+    std::vector<uint8_t> serialize() const;
+
+    /*
+     * Load a database from serialized contents. Fails if the contents are
+     * invalid or from a different version.
+     */
+    static ext::optional<BuildDatabase>
+    Deserialize(std::vector<uint8_t> const &contents);
+
+public:
+    /*
+     * The key for an invocation in the database. Invocations without any
+     * outputs have no key and are never considered up to date.
+     */
+    static ext::optional<std::string>
+    Key(pbxbuild::Tool::Invocation const &invocation);
+
+    /*
+     * The signature for an invocation. Changes if anything about how the
+     * invocation runs changes.
+     */
+    static std::string
+    Signature(pbxbuild::Tool::Invocation const &invocation);
+};
+
+}
+
+#endif // !__xcexecution_BuildDatabase_h
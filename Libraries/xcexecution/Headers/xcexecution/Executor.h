@@ -36,9 +36,10 @@ protected:
     std::shared_ptr<xcformatter::Formatter> _formatter;
     bool                                    _dryRun;
     bool                                    _generate;
+    bool                                    _verbose;
 
 protected:
-    Executor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate);
+    Executor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate, bool verbose);
 
 public:
     virtual ~Executor();
@@ -51,6 +52,12 @@ public:
         libutil::Filesystem *filesystem,
         pbxbuild::Build::Environment const &buildEnvironment,
         Parameters const &buildParameters) = 0;
+
+protected:
+    /*
+     * When verbose, report how the build context's caches were used.
+     */
+    void printStatistics(pbxbuild::Build::Context const &buildContext) const;
 };
 
 }
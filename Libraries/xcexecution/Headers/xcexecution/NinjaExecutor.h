@@ -16,12 +16,19 @@ namespace ninja { class Writer; }
 
 namespace xcexecution {
 
+class ActionCache;
+
 /*
- * Concrete executor that generates Ninja files.
+ * Concrete executor that generates Ninja files. With an action cache,
+ * cacheable invocations are wrapped in a tool that restores their outputs
+ * from the cache or runs them and stores their outputs.
  */
 class NinjaExecutor : public Executor {
+private:
+    std::shared_ptr<ActionCache> _actionCache;
+
 public:
-    NinjaExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate);
+    NinjaExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate, bool verbose, std::shared_ptr<ActionCache> const &actionCache);
     ~NinjaExecutor();
 
 public:
@@ -54,11 +61,25 @@ private:
         libutil::Filesystem *filesystem,
         pbxproj::PBX::Target::shared_ptr const &target,
         pbxbuild::Target::Environment const &targetEnvironment,
-        std::vector<pbxbuild::Tool::Invocation> const &invocations);
+        std::vector<pbxbuild::Tool::Invocation> const &invocations,
+        std::unordered_map<std::string, uint64_t> const &durations);
+
+public:
+    /*
+     * Write the rules and build statements for a target's invocations. Each
+     * build waits for the target's begin output; generated files such as
+     * converted dependency info go in the temporary directory.
+     */
+    bool buildInvocations(
+        ninja::Writer *writer,
+        std::string const &targetBegin,
+        std::string const &temporaryDirectory,
+        std::vector<pbxbuild::Tool::Invocation> const &invocations,
+        std::unordered_map<std::string, uint64_t> const &durations) const;
 
 public:
     static std::unique_ptr<NinjaExecutor>
-    Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate);
+    Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate, bool verbose, std::shared_ptr<ActionCache> const &actionCache);
 };
 
 }
@@ -15,16 +15,30 @@
 
 namespace xcexecution {
 
+class ActionCache;
+class BuildDatabase;
+
 /*
- * Simple executor that simply runs invocations in sequence. Advanced features
- * like incremental builds, dependency info, and such are not supported.
+ * Simple executor that runs the invocations of each target, starting each
+ * one once the invocations producing its inputs have finished. Targets are
+ * built in order, or concurrently once their dependencies are built if
+ * `parallelizeTargets` is set. Invocations are skipped when they and their
+ * inputs and outputs are unchanged since they last ran. With an action
+ * cache, cacheable invocations restore their outputs from the cache when
+ * possible, and store their outputs after they run.
  */
 class SimpleExecutor : public Executor {
 private:
-    builtin::Registry _builtins;
+    class Jobs;
+
+private:
+    builtin::Registry            _builtins;
+    size_t                       _jobs;
+    bool                         _parallelizeTargets;
+    std::shared_ptr<ActionCache> _actionCache;
 
 public:
-    SimpleExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins);
+    SimpleExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool verbose, builtin::Registry const &builtins, size_t jobs, bool parallelizeTargets, std::shared_ptr<ActionCache> const &actionCache);
     ~SimpleExecutor();
 
 public:
@@ -34,26 +48,47 @@ public:
         Parameters const &buildParameters);
 
 private:
+    std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> resolveAndBuildTarget(
+        libutil::Filesystem *filesystem,
+        pbxbuild::Build::Environment const &buildEnvironment,
+        pbxbuild::Build::Context const &buildContext,
+        pbxproj::PBX::Target::shared_ptr const &target,
+        Jobs *jobs,
+        std::string *output);
     bool writeAuxiliaryFiles(
         libutil::Filesystem *filesystem,
         pbxproj::PBX::Target::shared_ptr const &target,
         pbxbuild::Target::Environment const &targetEnvironment,
-        std::vector<pbxbuild::Tool::Invocation> const &invocations);
+        std::vector<pbxbuild::Tool::Invocation> const &invocations,
+        std::string *output);
+    bool performInvocation(
+        libutil::Filesystem *filesystem,
+        pbxbuild::Tool::Invocation const &invocation);
     std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> performInvocations(
         libutil::Filesystem *filesystem,
         pbxproj::PBX::Target::shared_ptr const &target,
         pbxbuild::Target::Environment const &targetEnvironment,
         std::vector<pbxbuild::Tool::Invocation> const &orderedInvocations,
-        bool createProductStructure);
+        bool createProductStructure,
+        BuildDatabase *database,
+        Jobs *jobs,
+        std::string *output);
     std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> buildTarget(
         libutil::Filesystem *filesystem,
         pbxproj::PBX::Target::shared_ptr const &target,
         pbxbuild::Target::Environment const &targetEnvironment,
-        std::vector<pbxbuild::Tool::Invocation> const &invocations);
+        std::vector<pbxbuild::Tool::Invocation> const &invocations,
+        Jobs *jobs,
+        std::string *output);
 
 public:
+    /*
+     * Create a simple executor. Up to `jobs` invocations run at once across
+     * all targets; zero uses the number of processors. The action cache
+     * is optional.
+     */
     static std::unique_ptr<SimpleExecutor>
-    Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins);
+    Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool verbose, builtin::Registry const &builtins, size_t jobs, bool parallelizeTargets, std::shared_ptr<ActionCache> const &actionCache);
 };
 
 }
@@ -0,0 +1,364 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <xcexecution/ActionCache.h>
+#include <libutil/DefaultFilesystem.h>
+#include <libutil/FSUtil.h>
+#include <libutil/Hash.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <map>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+using xcexecution::ActionCache;
+using libutil::DefaultFilesystem;
+using libutil::FSUtil;
+using libutil::Hash;
+
+ActionCache::
+ActionCache(std::string const &path, uint64_t sizeLimit) :
+    _path     (path),
+    _sizeLimit(sizeLimit),
+    _hits     (0),
+    _misses   (0)
+{
+}
+
+ActionCache::
+~ActionCache()
+{
+}
+
+/*
+ * Changed whenever the key or entry layout changes, so older entries
+ * are never used.
+ */
+static std::string const CacheVersion = "xcbuild-action-cache-2";
+
+static void
+AppendKey(Hash *hash, std::string const &string)
+{
+    std::string size = std::to_string(string.size()) + ":";
+    hash->update(size);
+    hash->update(string);
+}
+
+ext::optional<std::string> ActionCache::
+key(
+    std::string const &executable,
+    std::vector<std::string> const &arguments,
+    std::unordered_map<std::string, std::string> const &environment,
+    std::string const &workingDirectory,
+    std::vector<std::string> const &inputs) const
+{
+    Hash hash;
+
+    AppendKey(&hash, CacheVersion);
+
+    /*
+     * Hashing the tool itself would be too slow, so its size and modification
+     * time stand in for its contents. Installing a new version changes both.
+     */
+    struct stat st;
+    if (::stat(executable.c_str(), &st) != 0) {
+        return ext::nullopt;
+    }
+
+#if defined(__APPLE__)
+    struct timespec modificationTime = st.st_mtimespec;
+#else
+    struct timespec modificationTime = st.st_mtim;
+#endif
+
+    AppendKey(&hash, executable);
+    AppendKey(&hash, std::to_string(st.st_size));
+    AppendKey(&hash, std::to_string(modificationTime.tv_sec) + "." + std::to_string(modificationTime.tv_nsec));
+
+    AppendKey(&hash, std::to_string(arguments.size()));
+    for (std::string const &argument : arguments) {
+        AppendKey(&hash, argument);
+    }
+
+    /* Environment order is unspecified, so sort it first. */
+    std::map<std::string, std::string> sortedEnvironment = std::map<std::string, std::string>(environment.begin(), environment.end());
+    AppendKey(&hash, std::to_string(sortedEnvironment.size()));
+    for (auto const &variable : sortedEnvironment) {
+        AppendKey(&hash, variable.first);
+        AppendKey(&hash, variable.second);
+    }
+
+    AppendKey(&hash, workingDirectory);
+
+    AppendKey(&hash, std::to_string(inputs.size()));
+    for (std::string const &input : inputs) {
+        std::string path = FSUtil::ResolveRelativePath(input, workingDirectory);
+        AppendKey(&hash, path);
+
+        if (!hash.updateFile(path)) {
+            return ext::nullopt;
+        }
+    }
+
+    return hash.hex();
+}
+
+ext::optional<std::string> ActionCache::
+key(pbxbuild::Tool::Invocation const &invocation) const
+{
+    std::vector<std::string> inputs;
+    inputs.insert(inputs.end(), invocation.inputs().begin(), invocation.inputs().end());
+    inputs.insert(inputs.end(), invocation.inputDependencies().begin(), invocation.inputDependencies().end());
+
+    /* Auxiliary files are read by the invocation even if not declared. */
+    for (pbxbuild::Tool::Invocation::AuxiliaryFile const &auxiliaryFile : invocation.auxiliaryFiles()) {
+        inputs.push_back(auxiliaryFile.path());
+    }
+
+    return key(invocation.executable().path(), invocation.arguments(), invocation.environment(), invocation.workingDirectory(), inputs);
+}
+
+static void
+RemoveEntry(std::string const &path)
+{
+    DIR *dir = ::opendir(path.c_str());
+    if (dir != nullptr) {
+        while (struct dirent *entry = ::readdir(dir)) {
+            if (entry->d_name[0] != '.') {
+                ::unlink((path + "/" + entry->d_name).c_str());
+            }
+        }
+        ::closedir(dir);
+    }
+
+    ::rmdir(path.c_str());
+}
+
+static std::string
+EntryPath(std::string const &cache, std::string const &key)
+{
+    return cache + "/objects/" + key.substr(0, 2) + "/" + key;
+}
+
+/*
+ * Update the shared hit and miss counts. Locked, since many processes
+ * can use the same cache at once.
+ */
+static void
+RecordStatistics(std::string const &cache, bool hit)
+{
+    /* The first lookup in a new cache is a miss before anything is stored. */
+    if (!DefaultFilesystem().createDirectory(cache)) {
+        return;
+    }
+
+    int fd = ::open((cache + "/statistics").c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return;
+    }
+
+    if (::flock(fd, LOCK_EX) == 0) {
+        char buffer[64] = { };
+        ssize_t size = ::pread(fd, buffer, sizeof(buffer) - 1, 0);
+
+        unsigned long long hits = 0, misses = 0;
+        if (size > 0) {
+            ::sscanf(buffer, "%llu %llu", &hits, &misses);
+        }
+
+        if (hit) {
+            hits++;
+        } else {
+            misses++;
+        }
+
+        int length = ::snprintf(buffer, sizeof(buffer), "%llu %llu\n", hits, misses);
+        if (::ftruncate(fd, 0) == 0) {
+            (void)::pwrite(fd, buffer, length, 0);
+        }
+
+        ::flock(fd, LOCK_UN);
+    }
+
+    ::close(fd);
+}
+
+bool ActionCache::
+restore(std::string const &key, std::vector<std::string> const &outputs)
+{
+    std::string entry = EntryPath(_path, key);
+
+    bool hit = !outputs.empty();
+    for (size_t n = 0; hit && n < outputs.size(); n++) {
+        hit = (::access((entry + "/" + std::to_string(n)).c_str(), R_OK) == 0);
+    }
+
+    DefaultFilesystem filesystem;
+    for (size_t n = 0; hit && n < outputs.size(); n++) {
+        hit = (filesystem.createDirectory(FSUtil::GetDirectoryName(outputs[n])) && filesystem.copyFile(entry + "/" + std::to_string(n), outputs[n]));
+    }
+
+    if (hit) {
+        /* Mark the entry as recently used. */
+        ::utimes(entry.c_str(), nullptr);
+        _hits++;
+    } else {
+        _misses++;
+    }
+
+    RecordStatistics(_path, hit);
+    return hit;
+}
+
+bool ActionCache::
+store(std::string const &key, std::vector<std::string> const &outputs)
+{
+    if (outputs.empty()) {
+        return false;
+    }
+
+    DefaultFilesystem filesystem;
+
+    /*
+     * Fill in the entry under a unique name, then move it into place. Other
+     * processes never see a partial entry.
+     */
+    static std::atomic<uint64_t> counter(0);
+    std::string temporary = _path + "/tmp/" + key + "." + std::to_string(::getpid()) + "." + std::to_string(counter++);
+    if (!filesystem.createDirectory(temporary)) {
+        return false;
+    }
+
+    for (size_t n = 0; n < outputs.size(); n++) {
+        if (!filesystem.copyFile(outputs[n], temporary + "/" + std::to_string(n))) {
+            RemoveEntry(temporary);
+            return false;
+        }
+    }
+
+    std::string entry = EntryPath(_path, key);
+    if (!filesystem.createDirectory(FSUtil::GetDirectoryName(entry)) || ::rename(temporary.c_str(), entry.c_str()) != 0) {
+        /* Most likely already cached by someone else. */
+        RemoveEntry(temporary);
+        return (errno == EEXIST || errno == ENOTEMPTY);
+    }
+
+    return true;
+}
+
+void ActionCache::
+trim()
+{
+    struct Entry {
+        std::string path;
+        time_t      used;
+        uint64_t    size;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+
+    std::string objects = _path + "/objects";
+    FSUtil::EnumerateDirectory(objects, [&](std::string const &prefix) -> bool {
+        std::string prefixPath = objects + "/" + prefix;
+        FSUtil::EnumerateDirectory(prefixPath, [&](std::string const &key) -> bool {
+            Entry entry = { prefixPath + "/" + key, 0, 0 };
+
+            struct stat st;
+            if (::stat(entry.path.c_str(), &st) != 0) {
+                return true;
+            }
+            entry.used = st.st_mtime;
+
+            FSUtil::EnumerateDirectory(entry.path, [&](std::string const &file) -> bool {
+                struct stat fst;
+                if (::stat((entry.path + "/" + file).c_str(), &fst) == 0) {
+                    entry.size += fst.st_size;
+                }
+                return true;
+            });
+
+            total += entry.size;
+            entries.push_back(entry);
+            return true;
+        });
+        return true;
+    });
+
+    if (total <= _sizeLimit) {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](Entry const &a, Entry const &b) {
+        return a.used < b.used;
+    });
+
+    for (Entry const &entry : entries) {
+        if (total <= _sizeLimit) {
+            break;
+        }
+
+        RemoveEntry(entry.path);
+        total -= entry.size;
+    }
+}
+
+bool ActionCache::
+statistics(size_t *hits, size_t *misses) const
+{
+    std::vector<uint8_t> contents;
+    if (!DefaultFilesystem().read(&contents, _path + "/statistics")) {
+        return false;
+    }
+
+    std::string string = std::string(contents.begin(), contents.end());
+    unsigned long long readHits = 0, readMisses = 0;
+    if (::sscanf(string.c_str(), "%llu %llu", &readHits, &readMisses) != 2) {
+        return false;
+    }
+
+    *hits = readHits;
+    *misses = readMisses;
+    return true;
+}
+
+bool ActionCache::
+Cacheable(pbxbuild::Tool::Invocation const &invocation)
+{
+    // TODO(grp): This should perhaps be a separate flag for a 'phony' invocation.
+    if (invocation.executable().path().empty() || invocation.createsProductStructure()) {
+        return false;
+    }
+
+    /* Without outputs there is nothing to restore. */
+    if (invocation.outputs().empty()) {
+        return false;
+    }
+
+    /* Inputs found while running aren't known in advance to be in the key. */
+    if (!invocation.dependencyInfo().empty() || !invocation.phonyInputs().empty()) {
+        return false;
+    }
+
+    return true;
+}
+
+uint64_t ActionCache::
+DefaultSizeLimit()
+{
+    return 10ULL * 1024 * 1024 * 1024;
+}
@@ -0,0 +1,414 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <xcexecution/BuildDatabase.h>
+#include <dependency/DependencyInfo.h>
+#include <dependency/BinaryDependencyInfo.h>
+#include <dependency/DirectoryDependencyInfo.h>
+#include <dependency/MakefileDependencyInfo.h>
+#include <libutil/Filesystem.h>
+#include <libutil/FSUtil.h>
+#include <libutil/Hash.h>
+
+#include <algorithm>
+#include <map>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+using xcexecution::BuildDatabase;
+using libutil::Filesystem;
+using libutil::FSUtil;
+using libutil::Hash;
+
+BuildDatabase::FileState::
+FileState(std::string const &path, bool exists, int64_t seconds, int64_t nanoseconds, uint64_t size) :
+    _path       (path),
+    _exists     (exists),
+    _seconds    (seconds),
+    _nanoseconds(nanoseconds),
+    _size       (size)
+{
+}
+
+bool BuildDatabase::FileState::
+operator==(FileState const &rhs) const
+{
+    return _path == rhs._path && _exists == rhs._exists && _seconds == rhs._seconds && _nanoseconds == rhs._nanoseconds && _size == rhs._size;
+}
+
+bool BuildDatabase::FileState::
+operator!=(FileState const &rhs) const
+{
+    return !(*this == rhs);
+}
+
+BuildDatabase::FileState BuildDatabase::FileState::
+Current(std::string const &path)
+{
+    // FIXME: This should use the filesystem.
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return FileState(path, false, 0, 0, 0);
+    }
+
+#if defined(__APPLE__)
+    struct timespec modificationTime = st.st_mtimespec;
+#else
+    struct timespec modificationTime = st.st_mtim;
+#endif
+
+    return FileState(path, true, modificationTime.tv_sec, modificationTime.tv_nsec, st.st_size);
+}
+
+BuildDatabase::Entry::
+Entry(std::string const &signature, std::vector<FileState> const &inputs, std::vector<FileState> const &outputs, uint64_t duration) :
+    _signature(signature),
+    _inputs   (inputs),
+    _outputs  (outputs),
+    _duration (duration)
+{
+}
+
+static void
+AddDependencyInfo(Filesystem const *filesystem, pbxbuild::Tool::Invocation::DependencyInfo const &dependencyInfo, std::vector<std::string> *inputs)
+{
+    std::vector<dependency::DependencyInfo> info;
+
+    if (dependencyInfo.format() == dependency::DependencyInfoFormat::Binary) {
+        std::vector<uint8_t> contents;
+        if (filesystem->read(&contents, dependencyInfo.path())) {
+            if (auto binaryInfo = dependency::BinaryDependencyInfo::Deserialize(contents)) {
+                info.push_back(binaryInfo->dependencyInfo());
+            }
+        }
+    } else if (dependencyInfo.format() == dependency::DependencyInfoFormat::Directory) {
+        if (auto directoryInfo = dependency::DirectoryDependencyInfo::Deserialize(filesystem, dependencyInfo.path())) {
+            info.push_back(directoryInfo->dependencyInfo());
+        }
+    } else if (dependencyInfo.format() == dependency::DependencyInfoFormat::Makefile) {
+        std::vector<uint8_t> contents;
+        if (filesystem->read(&contents, dependencyInfo.path())) {
+            if (auto makefileInfo = dependency::MakefileDependencyInfo::Deserialize(std::string(contents.begin(), contents.end()))) {
+                info.insert(info.end(), makefileInfo->dependencyInfo().begin(), makefileInfo->dependencyInfo().end());
+            }
+        }
+    }
+
+    for (dependency::DependencyInfo const &entry : info) {
+        inputs->insert(inputs->end(), entry.inputs().begin(), entry.inputs().end());
+    }
+}
+
+BuildDatabase::Entry BuildDatabase::Entry::
+Create(Filesystem const *filesystem, pbxbuild::Tool::Invocation const &invocation, uint64_t duration)
+{
+    std::vector<std::string> inputPaths;
+    inputPaths.insert(inputPaths.end(), invocation.inputs().begin(), invocation.inputs().end());
+    inputPaths.insert(inputPaths.end(), invocation.inputDependencies().begin(), invocation.inputDependencies().end());
+
+    /*
+     * Missing or unreadable dependency info just means fewer inputs are
+     * known, which is no different from a tool that doesn't write any.
+     */
+    for (pbxbuild::Tool::Invocation::DependencyInfo const &dependencyInfo : invocation.dependencyInfo()) {
+        AddDependencyInfo(filesystem, dependencyInfo, &inputPaths);
+    }
+
+    std::vector<FileState> inputs;
+    std::unordered_set<std::string> seen;
+    for (std::string const &input : inputPaths) {
+        std::string path = FSUtil::ResolveRelativePath(input, invocation.workingDirectory());
+        if (seen.insert(path).second) {
+            inputs.push_back(FileState::Current(path));
+        }
+    }
+
+    std::vector<FileState> outputs;
+    for (std::string const &output : invocation.outputs()) {
+        outputs.push_back(FileState::Current(FSUtil::ResolveRelativePath(output, invocation.workingDirectory())));
+    }
+
+    return Entry(Signature(invocation), inputs, outputs, duration);
+}
+
+bool BuildDatabase::Entry::
+upToDate(pbxbuild::Tool::Invocation const &invocation) const
+{
+    if (_signature != Signature(invocation)) {
+        return false;
+    }
+
+    for (FileState const &output : _outputs) {
+        /* A missing output always needs to be created. */
+        if (!output.exists() || FileState::Current(output.path()) != output) {
+            return false;
+        }
+    }
+
+    for (FileState const &input : _inputs) {
+        if (FileState::Current(input.path()) != input) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+BuildDatabase::
+BuildDatabase()
+{
+}
+
+BuildDatabase::
+~BuildDatabase()
+{
+}
+
+BuildDatabase::Entry const *BuildDatabase::
+entry(pbxbuild::Tool::Invocation const &invocation) const
+{
+    ext::optional<std::string> key = Key(invocation);
+    if (!key) {
+        return nullptr;
+    }
+
+    auto it = _entries.find(*key);
+    if (it == _entries.end()) {
+        return nullptr;
+    }
+
+    return &it->second;
+}
+
+void BuildDatabase::
+insert(pbxbuild::Tool::Invocation const &invocation, Entry const &entry)
+{
+    if (ext::optional<std::string> key = Key(invocation)) {
+        _entries.erase(*key);
+        _entries.insert({ *key, entry });
+    }
+}
+
+void BuildDatabase::
+remove(pbxbuild::Tool::Invocation const &invocation)
+{
+    if (ext::optional<std::string> key = Key(invocation)) {
+        _entries.erase(*key);
+    }
+}
+
+void BuildDatabase::
+retain(std::unordered_set<std::string> const &keys)
+{
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (keys.find(it->first) == keys.end()) {
+            it = _entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/*
+ * Changed whenever the serialized format changes. Databases written with
+ * another version are discarded, so everything runs once.
+ */
+static std::string const DatabaseVersion = "xcbuild-simple-database-2";
+
+static void
+WriteInteger(std::vector<uint8_t> *result, uint64_t value)
+{
+    for (size_t n = 0; n < sizeof(value); n++) {
+        result->push_back(static_cast<uint8_t>(value >> (n * 8)));
+    }
+}
+
+static void
+WriteString(std::vector<uint8_t> *result, std::string const &string)
+{
+    WriteInteger(result, string.size());
+    result->insert(result->end(), string.begin(), string.end());
+}
+
+static void
+WriteFileStates(std::vector<uint8_t> *result, std::vector<BuildDatabase::FileState> const &fileStates)
+{
+    WriteInteger(result, fileStates.size());
+    for (BuildDatabase::FileState const &fileState : fileStates) {
+        WriteString(result, fileState.path());
+        WriteInteger(result, fileState.exists() ? 1 : 0);
+        WriteInteger(result, static_cast<uint64_t>(fileState.seconds()));
+        WriteInteger(result, static_cast<uint64_t>(fileState.nanoseconds()));
+        WriteInteger(result, fileState.size());
+    }
+}
+
+std::vector<uint8_t> BuildDatabase::
+serialize() const
+{
+    std::vector<uint8_t> result;
+    WriteString(&result, DatabaseVersion);
+
+    /* Sort entries so the same database always serializes the same way. */
+    std::map<std::string, Entry const *> sorted;
+    for (auto const &entry : _entries) {
+        sorted.insert({ entry.first, &entry.second });
+    }
+
+    WriteInteger(&result, sorted.size());
+    for (auto const &entry : sorted) {
+        WriteString(&result, entry.first);
+        WriteString(&result, entry.second->signature());
+        WriteFileStates(&result, entry.second->inputs());
+        WriteFileStates(&result, entry.second->outputs());
+        WriteInteger(&result, entry.second->duration());
+    }
+
+    return result;
+}
+
+static bool
+ReadInteger(std::vector<uint8_t> const &contents, size_t *offset, uint64_t *value)
+{
+    if (contents.size() - *offset < sizeof(*value)) {
+        return false;
+    }
+
+    *value = 0;
+    for (size_t n = 0; n < sizeof(*value); n++) {
+        *value |= static_cast<uint64_t>(contents[*offset + n]) << (n * 8);
+    }
+    *offset += sizeof(*value);
+    return true;
+}
+
+static bool
+ReadString(std::vector<uint8_t> const &contents, size_t *offset, std::string *value)
+{
+    uint64_t size;
+    if (!ReadInteger(contents, offset, &size) || contents.size() - *offset < size) {
+        return false;
+    }
+
+    *value = std::string(contents.begin() + *offset, contents.begin() + *offset + size);
+    *offset += size;
+    return true;
+}
+
+static bool
+ReadFileStates(std::vector<uint8_t> const &contents, size_t *offset, std::vector<BuildDatabase::FileState> *value)
+{
+    uint64_t count;
+    if (!ReadInteger(contents, offset, &count)) {
+        return false;
+    }
+
+    for (uint64_t n = 0; n < count; n++) {
+        std::string path;
+        uint64_t exists, seconds, nanoseconds, size;
+        if (!ReadString(contents, offset, &path) || !ReadInteger(contents, offset, &exists) || !ReadInteger(contents, offset, &seconds) || !ReadInteger(contents, offset, &nanoseconds) || !ReadInteger(contents, offset, &size)) {
+            return false;
+        }
+
+        value->push_back(BuildDatabase::FileState(path, exists != 0, static_cast<int64_t>(seconds), static_cast<int64_t>(nanoseconds), size));
+    }
+
+    return true;
+}
+
+ext::optional<BuildDatabase> BuildDatabase::
+Deserialize(std::vector<uint8_t> const &contents)
+{
+    size_t offset = 0;
+
+    std::string version;
+    if (!ReadString(contents, &offset, &version) || version != DatabaseVersion) {
+        return ext::nullopt;
+    }
+
+    uint64_t count;
+    if (!ReadInteger(contents, &offset, &count)) {
+        return ext::nullopt;
+    }
+
+    BuildDatabase database;
+    for (uint64_t n = 0; n < count; n++) {
+        std::string key;
+        std::string signature;
+        std::vector<FileState> inputs;
+        std::vector<FileState> outputs;
+        uint64_t duration;
+
+        if (!ReadString(contents, &offset, &key) || !ReadString(contents, &offset, &signature) || !ReadFileStates(contents, &offset, &inputs) || !ReadFileStates(contents, &offset, &outputs) || !ReadInteger(contents, &offset, &duration)) {
+            return ext::nullopt;
+        }
+
+        database._entries.insert({ key, Entry(signature, inputs, outputs, duration) });
+    }
+
+    if (offset != contents.size()) {
+        return ext::nullopt;
+    }
+
+    return database;
+}
+
+ext::optional<std::string> BuildDatabase::
+Key(pbxbuild::Tool::Invocation const &invocation)
+{
+    if (invocation.outputs().empty()) {
+        return ext::nullopt;
+    }
+
+    std::string key;
+    for (std::string const &output : invocation.outputs()) {
+        key += output;
+        key += '\0';
+    }
+    return key;
+}
+
+static void
+AppendSignature(std::string *signature, std::string const &string)
+{
+    *signature += std::to_string(string.size());
+    *signature += ':';
+    *signature += string;
+}
+
+std::string BuildDatabase::
+Signature(pbxbuild::Tool::Invocation const &invocation)
+{
+    std::string signature;
+
+    AppendSignature(&signature, invocation.executable().path());
+    AppendSignature(&signature, invocation.executable().builtin());
+    AppendSignature(&signature, invocation.workingDirectory());
+
+    for (std::string const &argument : invocation.arguments()) {
+        AppendSignature(&signature, argument);
+    }
+
+    /* Environment order is unspecified, so sort it first. */
+    std::map<std::string, std::string> sortedEnvironment = std::map<std::string, std::string>(invocation.environment().begin(), invocation.environment().end());
+    for (auto const &variable : sortedEnvironment) {
+        AppendSignature(&signature, variable.first);
+        AppendSignature(&signature, variable.second);
+    }
+
+    for (std::vector<std::string> const *paths : { &invocation.inputs(), &invocation.outputs(), &invocation.inputDependencies() }) {
+        for (std::string const &path : *paths) {
+            AppendSignature(&signature, path);
+        }
+        signature += ';';
+    }
+
+    return Hash::Hex(signature);
+}
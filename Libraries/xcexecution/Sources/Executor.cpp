@@ -8,14 +8,16 @@
  */
 
 #include <xcexecution/Executor.h>
+#include <pbxbuild/Build/Context.h>
 
 using xcexecution::Executor;
 
 Executor::
-Executor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate) :
+Executor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate, bool verbose) :
     _formatter(formatter),
     _dryRun   (dryRun),
-    _generate (generate)
+    _generate (generate),
+    _verbose  (verbose)
 {
 }
 
@@ -23,3 +25,13 @@ Executor::
 ~Executor()
 {
 }
+
+void Executor::
+printStatistics(pbxbuild::Build::Context const &buildContext) const
+{
+    if (!_verbose) {
+        return;
+    }
+
+    fprintf(stderr, "Target environments: %zu created, %zu reused\n", buildContext.targetEnvironmentsCreated(), buildContext.targetEnvironmentsReused());
+}
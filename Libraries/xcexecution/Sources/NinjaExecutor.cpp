@@ -10,34 +10,44 @@
 #include <xcexecution/NinjaExecutor.h>
 
 #include <xcexecution/Parameters.h>
+#include <xcexecution/ActionCache.h>
 #include <pbxbuild/Phase/Environment.h>
 #include <pbxbuild/Phase/PhaseInvocations.h>
 #include <ninja/Writer.h>
 #include <ninja/Value.h>
+#include <libutil/CachingFilesystem.h>
 #include <libutil/Escape.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
 #include <libutil/Subprocess.h>
 #include <libutil/SysUtil.h>
-#include <libutil/md5.h>
+#include <libutil/Hash.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
 #include <sstream>
-#include <iomanip>
+#include <thread>
 
 #include <sys/types.h>
 #include <sys/stat.h>
 
 using xcexecution::NinjaExecutor;
 using xcexecution::Parameters;
+using xcexecution::ActionCache;
 using libutil::Escape;
+using libutil::CachingFilesystem;
 using libutil::Filesystem;
 using libutil::FSUtil;
+using libutil::Hash;
 using libutil::Subprocess;
 using libutil::SysUtil;
 
 NinjaExecutor::
-NinjaExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate) :
-    Executor(formatter, dryRun, generate)
+NinjaExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate, bool verbose, std::shared_ptr<ActionCache> const &actionCache) :
+    Executor    (formatter, dryRun, generate, verbose),
+    _actionCache(actionCache)
 {
 }
 
@@ -73,9 +83,32 @@ TargetNinjaPath(pbxproj::PBX::Target::shared_ptr const &target, pbxbuild::Target
 }
 
 static std::string
-NinjaRuleName()
+NinjaRuleName(std::string const &executable, size_t index)
 {
-    return "invoke";
+    /* Name the rule after the tool, limited to what Ninja allows in a name. */
+    std::string name = FSUtil::GetBaseName(executable);
+    for (char &c : name) {
+        if (!isalnum(c) && c != '_' && c != '-' && c != '.') {
+            c = '_';
+        }
+    }
+
+    return name + "_" + std::to_string(index);
+}
+
+static size_t
+NinjaResponseFileThreshold()
+{
+    /* Shorter argument lists are cheaper to pass directly. */
+    return 8192;
+}
+
+static bool
+NinjaSupportsResponseFile(std::string const &executable)
+{
+    /* Only tools known to read arguments from @file can use a response file. */
+    std::string name = FSUtil::GetBaseName(executable);
+    return (name == "clang" || name == "clang++" || name == "swiftc");
 }
 
 static std::string
@@ -93,19 +126,7 @@ NinjaDescription(std::string const &description)
 static std::string
 NinjaHash(std::string const &input)
 {
-    md5_state_t state;
-    md5_init(&state);
-    md5_append(&state, reinterpret_cast<const md5_byte_t *>(input.data()), input.size());
-    uint8_t digest[16];
-    md5_finish(&state, reinterpret_cast<md5_byte_t *>(&digest));
-
-    std::ostringstream ss;
-    ss << std::hex << std::setfill('0');
-    for (uint8_t c : digest) {
-        ss << std::setw(2) << static_cast<int>(c);
-    }
-
-    return ss.str();
+    return Hash::Hex(input);
 }
 
 static std::string
@@ -144,6 +165,142 @@ NinjaInvocationOutputs(pbxbuild::Tool::Invocation const &invocation)
     return outputs;
 }
 
+/*
+ * Read how long each output took to build from Ninja's log. Ninja appends
+ * a line each time it builds an output, so the last line for one wins.
+ */
+static std::unordered_map<std::string, uint64_t>
+NinjaLogDurations(Filesystem const *filesystem, std::string const &path)
+{
+    std::unordered_map<std::string, uint64_t> durations;
+
+    std::vector<uint8_t> contents;
+    if (!filesystem->read(&contents, path)) {
+        return durations;
+    }
+
+    std::istringstream stream(std::string(contents.begin(), contents.end()));
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        /* Each line is: start, end, mtime, output, and command hash. */
+        std::vector<std::string> fields;
+        std::istringstream lineStream(line);
+        for (std::string field; std::getline(lineStream, field, '\t');) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 5) {
+            continue;
+        }
+
+        char *startEnd = nullptr;
+        char *endEnd = nullptr;
+        unsigned long long start = std::strtoull(fields[0].c_str(), &startEnd, 10);
+        unsigned long long end = std::strtoull(fields[1].c_str(), &endEnd, 10);
+        if (*startEnd != '\0' || *endEnd != '\0' || end < start) {
+            continue;
+        }
+
+        durations[fields[3]] = end - start;
+    }
+
+    return durations;
+}
+
+/*
+ * Order invocations so those on the longest path through the rest of the
+ * target come first. Ninja starts ready edges roughly in the order they are
+ * written, so this gets long chains going early. Invocations without any
+ * history are assumed to take an average amount of time, and ties keep the
+ * original order.
+ */
+static std::vector<size_t>
+NinjaCriticalPathOrder(std::vector<pbxbuild::Tool::Invocation const *> const &invocations, std::unordered_map<std::string, uint64_t> const &durations)
+{
+    std::unordered_map<std::string, size_t> outputToInvocation;
+    std::vector<ext::optional<uint64_t>> history;
+    uint64_t total = 0;
+    size_t known = 0;
+
+    for (size_t n = 0; n < invocations.size(); n++) {
+        ext::optional<uint64_t> duration;
+        for (std::string const &output : NinjaInvocationOutputs(*invocations[n])) {
+            outputToInvocation.insert({ output, n });
+
+            auto it = durations.find(output);
+            if (it != durations.end()) {
+                duration = std::max<uint64_t>(duration.value_or(0), it->second);
+            }
+        }
+
+        if (duration) {
+            total += *duration;
+            known++;
+        }
+        history.push_back(duration);
+    }
+
+    std::vector<uint64_t> costs;
+    for (ext::optional<uint64_t> const &duration : history) {
+        costs.push_back(duration ? *duration : (known != 0 ? total / known : 0));
+    }
+
+    std::vector<std::vector<size_t>> dependencies = std::vector<std::vector<size_t>>(invocations.size());
+    std::vector<size_t> remaining = std::vector<size_t>(invocations.size());
+    for (size_t n = 0; n < invocations.size(); n++) {
+        pbxbuild::Tool::Invocation const &invocation = *invocations[n];
+
+        std::unordered_set<size_t> seen;
+        for (std::vector<std::string> const *inputs : { &invocation.inputs(), &invocation.inputDependencies(), &invocation.orderDependencies() }) {
+            for (std::string const &input : *inputs) {
+                auto it = outputToInvocation.find(input);
+                if (it != outputToInvocation.end() && it->second != n && seen.insert(it->second).second) {
+                    dependencies[n].push_back(it->second);
+                    remaining[it->second]++;
+                }
+            }
+        }
+    }
+
+    /*
+     * Visit invocations after everything that depends on them. Invocations
+     * in a dependency cycle only count their own cost.
+     */
+    std::vector<uint64_t> priorities = costs;
+    std::vector<size_t> visit;
+    for (size_t n = 0; n < invocations.size(); n++) {
+        if (remaining[n] == 0) {
+            visit.push_back(n);
+        }
+    }
+
+    while (!visit.empty()) {
+        size_t index = visit.back();
+        visit.pop_back();
+
+        for (size_t dependency : dependencies[index]) {
+            priorities[dependency] = std::max(priorities[dependency], costs[dependency] + priorities[index]);
+            if (--remaining[dependency] == 0) {
+                visit.push_back(dependency);
+            }
+        }
+    }
+
+    std::vector<size_t> order;
+    for (size_t n = 0; n < invocations.size(); n++) {
+        order.push_back(n);
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&priorities](size_t a, size_t b) {
+        return priorities[a] > priorities[b];
+    });
+
+    return order;
+}
+
 static void
 WriteNinjaRegenerate(ninja::Writer *writer, Parameters const &buildParameters, std::string const &ninjaPath, std::string const &configurationHashPath, std::vector<std::string> const &inputPaths)
 {
@@ -169,7 +326,8 @@ WriteNinjaRegenerate(ninja::Writer *writer, Parameters const &buildParameters, s
      * Escape executable and input parameters for Ninja.
      */
     for (std::string const &arg : generateArguments) {
-        exec += " " + Escape::Shell(arg);
+        exec += " ";
+        Escape::Shell(arg, &exec);
     }
     std::vector<ninja::Value> inputPathValues;
     inputPathValues.push_back(ninja::Value::String(configurationHashPath));
@@ -190,11 +348,29 @@ WriteNinjaRegenerate(ninja::Writer *writer, Parameters const &buildParameters, s
         /* This command regenerates the Ninja files. */
         { "generator", ninja::Value::String("1") },
 
+        /* Unchanged Ninja files are not rewritten, so check if they changed. */
+        { "restat", ninja::Value::String("1") },
+
         /* Use the console pool to pass through terminal settings. */
         { "pool", ninja::Value::String("console") },
     });
 }
 
+static bool
+WriteIfChanged(Filesystem *filesystem, std::vector<uint8_t> const &contents, std::string const &path)
+{
+    /*
+     * Leave unchanged files alone. Rewriting them would update their
+     * modification time, making Ninja consider anything using them dirty.
+     */
+    std::vector<uint8_t> existing;
+    if (filesystem->read(&existing, path) && existing == contents) {
+        return true;
+    }
+
+    return filesystem->write(contents, path);
+}
+
 static bool
 WriteNinja(Filesystem *filesystem, ninja::Writer const &writer, std::string const &path)
 {
@@ -204,7 +380,7 @@ WriteNinja(Filesystem *filesystem, ninja::Writer const &writer, std::string cons
 
     std::string contents = writer.serialize();
     std::vector<uint8_t> copy = std::vector<uint8_t>(contents.begin(), contents.end());
-    if (!filesystem->write(copy, path)) {
+    if (!WriteIfChanged(filesystem, copy, path)) {
         return false;
     }
 
@@ -335,7 +511,7 @@ build(
          */
         std::string hashContents = buildParameters.canonicalHash();
         auto contents = std::vector<uint8_t>(hashContents.begin(), hashContents.end());
-        if (!filesystem->write(contents, configurationHashPath)) {
+        if (!WriteIfChanged(filesystem, contents, configurationHashPath)) {
             fprintf(stderr, "error: failed to generate ninja configuration hash\n");
             return false;
         }
@@ -439,22 +615,89 @@ buildAction(
     writer.newline();
 
     /*
-     * Since invocations are already resolved at this point, we can't use more specific
-     * rules at the Ninja level. Instead, add a single rule that just passes through from
-     * the build command that calls it.
+     * Build up a list of all of the inputs to the build, so Ninja can regenerate as necessary.
      */
-    writer.rule(NinjaRuleName(), ninja::Value::Expression("cd $dir && env -i $env $exec && $depexec"));
+    std::vector<std::string> inputPaths = buildContext.workspaceContext().loadedFilePaths();
 
     /*
-     * Build up a list of all of the inputs to the build, so Ninja can regenerate as necessary.
+     * Resolve each target and write out its Ninja file. Targets are independent at this
+     * point, so do this on a pool of threads; the results are combined in order below.
      */
-    std::vector<std::string> inputPaths = buildContext.workspaceContext().loadedFilePaths();
+    struct TargetResult {
+        ext::optional<pbxbuild::Target::Environment> targetEnvironment;
+        std::vector<pbxbuild::Tool::Invocation>      invocations;
+        bool                                         success;
+    };
+
+    std::vector<pbxproj::PBX::Target::shared_ptr> targets = std::vector<pbxproj::PBX::Target::shared_ptr>(targetGraph.nodes().begin(), targetGraph.nodes().end());
+
+    /*
+     * Sort the targets so the generated Ninja is the same each time, and is
+     * not rewritten when nothing changed.
+     */
+    std::sort(targets.begin(), targets.end(), [](pbxproj::PBX::Target::shared_ptr const &a, pbxproj::PBX::Target::shared_ptr const &b) {
+        return std::make_pair(a->name(), a->blueprintIdentifier()) < std::make_pair(b->name(), b->blueprintIdentifier());
+    });
+    std::vector<TargetResult> results = std::vector<TargetResult>(targets.size());
+
+    /*
+     * How long outputs took to build last time, to order the targets' invocations.
+     */
+    std::unordered_map<std::string, uint64_t> durations = NinjaLogDurations(filesystem, intermediatesDirectory + "/" + ".ninja_log");
+
+    std::atomic<size_t> next(0);
+
+    /*
+     * Resolution checks the same paths many times, and nothing is built while
+     * generating, so the answers can be shared between all of the targets.
+     */
+    CachingFilesystem resolveFilesystem(filesystem);
+
+    auto worker = [&]() {
+        for (size_t index = next++; index < targets.size(); index = next++) {
+            pbxproj::PBX::Target::shared_ptr const &target = targets[index];
+            TargetResult *result = &results[index];
+            result->success = false;
+
+            /*
+             * Resolve this target and generate its invocations.
+             */
+            result->targetEnvironment = buildContext.targetEnvironment(buildEnvironment, target);
+            if (!result->targetEnvironment) {
+                continue;
+            }
+
+            pbxbuild::Phase::Environment phaseEnvironment = pbxbuild::Phase::Environment(&resolveFilesystem, buildEnvironment, buildContext, target, *result->targetEnvironment);
+            pbxbuild::Phase::PhaseInvocations phaseInvocations = pbxbuild::Phase::PhaseInvocations::Create(phaseEnvironment, target);
+            result->invocations = phaseInvocations.invocations();
+
+            /*
+             * Write out the Ninja file to build this target.
+             */
+            result->success = buildTargetInvocations(filesystem, target, *result->targetEnvironment, result->invocations, durations);
+        }
+    };
+
+    size_t threads = std::min<size_t>(std::max<size_t>(1, std::thread::hardware_concurrency()), targets.size());
+
+    std::vector<std::thread> pool;
+    for (size_t n = 1; n < threads; n++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+
+    printStatistics(buildContext);
 
     /*
      * Go over each target and write out Ninja targets for the start and end of each.
      * Don't bother topologically sorting the targets now, since Ninja will do that for us.
      */
-    for (pbxproj::PBX::Target::shared_ptr const &target : targetGraph.nodes()) {
+    for (size_t index = 0; index < targets.size(); index++) {
+        pbxproj::PBX::Target::shared_ptr const &target = targets[index];
+        TargetResult const &result = results[index];
 
         /*
          * Beginning target depends on finishing the targets before that. This is implemented
@@ -473,18 +716,12 @@ buildAction(
          * previous targets.
          */
 
-        /*
-         * Resolve this target and generate its invocations.
-         */
-        ext::optional<pbxbuild::Target::Environment> targetEnvironment = buildContext.targetEnvironment(buildEnvironment, target);
+        ext::optional<pbxbuild::Target::Environment> const &targetEnvironment = result.targetEnvironment;
         if (!targetEnvironment) {
             fprintf(stderr, "error: couldn't create target environment for %s\n", target->name().c_str());
             continue;
         }
 
-        pbxbuild::Phase::Environment phaseEnvironment = pbxbuild::Phase::Environment(buildEnvironment, buildContext, target, *targetEnvironment);
-        pbxbuild::Phase::PhaseInvocations phaseInvocations = pbxbuild::Phase::PhaseInvocations::Create(phaseEnvironment, target);
-
         /*
          * As described above, the target's begin depends on all of the target dependencies.
          */
@@ -500,10 +737,7 @@ buildAction(
         std::string targetBegin = TargetNinjaBegin(target);
         writer.build({ ninja::Value::String(targetBegin) }, "phony", dependenciesFinished);
 
-        /*
-         * Write out the Ninja file to build this target.
-         */
-        if (!buildTargetInvocations(filesystem, target, *targetEnvironment, phaseInvocations.invocations())) {
+        if (!result.success) {
             fprintf(stderr, "error: failed to build target ninja\n");
             return false;
         }
@@ -518,7 +752,7 @@ buildAction(
          * As described above, the target's finish depends on all of the invocation outputs.
          */
         std::unordered_set<std::string> invocationOutputs;
-        for (pbxbuild::Tool::Invocation const &invocation : phaseInvocations.invocations()) {
+        for (pbxbuild::Tool::Invocation const &invocation : result.invocations) {
             if (invocation.executable().path().empty()) {
                 /* No outputs. */
                 continue;
@@ -534,7 +768,7 @@ buildAction(
          * However, avoid adding the phony invocation if a real output *does* include
          * the phony input, to avoid Ninja complaining about duplicate rules.
          */
-        for (pbxbuild::Tool::Invocation const &invocation : phaseInvocations.invocations()) {
+        for (pbxbuild::Tool::Invocation const &invocation : result.invocations) {
             for (std::string const &phonyInput : invocation.phonyInputs()) {
                 if (invocationOutputs.find(phonyInput) == invocationOutputs.end()) {
                     writer.build({ ninja::Value::String(phonyInput) }, "phony", { });
@@ -597,6 +831,18 @@ NinjaDependencyInfoExecutable()
     return LocalExecutable("dependency-info-tool");
 }
 
+static std::string
+NinjaActionCacheExecutable()
+{
+    return LocalExecutable("action-cache-tool");
+}
+
+static std::string
+NinjaBuiltinClientExecutable()
+{
+    return LocalExecutable("builtin-client");
+}
+
 bool NinjaExecutor::
 buildTargetAuxiliaryFiles(
     Filesystem *filesystem,
@@ -614,7 +860,7 @@ buildTargetAuxiliaryFiles(
                 return false;
             }
 
-            if (!filesystem->write(auxiliaryFile.contents(), auxiliaryFile.path())) {
+            if (!WriteIfChanged(filesystem, auxiliaryFile.contents(), auxiliaryFile.path())) {
                 fprintf(stderr, "error: failed to write auxiliary file: %s\n", auxiliaryFile.path().c_str());
                 return false;
             }
@@ -637,7 +883,8 @@ buildTargetInvocations(
     Filesystem *filesystem,
     pbxproj::PBX::Target::shared_ptr const &target,
     pbxbuild::Target::Environment const &targetEnvironment,
-    std::vector<pbxbuild::Tool::Invocation> const &invocations)
+    std::vector<pbxbuild::Tool::Invocation> const &invocations,
+    std::unordered_map<std::string, uint64_t> const &durations)
 {
     std::string targetBegin = TargetNinjaBegin(target);
 
@@ -657,61 +904,149 @@ buildTargetInvocations(
     }
 
     /*
-     * Add the build command for each invocation.
+     * Write out the invocations themselves.
+     */
+    std::string temporaryDirectory = targetEnvironment.environment().resolve("TARGET_TEMP_DIR");
+    if (!buildInvocations(&writer, targetBegin, temporaryDirectory, invocations, durations)) {
+        return false;
+    }
+
+    /*
+     * Serialize the Ninja file into the build root.
+     */
+    std::string path = TargetNinjaPath(target, targetEnvironment);
+    if (!WriteNinja(filesystem, writer, path)) {
+        fprintf(stderr, "error: unable to write target ninja: %s\n", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool NinjaExecutor::
+buildInvocations(
+    ninja::Writer *writer,
+    std::string const &targetBegin,
+    std::string const &temporaryDirectory,
+    std::vector<pbxbuild::Tool::Invocation> const &invocations,
+    std::unordered_map<std::string, uint64_t> const &durations) const
+{
+    /*
+     * Determine how to run each invocation. Arguments are escaped for the shell,
+     * as Ninja passes the command string directly to the shell, which would
+     * interpret spaces, etc as meaningful.
      */
+    struct NinjaCommand {
+        pbxbuild::Tool::Invocation const *invocation;
+        std::string                       exec;
+        std::string                       environment;
+        std::vector<std::string>          arguments;
+        std::string                       cacheExec;
+        std::string                       dependencyInfoExec;
+        std::string                       dependencyInfoFile;
+        bool                              dependencyDatabase;
+        bool                              responseFile;
+    };
+
+    std::vector<NinjaCommand> commands;
     for (pbxbuild::Tool::Invocation const &invocation : invocations) {
         // TODO(grp): This should perhaps be a separate flag for a 'phony' invocation.
         if (invocation.executable().path().empty()) {
             continue;
         }
 
+        NinjaCommand command;
+        command.invocation = &invocation;
+        command.exec = Escape::Shell(invocation.executable().path());
+
         /*
-         * Build the invocation arguments. Must escape for shell arguments as Ninja passes
-         * the command string directly to the shell, which would interpret spaces, etc as meaningful.
+         * Run builtin tools in the builtin server, rather than starting each tool
+         * as a separate process. The client falls back to the tool if needed.
          */
-        std::string exec = Escape::Shell(invocation.executable().path());
+        if (!invocation.executable().builtin().empty()) {
+            command.exec.clear();
+            Escape::Shell(NinjaBuiltinClientExecutable(), &command.exec);
+            command.exec += " ";
+            Escape::Shell(invocation.executable().builtin(), &command.exec);
+        }
+
+        size_t argumentsLength = 0;
+        command.arguments.reserve(invocation.arguments().size());
         for (std::string const &arg : invocation.arguments()) {
-            exec += " " + Escape::Shell(arg);
+            command.arguments.emplace_back();
+            Escape::Shell(arg, &command.arguments.back());
+            argumentsLength += command.arguments.back().size() + 1;
         }
 
+        /*
+         * Pass very long argument lists in a response file, for tools that support them.
+         */
+        command.responseFile = (argumentsLength > NinjaResponseFileThreshold() && NinjaSupportsResponseFile(invocation.executable().path()));
+
         /*
          * Build the invocation environment. To set the environment, we use standard shell syntax.
          * Use `env` to avoid Bash-specific limitations on environment variables. Specifically, some
          * versions of Bash don't allow setting "UID". Pass -i to clear out the environment.
          */
-        std::string environment;
         for (auto it = invocation.environment().begin(); it != invocation.environment().end(); ++it) {
             if (it != invocation.environment().begin()) {
-                environment += " ";
+                command.environment += " ";
             }
-            environment += it->first + "=" + Escape::Shell(it->second);
+            command.environment += it->first;
+            command.environment += "=";
+            Escape::Shell(it->second, &command.environment);
         }
 
         /*
-         * Determine the status message for Ninja to print for this invocation.
+         * Run cacheable invocations through the action cache tool. The inputs are
+         * listed in the same order as ActionCache::key() uses, so keys match the
+         * simple executor and the two can share a cache.
          */
-        std::string description = NinjaDescription(_formatter->beginInvocation(invocation, invocation.executable().displayName(), false));
+        if (_actionCache != nullptr && ActionCache::Cacheable(invocation)) {
+            std::vector<std::string> actionCacheArguments;
+            for (std::string const &input : invocation.inputs()) {
+                actionCacheArguments.push_back("--input");
+                actionCacheArguments.push_back(input);
+            }
+            for (std::string const &inputDependency : invocation.inputDependencies()) {
+                actionCacheArguments.push_back("--input");
+                actionCacheArguments.push_back(inputDependency);
+            }
+            for (pbxbuild::Tool::Invocation::AuxiliaryFile const &auxiliaryFile : invocation.auxiliaryFiles()) {
+                actionCacheArguments.push_back("--input");
+                actionCacheArguments.push_back(auxiliaryFile.path());
+            }
+            for (std::string const &output : invocation.outputs()) {
+                actionCacheArguments.push_back("--output");
+                actionCacheArguments.push_back(output);
+            }
+            actionCacheArguments.push_back("--");
+
+            for (std::string const &arg : actionCacheArguments) {
+                command.cacheExec += " ";
+                Escape::Shell(arg, &command.cacheExec);
+            }
+        }
 
         /*
-         * Add the dependency info converter & file.
+         * Add the dependency info file. Ninja reads Makefile dependency info itself,
+         * so a single Makefile-format file written by the tool is used directly.
+         * Other formats are converted after the tool runs.
          */
-        std::string dependencyInfoFile;
-        std::string dependencyInfoExec;
-
-        if (!invocation.dependencyInfo().empty()) {
+        if (invocation.dependencyInfo().size() == 1 && invocation.dependencyInfo().front().format() == dependency::DependencyInfoFormat::Makefile) {
+            command.dependencyInfoFile = FSUtil::ResolveRelativePath(invocation.dependencyInfo().front().path(), invocation.workingDirectory());
+        } else if (!invocation.dependencyInfo().empty()) {
             /* Determine the first output; Ninja expects that as the Makefile rule. */
             std::string output = NinjaInvocationOutputs(invocation).front();
 
             /* Find where the generated dependency info should go. */
-            pbxsetting::Environment const &environment = targetEnvironment.environment();
-            std::string temporaryDirectory = environment.resolve("TARGET_TEMP_DIR");
-            dependencyInfoFile = temporaryDirectory + "/" + ".ninja-dependency-info-" + NinjaHash(output) + ".d";
+            command.dependencyInfoFile = temporaryDirectory + "/" + ".ninja-dependency-info-" + NinjaHash(output) + ".d";
 
             /* Build the dependency info rewriter arguments. */
             std::string dependencyInfoExecutable = NinjaDependencyInfoExecutable();
             std::vector<std::string> dependencyInfoArguments = {
                 "--name", output,
-                "--output", dependencyInfoFile,
+                "--output", command.dependencyInfoFile,
             };
 
             /* Add the input for each dependency info. */
@@ -725,13 +1060,164 @@ buildTargetInvocations(
             }
 
             /* Create the command for converting the dependency info. */
-            dependencyInfoExec = Escape::Shell(dependencyInfoExecutable);
+            command.dependencyInfoExec = Escape::Shell(dependencyInfoExecutable);
             for (std::string const &arg : dependencyInfoArguments) {
-                dependencyInfoExec += " " + Escape::Shell(arg);
+                command.dependencyInfoExec += " ";
+                Escape::Shell(arg, &command.dependencyInfoExec);
             }
+        }
+
+        /*
+         * Ninja can move the dependencies into its own database, but only for a
+         * single output, and it deletes the depfile once read. Tools that list
+         * their depfile as an output, like the Swift compiler, would then never
+         * be up to date, so those keep the depfile where it is.
+         */
+        std::vector<std::string> outputs = NinjaInvocationOutputs(invocation);
+        command.dependencyDatabase = (!command.dependencyInfoFile.empty() && outputs.size() == 1 && FSUtil::ResolveRelativePath(outputs.front(), invocation.workingDirectory()) != command.dependencyInfoFile);
+
+        commands.push_back(command);
+    }
+
+    /*
+     * Group the invocations into one rule per tool. Invocations share a rule if they run
+     * the same tool in the same environment, so those are written once per rule rather
+     * than once per invocation. Any leading arguments shared by every invocation of a
+     * rule are also written into the rule. Environments are written once per file, since
+     * most invocations in a target use the same one.
+     */
+    struct NinjaRule {
+        std::string         name;
+        size_t              environment;
+        size_t              prefix;
+        std::vector<size_t> commands;
+    };
+
+    std::vector<NinjaRule> rules;
+    std::vector<size_t> commandRules;
+    std::unordered_map<std::string, size_t> ruleIndexes;
+    std::vector<std::string> environments;
+    std::unordered_map<std::string, size_t> environmentIndexes;
+
+    for (size_t n = 0; n < commands.size(); n++) {
+        NinjaCommand const &command = commands[n];
+
+        auto eit = environmentIndexes.find(command.environment);
+        if (eit == environmentIndexes.end()) {
+            eit = environmentIndexes.insert({ command.environment, environments.size() }).first;
+            environments.push_back(command.environment);
+        }
+
+        std::string key = command.exec + '\0' + std::to_string(eit->second) + '\0' + (command.dependencyInfoFile.empty() ? "0" : command.dependencyInfoExec.empty() ? "1" : "2") + (command.dependencyDatabase ? "1" : "0") + (command.responseFile ? "1" : "0");
+        auto rit = ruleIndexes.find(key);
+        if (rit == ruleIndexes.end()) {
+            std::string name = NinjaRuleName(command.invocation->executable().path(), rules.size());
+            rit = ruleIndexes.insert({ key, rules.size() }).first;
+            rules.push_back({ name, eit->second, 0, { } });
+        }
+
+        rules[rit->second].commands.push_back(n);
+        commandRules.push_back(rit->second);
+    }
+
+    for (NinjaRule &rule : rules) {
+        if (rule.commands.size() < 2) {
+            continue;
+        }
+
+        std::vector<std::string> const &first = commands[rule.commands.front()].arguments;
+        rule.prefix = first.size();
+        for (size_t index : rule.commands) {
+            std::vector<std::string> const &arguments = commands[index].arguments;
+            rule.prefix = std::min(rule.prefix, static_cast<size_t>(std::mismatch(first.begin(), first.begin() + std::min(rule.prefix, arguments.size()), arguments.begin()).first - first.begin()));
+        }
+    }
+
+    /*
+     * Write out the shared environments, and the action cache tool if used.
+     */
+    for (size_t n = 0; n < environments.size(); n++) {
+        writer->binding({ "env_" + std::to_string(n), ninja::Value::String(environments[n]) });
+    }
+    if (_actionCache != nullptr) {
+        std::string actionCacheExec = Escape::Shell(NinjaActionCacheExecutable());
+        for (std::string const &arg : { std::string("--cache"), _actionCache->path(), std::string("--size"), std::to_string(_actionCache->sizeLimit()) }) {
+            actionCacheExec += " ";
+            Escape::Shell(arg, &actionCacheExec);
+        }
+        writer->binding({ "actioncache", ninja::Value::String(actionCacheExec) });
+    }
+    writer->newline();
+
+    /*
+     * Write out the rules.
+     */
+    for (NinjaRule const &rule : rules) {
+        NinjaCommand const &command = commands[rule.commands.front()];
+
+        std::string exec = command.exec;
+        for (size_t n = 0; n < rule.prefix; n++) {
+            exec += " " + command.arguments[n];
+        }
+
+        ninja::Value value = ninja::Value::Expression("cd $dir && env -i $env_" + std::to_string(rule.environment) + " ");
+        if (_actionCache != nullptr) {
+            value = value + ninja::Value::Expression("$cacheexec ");
+        }
+        value = value + ninja::Value::String(exec);
+        std::vector<ninja::Binding> bindings;
+
+        if (command.responseFile) {
+            value = value + ninja::Value::Expression(" $rspargs");
+            bindings.push_back({ "rspfile", ninja::Value::Expression("$rsp") });
+            bindings.push_back({ "rspfile_content", ninja::Value::Expression("$args") });
         } else {
-            // TODO(grp): Avoid the need for an empty dependency info command if not used.
-            dependencyInfoExec = "true";
+            value = value + ninja::Value::Expression(" $args");
+        }
+
+        if (!command.dependencyInfoExec.empty()) {
+            value = value + ninja::Value::Expression(" && $depexec");
+        }
+
+        /*
+         * Ninja moves the dependencies from the depfile of each build into its own
+         * database after the invocation runs, so it doesn't have to parse them again.
+         */
+        if (command.dependencyDatabase) {
+            bindings.push_back({ "deps", ninja::Value::String("gcc") });
+        }
+
+        writer->rule(rule.name, value, bindings);
+    }
+    writer->newline();
+
+    /*
+     * Add the build command for each invocation, longest path first.
+     */
+    std::vector<pbxbuild::Tool::Invocation const *> commandInvocations;
+    for (NinjaCommand const &command : commands) {
+        commandInvocations.push_back(command.invocation);
+    }
+
+    for (size_t n : NinjaCriticalPathOrder(commandInvocations, durations)) {
+        NinjaCommand const &command = commands[n];
+        NinjaRule const &rule = rules[commandRules[n]];
+        pbxbuild::Tool::Invocation const &invocation = *command.invocation;
+
+        /*
+         * Determine the status message for Ninja to print for this invocation.
+         */
+        std::string description = NinjaDescription(_formatter->beginInvocation(invocation, invocation.executable().displayName(), false));
+
+        /*
+         * The arguments not already part of the rule.
+         */
+        std::string arguments;
+        for (size_t a = rule.prefix; a < command.arguments.size(); a++) {
+            if (a != rule.prefix) {
+                arguments += " ";
+            }
+            arguments += command.arguments[a];
         }
 
         /*
@@ -740,16 +1226,25 @@ buildTargetInvocations(
         std::vector<ninja::Binding> bindings = {
             { "description", ninja::Value::String(description) },
             { "dir", ninja::Value::String(Escape::Shell(invocation.workingDirectory())) },
-            { "exec", ninja::Value::String(exec) },
         };
-        if (!environment.empty()) {
-            bindings.push_back({ "env", ninja::Value::String(environment) });
+        if (!arguments.empty()) {
+            bindings.push_back({ "args", ninja::Value::String(arguments) });
         }
-        if (!dependencyInfoExec.empty()) {
-            bindings.push_back({ "depexec", ninja::Value::String(dependencyInfoExec) });
+        if (!command.cacheExec.empty()) {
+            bindings.push_back({ "cacheexec", ninja::Value::Expression("$actioncache") + ninja::Value::String(command.cacheExec) });
+        }
+        if (command.responseFile) {
+            /* Determine the first output to name the response file after. */
+            std::string output = NinjaInvocationOutputs(invocation).front();
+            std::string responseFile = temporaryDirectory + "/" + ".ninja-response-" + NinjaHash(output) + ".rsp";
+            bindings.push_back({ "rsp", ninja::Value::String(responseFile) });
+            bindings.push_back({ "rspargs", ninja::Value::String(Escape::Shell("@" + responseFile)) });
         }
-        if (!dependencyInfoFile.empty()) {
-            bindings.push_back({ "depfile", ninja::Value::String(dependencyInfoFile) });
+        if (!command.dependencyInfoExec.empty()) {
+            bindings.push_back({ "depexec", ninja::Value::String(command.dependencyInfoExec) });
+        }
+        if (!command.dependencyInfoFile.empty()) {
+            bindings.push_back({ "depfile", ninja::Value::String(command.dependencyInfoFile) });
         }
 
         /*
@@ -792,27 +1287,20 @@ buildTargetInvocations(
         /*
          * Add the rule to build this invocation.
          */
-        writer.build(outputs, NinjaRuleName(), inputs, bindings, inputDependencies, orderDependencies);
-    }
-
-    /*
-     * Serialize the Ninja file into the build root.
-     */
-    std::string path = TargetNinjaPath(target, targetEnvironment);
-    if (!WriteNinja(filesystem, writer, path)) {
-        fprintf(stderr, "error: unable to write target ninja: %s\n", path.c_str());
-        return false;
+        writer->build(outputs, rule.name, inputs, bindings, inputDependencies, orderDependencies);
     }
 
     return true;
 }
 
 std::unique_ptr<NinjaExecutor> NinjaExecutor::
-Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate)
+Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate, bool verbose, std::shared_ptr<ActionCache> const &actionCache)
 {
     return std::unique_ptr<NinjaExecutor>(new NinjaExecutor(
         formatter,
         dryRun,
-        generate
+        generate,
+        verbose,
+        actionCache
     ));
 }
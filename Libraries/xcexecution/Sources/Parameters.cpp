@@ -12,14 +12,12 @@
 #include <pbxbuild/Build/DependencyResolver.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
-#include <libutil/md5.h>
-
-#include <sstream>
-#include <iomanip>
+#include <libutil/Hash.h>
 
 using xcexecution::Parameters;
 using libutil::Filesystem;
 using libutil::FSUtil;
+using libutil::Hash;
 
 Parameters::
 Parameters(
@@ -94,24 +92,15 @@ canonicalArguments() const
 std::string Parameters::
 canonicalHash() const
 {
-    md5_state_t state;
-    md5_init(&state);
+    Hash hash;
 
     std::vector<std::string> arguments = canonicalArguments();
     for (std::string const &argument : arguments) {
         /* Inlucde trailing NUL terminator to separate arguments. */
-        md5_append(&state, reinterpret_cast<const md5_byte_t *>(argument.data()), argument.size() + 1);
+        hash.update(argument.c_str(), argument.size() + 1);
     }
 
-    uint8_t digest[16];
-    md5_finish(&state, reinterpret_cast<md5_byte_t *>(&digest));
-
-    std::ostringstream ss;
-    ss << std::hex << std::setfill('0');
-    for (uint8_t c : digest) {
-        ss << std::setw(2) << static_cast<int>(c);
-    }
-    return ss.str();
+    return hash.hex();
 }
 
 static pbxproj::PBX::Project::shared_ptr
@@ -10,25 +10,44 @@
 #include <xcexecution/SimpleExecutor.h>
 
 #include <xcexecution/Parameters.h>
+#include <xcexecution/ActionCache.h>
+#include <xcexecution/BuildDatabase.h>
 #include <builtin/Driver.h>
 #include <pbxbuild/Phase/Environment.h>
 #include <pbxbuild/Phase/PhaseInvocations.h>
+#include <libutil/CachingFilesystem.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
+#include <libutil/Path.h>
 #include <libutil/Subprocess.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_set>
+
 #include <sys/types.h>
 #include <sys/stat.h>
 
 using xcexecution::SimpleExecutor;
+using xcexecution::ActionCache;
+using xcexecution::BuildDatabase;
+using libutil::CachingFilesystem;
 using libutil::Filesystem;
 using libutil::FSUtil;
+using libutil::Path;
 using libutil::Subprocess;
 
 SimpleExecutor::
-SimpleExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins) :
-    Executor (formatter, dryRun, false),
-    _builtins(builtins)
+SimpleExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool verbose, builtin::Registry const &builtins, size_t jobs, bool parallelizeTargets, std::shared_ptr<ActionCache> const &actionCache) :
+    Executor           (formatter, dryRun, false, verbose),
+    _builtins          (builtins),
+    _jobs              (jobs != 0 ? jobs : std::max<size_t>(1, std::thread::hardware_concurrency())),
+    _parallelizeTargets(parallelizeTargets),
+    _actionCache       (actionCache)
 {
 }
 
@@ -37,6 +56,52 @@ SimpleExecutor::
 {
 }
 
+/*
+ * The job slots shared by everything running in a build. Resolving a
+ * target and running an invocation each take one slot.
+ */
+class SimpleExecutor::Jobs {
+public:
+    std::mutex              mutex;
+    std::condition_variable condition;
+    size_t                  available;
+
+public:
+    Jobs(size_t jobs) :
+        available(jobs)
+    {
+    }
+
+public:
+    void acquire()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this]() { return available > 0; });
+        available--;
+    }
+
+    void release()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        available++;
+        condition.notify_all();
+    }
+};
+
+/*
+ * Formatter output for a target. Printed directly when targets are built
+ * one at a time, otherwise collected so each target's output is together.
+ */
+static void
+Print(std::string *output, std::string const &string)
+{
+    if (output != nullptr) {
+        *output += string;
+    } else {
+        xcformatter::Formatter::Print(string);
+    }
+}
+
 bool SimpleExecutor::
 build(
     libutil::Filesystem *filesystem,
@@ -66,35 +131,174 @@ build(
         return false;
     }
 
-    for (pbxproj::PBX::Target::shared_ptr const &target : *orderedTargets) {
-        xcformatter::Formatter::Print(_formatter->beginTarget(*buildContext, target));
+    Jobs jobs(_jobs);
 
-        ext::optional<pbxbuild::Target::Environment> targetEnvironment = buildContext->targetEnvironment(buildEnvironment, target);
-        if (!targetEnvironment) {
-            fprintf(stderr, "error: couldn't create target environment for %s\n", target->name().c_str());
-            xcformatter::Formatter::Print(_formatter->finishTarget(*buildContext, target));
-            continue;
+    if (!_parallelizeTargets) {
+        for (pbxproj::PBX::Target::shared_ptr const &target : *orderedTargets) {
+            auto result = resolveAndBuildTarget(filesystem, buildEnvironment, *buildContext, target, &jobs, nullptr);
+            if (!result.first) {
+                printStatistics(*buildContext);
+                xcformatter::Formatter::Print(_formatter->failure(*buildContext, result.second));
+                return false;
+            }
         }
 
-        xcformatter::Formatter::Print(_formatter->beginCheckDependencies(target));
-        pbxbuild::Phase::Environment phaseEnvironment = pbxbuild::Phase::Environment(buildEnvironment, *buildContext, target, *targetEnvironment);
-        pbxbuild::Phase::PhaseInvocations phaseInvocations = pbxbuild::Phase::PhaseInvocations::Create(phaseEnvironment, target);
-        xcformatter::Formatter::Print(_formatter->finishCheckDependencies(target));
+        printStatistics(*buildContext);
+        xcformatter::Formatter::Print(_formatter->success(*buildContext));
+        return true;
+    }
+
+    /*
+     * Build each target once the targets it depends on are built. Ready
+     * targets start in dependency order.
+     */
+    std::unordered_map<pbxproj::PBX::Target::shared_ptr, size_t> targetIndexes;
+    for (size_t n = 0; n < orderedTargets->size(); n++) {
+        targetIndexes.insert({ (*orderedTargets)[n], n });
+    }
 
-        auto result = buildTarget(filesystem, target, *targetEnvironment, phaseInvocations.invocations());
-        if (!result.first) {
-            xcformatter::Formatter::Print(_formatter->finishTarget(*buildContext, target));
-            xcformatter::Formatter::Print(_formatter->failure(*buildContext, result.second));
-            return false;
+    std::vector<size_t> waiting = std::vector<size_t>(orderedTargets->size());
+    std::vector<std::vector<size_t>> dependents = std::vector<std::vector<size_t>>(orderedTargets->size());
+    std::set<size_t> ready;
+    for (size_t n = 0; n < orderedTargets->size(); n++) {
+        for (pbxproj::PBX::Target::shared_ptr const &dependency : targetGraph->adjacent((*orderedTargets)[n])) {
+            auto it = targetIndexes.find(dependency);
+            if (it != targetIndexes.end() && it->second != n) {
+                waiting[n]++;
+                dependents[it->second].push_back(n);
+            }
+        }
+        if (waiting[n] == 0) {
+            ready.insert(n);
         }
+    }
+
+    struct TargetResult {
+        size_t                                  index;
+        bool                                    success;
+        std::vector<pbxbuild::Tool::Invocation> failures;
+        std::string                             output;
+    };
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<TargetResult> finished;
+    std::unordered_map<size_t, std::thread> running;
+
+    bool failed = false;
+    std::vector<pbxbuild::Tool::Invocation> failures;
+
+    while (true) {
+        /* After a failure, let running targets finish but start no more. */
+        while (!failed && !ready.empty()) {
+            size_t index = *ready.begin();
+            ready.erase(ready.begin());
+
+            pbxproj::PBX::Target::shared_ptr const &target = (*orderedTargets)[index];
+            running.insert({ index, std::thread([this, filesystem, &buildEnvironment, &buildContext, &target, index, &jobs, &mutex, &condition, &finished]() {
+                std::string output;
+                auto result = resolveAndBuildTarget(filesystem, buildEnvironment, *buildContext, target, &jobs, &output);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.push_back({ index, result.first, result.second, output });
+                condition.notify_one();
+            }) });
+        }
+
+        if (running.empty()) {
+            break;
+        }
+
+        std::vector<TargetResult> results;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&]() { return !finished.empty(); });
+            results.swap(finished);
+        }
+
+        for (TargetResult const &result : results) {
+            auto it = running.find(result.index);
+            it->second.join();
+            running.erase(it);
+
+            xcformatter::Formatter::Print(result.output);
+
+            if (result.success) {
+                for (size_t dependent : dependents[result.index]) {
+                    if (--waiting[dependent] == 0) {
+                        ready.insert(dependent);
+                    }
+                }
+            } else {
+                failed = true;
+                failures.insert(failures.end(), result.failures.begin(), result.failures.end());
+            }
+        }
+    }
+
+    printStatistics(*buildContext);
 
-        xcformatter::Formatter::Print(_formatter->finishTarget(*buildContext, target));
+    if (failed) {
+        xcformatter::Formatter::Print(_formatter->failure(*buildContext, failures));
+        return false;
     }
 
     xcformatter::Formatter::Print(_formatter->success(*buildContext));
     return true;
 }
 
+std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> SimpleExecutor::
+resolveAndBuildTarget(
+    Filesystem *filesystem,
+    pbxbuild::Build::Environment const &buildEnvironment,
+    pbxbuild::Build::Context const &buildContext,
+    pbxproj::PBX::Target::shared_ptr const &target,
+    Jobs *jobs,
+    std::string *output)
+{
+    Print(output, _formatter->beginTarget(buildContext, target));
+
+    ext::optional<pbxbuild::Target::Environment> targetEnvironment = buildContext.targetEnvironment(buildEnvironment, target);
+    if (!targetEnvironment) {
+        fprintf(stderr, "error: couldn't create target environment for %s\n", target->name().c_str());
+        Print(output, _formatter->finishTarget(buildContext, target));
+        return std::make_pair(true, std::vector<pbxbuild::Tool::Invocation>());
+    }
+
+    Print(output, _formatter->beginCheckDependencies(target));
+    jobs->acquire();
+
+    /*
+     * Resolution checks the same paths many times. Remember the answers, but
+     * only while resolving this target, since building changes them.
+     */
+    CachingFilesystem resolveFilesystem(filesystem);
+    pbxbuild::Phase::Environment phaseEnvironment = pbxbuild::Phase::Environment(&resolveFilesystem, buildEnvironment, buildContext, target, *targetEnvironment);
+    pbxbuild::Phase::PhaseInvocations phaseInvocations = pbxbuild::Phase::PhaseInvocations::Create(phaseEnvironment, target);
+    jobs->release();
+    Print(output, _formatter->finishCheckDependencies(target));
+
+    auto result = buildTarget(filesystem, target, *targetEnvironment, phaseInvocations.invocations(), jobs, output);
+
+    /*
+     * Targets resolved after this one can search the directories it wrote
+     * to, so forget what was cached about them.
+     */
+    if (!_dryRun) {
+        std::vector<std::string> written;
+        for (pbxbuild::Tool::Invocation const &invocation : phaseInvocations.invocations()) {
+            written.insert(written.end(), invocation.outputs().begin(), invocation.outputs().end());
+            for (pbxbuild::Tool::Invocation::AuxiliaryFile const &auxiliaryFile : invocation.auxiliaryFiles()) {
+                written.push_back(auxiliaryFile.path());
+            }
+        }
+        buildContext.searchPathsCache()->invalidate(written);
+    }
+
+    Print(output, _formatter->finishTarget(buildContext, target));
+    return result;
+}
+
 static ext::optional<std::vector<pbxbuild::Tool::Invocation>>
 SortInvocations(std::vector<pbxbuild::Tool::Invocation> const &invocations)
 {
@@ -148,14 +352,15 @@ writeAuxiliaryFiles(
     Filesystem *filesystem,
     pbxproj::PBX::Target::shared_ptr const &target,
     pbxbuild::Target::Environment const &targetEnvironment,
-    std::vector<pbxbuild::Tool::Invocation> const &invocations)
+    std::vector<pbxbuild::Tool::Invocation> const &invocations,
+    std::string *output)
 {
-    xcformatter::Formatter::Print(_formatter->beginWriteAuxiliaryFiles(target));
+    Print(output, _formatter->beginWriteAuxiliaryFiles(target));
     for (pbxbuild::Tool::Invocation const &invocation : invocations) {
         for (pbxbuild::Tool::Invocation::AuxiliaryFile const &auxiliaryFile : invocation.auxiliaryFiles()) {
             std::string directory = FSUtil::GetDirectoryName(auxiliaryFile.path());
             if (!filesystem->isDirectory(directory)) {
-                xcformatter::Formatter::Print(_formatter->createAuxiliaryDirectory(directory));
+                Print(output, _formatter->createAuxiliaryDirectory(directory));
 
                 if (!_dryRun) {
                     if (!filesystem->createDirectory(directory)) {
@@ -164,16 +369,23 @@ writeAuxiliaryFiles(
                 }
             }
 
-            xcformatter::Formatter::Print(_formatter->writeAuxiliaryFile(auxiliaryFile.path()));
+            /*
+             * Leave unchanged files alone, so invocations using them are
+             * still up to date.
+             */
+            std::vector<uint8_t> contents;
+            if (!filesystem->read(&contents, auxiliaryFile.path()) || contents != auxiliaryFile.contents()) {
+                Print(output, _formatter->writeAuxiliaryFile(auxiliaryFile.path()));
 
-            if (!_dryRun) {
-                if (!filesystem->write(auxiliaryFile.contents(), auxiliaryFile.path())) {
-                    return false;
+                if (!_dryRun) {
+                    if (!filesystem->write(auxiliaryFile.contents(), auxiliaryFile.path())) {
+                        return false;
+                    }
                 }
             }
 
             if (auxiliaryFile.executable() && !filesystem->isExecutable(auxiliaryFile.path())) {
-                xcformatter::Formatter::Print(_formatter->setAuxiliaryExecutable(auxiliaryFile.path()));
+                Print(output, _formatter->setAuxiliaryExecutable(auxiliaryFile.path()));
 
                 if (!_dryRun) {
                     // FIXME: This should use the filesystem.
@@ -184,65 +396,362 @@ writeAuxiliaryFiles(
             }
         }
     }
-    xcformatter::Formatter::Print(_formatter->finishWriteAuxiliaryFiles(target));
+    Print(output, _formatter->finishWriteAuxiliaryFiles(target));
 
     return true;
 }
 
+/*
+ * For each invocation, the invocations producing its inputs.
+ */
+static std::vector<std::vector<size_t>>
+InvocationDependencies(std::vector<pbxbuild::Tool::Invocation> const &invocations)
+{
+    std::unordered_map<std::string, size_t> outputToInvocation;
+    for (size_t n = 0; n < invocations.size(); n++) {
+        for (std::string const &output : invocations[n].outputs()) {
+            outputToInvocation.insert({ output, n });
+        }
+    }
+
+    std::vector<std::vector<size_t>> dependencies = std::vector<std::vector<size_t>>(invocations.size());
+    for (size_t n = 0; n < invocations.size(); n++) {
+        pbxbuild::Tool::Invocation const &invocation = invocations[n];
+
+        std::unordered_set<size_t> seen;
+        for (std::vector<std::string> const *inputs : { &invocation.inputs(), &invocation.phonyInputs(), &invocation.inputDependencies() }) {
+            for (std::string const &input : *inputs) {
+                auto it = outputToInvocation.find(input);
+                if (it != outputToInvocation.end() && it->second != n && seen.insert(it->second).second) {
+                    dependencies[n].push_back(it->second);
+                }
+            }
+        }
+    }
+
+    return dependencies;
+}
+
+/*
+ * For each invocation, the longest time from starting it until everything
+ * depending on it has finished, given how long each invocation takes.
+ * Invocations in a dependency cycle only count their own cost.
+ */
+static std::vector<uint64_t>
+CriticalPathPriorities(
+    std::vector<std::vector<size_t>> const &dependencies,
+    std::vector<std::vector<size_t>> const &dependents,
+    std::vector<uint64_t> const &costs)
+{
+    std::vector<uint64_t> priorities = costs;
+
+    /* Visit invocations after everything that depends on them. */
+    std::vector<size_t> remaining = std::vector<size_t>(dependents.size());
+    std::vector<size_t> visit;
+    for (size_t n = 0; n < dependents.size(); n++) {
+        remaining[n] = dependents[n].size();
+        if (remaining[n] == 0) {
+            visit.push_back(n);
+        }
+    }
+
+    while (!visit.empty()) {
+        size_t index = visit.back();
+        visit.pop_back();
+
+        for (size_t dependent : dependents[index]) {
+            priorities[index] = std::max(priorities[index], costs[index] + priorities[dependent]);
+        }
+
+        for (size_t dependency : dependencies[index]) {
+            if (--remaining[dependency] == 0) {
+                visit.push_back(dependency);
+            }
+        }
+    }
+
+    return priorities;
+}
+
+bool SimpleExecutor::
+performInvocation(
+    Filesystem *filesystem,
+    pbxbuild::Tool::Invocation const &invocation)
+{
+    /*
+     * Restore the outputs from the action cache, if they are there.
+     */
+    ext::optional<std::string> key;
+    std::vector<std::string> outputs;
+    if (_actionCache != nullptr && ActionCache::Cacheable(invocation)) {
+        key = _actionCache->key(invocation);
+
+        for (std::string const &output : invocation.outputs()) {
+            outputs.push_back(FSUtil::ResolveRelativePath(output, invocation.workingDirectory()));
+        }
+
+        if (key && _actionCache->restore(*key, outputs)) {
+            return true;
+        }
+    }
+
+    bool success;
+    if (!invocation.executable().builtin().empty()) {
+        /* For built-in tools, run them in-process. */
+        std::shared_ptr<builtin::Driver> driver = _builtins.driver(invocation.executable().builtin());
+        if (driver == nullptr) {
+            return false;
+        }
+
+        success = (driver->run(invocation.arguments(), invocation.environment(), filesystem, invocation.workingDirectory()) == 0);
+    } else {
+        /* External tool, run the tool externally. */
+        Subprocess process;
+        success = (process.execute(invocation.executable().path(), invocation.arguments(), invocation.environment(), invocation.workingDirectory()) && process.exitcode() == 0);
+    }
+
+    /*
+     * Cache the outputs for next time. Not being able to is not an error.
+     */
+    if (success && key) {
+        _actionCache->store(*key, outputs);
+    }
+
+    return success;
+}
+
 std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> SimpleExecutor::
 performInvocations(
     Filesystem *filesystem,
     pbxproj::PBX::Target::shared_ptr const &target,
     pbxbuild::Target::Environment const &targetEnvironment,
     std::vector<pbxbuild::Tool::Invocation> const &orderedInvocations,
-    bool createProductStructure)
+    bool createProductStructure,
+    BuildDatabase *database,
+    Jobs *jobs,
+    std::string *output)
 {
-    for (pbxbuild::Tool::Invocation const &invocation : orderedInvocations) {
-        // TODO(grp): This should perhaps be a separate flag for a 'phony' invocation.
-        if (invocation.executable().path().empty()) {
-            continue;
+    std::vector<std::vector<size_t>> dependencies = InvocationDependencies(orderedInvocations);
+
+    std::vector<std::vector<size_t>> dependents = std::vector<std::vector<size_t>>(orderedInvocations.size());
+    for (size_t n = 0; n < orderedInvocations.size(); n++) {
+        for (size_t dependency : dependencies[n]) {
+            dependents[dependency].push_back(n);
+        }
+    }
+
+    /*
+     * Start whatever is on the longest remaining path first, using how long
+     * each invocation took the last time it ran. Invocations that haven't
+     * run before are assumed to take an average amount of time. Product
+     * structure invocations run one at a time, so always keep their order.
+     */
+    std::vector<uint64_t> priorities = std::vector<uint64_t>(orderedInvocations.size());
+    if (!createProductStructure) {
+        std::vector<ext::optional<uint64_t>> durations;
+        uint64_t total = 0;
+        size_t known = 0;
+        for (pbxbuild::Tool::Invocation const &invocation : orderedInvocations) {
+            ext::optional<uint64_t> duration;
+            if (BuildDatabase::Entry const *entry = database->entry(invocation)) {
+                duration = entry->duration();
+                total += *duration;
+                known++;
+            }
+            durations.push_back(duration);
+        }
+
+        /* Nothing to run takes no time. */
+        std::vector<uint64_t> costs;
+        for (size_t n = 0; n < orderedInvocations.size(); n++) {
+            if (orderedInvocations[n].executable().path().empty()) {
+                costs.push_back(0);
+            } else if (durations[n]) {
+                costs.push_back(*durations[n]);
+            } else {
+                costs.push_back(known != 0 ? total / known : 0);
+            }
         }
 
-        if (invocation.createsProductStructure() != createProductStructure) {
-            continue;
+        priorities = CriticalPathPriorities(dependencies, dependents, costs);
+    }
+
+    /*
+     * Track how many dependencies of each invocation are unfinished. Ready
+     * invocations with the same priority are started in order, so without
+     * any history a single job runs them exactly as they were sorted.
+     */
+    auto before = [&priorities](size_t a, size_t b) {
+        return priorities[a] != priorities[b] ? priorities[a] > priorities[b] : a < b;
+    };
+
+    std::vector<size_t> waiting = std::vector<size_t>(orderedInvocations.size());
+    std::set<size_t, decltype(before)> ready = std::set<size_t, decltype(before)>(before);
+    for (size_t n = 0; n < orderedInvocations.size(); n++) {
+        waiting[n] = dependencies[n].size();
+        if (waiting[n] == 0) {
+            ready.insert(n);
         }
+    }
 
-        std::map<std::string, std::string> sortedEnvironment = std::map<std::string, std::string>(invocation.environment().begin(), invocation.environment().end());
+    struct InvocationResult {
+        size_t                               index;
+        bool                                 success;
+        bool                                 skipped;
+        ext::optional<BuildDatabase::Entry>  entry;
+    };
 
-        xcformatter::Formatter::Print(_formatter->beginInvocation(invocation, invocation.executable().displayName(), createProductStructure));
+    std::vector<InvocationResult> finished;
+    std::unordered_map<size_t, std::thread> running;
 
-        if (!_dryRun) {
-            for (std::string const &output : invocation.outputs()) {
-                std::string directory = FSUtil::GetDirectoryName(output);
+    std::vector<pbxbuild::Tool::Invocation> failures;
 
-                if (!filesystem->createDirectory(directory)) {
-                    return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
-                }
+    /* Many outputs share a directory; only create each one once. */
+    std::unordered_set<Path> createdDirectories;
+
+    auto complete = [&](size_t index) {
+        for (size_t dependent : dependents[index]) {
+            if (--waiting[dependent] == 0) {
+                ready.insert(dependent);
             }
+        }
+    };
+
+    auto finish = [&](InvocationResult const &result) {
+        pbxbuild::Tool::Invocation const &invocation = orderedInvocations[result.index];
+        if (!result.skipped) {
+            Print(output, _formatter->finishInvocation(invocation, invocation.executable().displayName(), createProductStructure));
+        }
 
-            if (!invocation.executable().builtin().empty()) {
-                /* For built-in tools, run them in-process. */
-                std::shared_ptr<builtin::Driver> driver = _builtins.driver(invocation.executable().builtin());
-                if (driver == nullptr) {
-                    xcformatter::Formatter::Print(_formatter->finishInvocation(invocation, invocation.executable().displayName(), createProductStructure));
-                    return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
+        if (result.success) {
+            if (result.entry) {
+                database->insert(invocation, *result.entry);
+            }
+            complete(result.index);
+        } else {
+            database->remove(invocation);
+            failures.push_back(invocation);
+        }
+    };
+
+    /*
+     * Invocations take job slots shared with other targets. Completions and
+     * freed slots are both signaled through the shared condition.
+     */
+    std::unique_lock<std::mutex> lock(jobs->mutex);
+
+    while (true) {
+        /*
+         * Start everything that is ready, up to the job limit. After a
+         * failure, nothing new is started but running jobs are drained.
+         */
+        while (failures.empty() && !ready.empty()) {
+            size_t index = *ready.begin();
+            pbxbuild::Tool::Invocation const &invocation = orderedInvocations[index];
+
+            // TODO(grp): This should perhaps be a separate flag for a 'phony' invocation.
+            if (invocation.executable().path().empty() || invocation.createsProductStructure() != createProductStructure) {
+                /* Nothing to run, but anything after it can now start. */
+                ready.erase(ready.begin());
+                complete(index);
+                continue;
+            }
+
+            /*
+             * Product structure invocations run one at a time, in order, since
+             * they can depend on each other without declaring it.
+             */
+            if ((createProductStructure && !running.empty()) || jobs->available == 0) {
+                break;
+            }
+
+            ready.erase(ready.begin());
+
+            /* Copied, since the database changes as other invocations finish. */
+            ext::optional<BuildDatabase::Entry> previous;
+            if (BuildDatabase::Entry const *entry = database->entry(invocation)) {
+                previous = *entry;
+            }
+
+            if (_dryRun) {
+                bool skipped = (previous && previous->upToDate(invocation));
+                if (!skipped) {
+                    Print(output, _formatter->beginInvocation(invocation, invocation.executable().displayName(), createProductStructure));
                 }
+                finish({ index, true, skipped, ext::nullopt });
+                continue;
+            }
 
-                if (driver->run(invocation.arguments(), invocation.environment(), filesystem, invocation.workingDirectory()) != 0) {
-                    xcformatter::Formatter::Print(_formatter->finishInvocation(invocation, invocation.executable().displayName(), createProductStructure));
-                    return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
+            bool created = true;
+            for (std::string const &outputPath : invocation.outputs()) {
+                Path directory = Path(outputPath).parent();
+                if (directory.empty() || createdDirectories.count(directory) != 0) {
+                    continue;
                 }
-            } else {
-                /* External tool, run the tool externally. */
-                Subprocess process;
-                if (!process.execute(invocation.executable().path(), invocation.arguments(), invocation.environment(), invocation.workingDirectory()) || process.exitcode() != 0) {
-                    xcformatter::Formatter::Print(_formatter->finishInvocation(invocation, invocation.executable().displayName(), createProductStructure));
-                    return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
+
+                if (!filesystem->createDirectory(directory.string())) {
+                    created = false;
+                    break;
                 }
+                createdDirectories.insert(directory);
             }
+
+            if (!created) {
+                failures.push_back(invocation);
+                break;
+            }
+
+            jobs->available--;
+            running.insert({ index, std::thread([this, filesystem, &invocation, index, previous, createProductStructure, jobs, output, &finished]() {
+                InvocationResult result = { index, true, false, ext::nullopt };
+
+                /* Checking files is slow enough to be worth doing here, off the lock. */
+                if (previous && previous->upToDate(invocation)) {
+                    result.skipped = true;
+                } else {
+                    {
+                        std::lock_guard<std::mutex> lock(jobs->mutex);
+                        Print(output, _formatter->beginInvocation(invocation, invocation.executable().displayName(), createProductStructure));
+                    }
+
+                    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                    result.success = performInvocation(filesystem, invocation);
+                    std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now() - start;
+
+                    if (result.success) {
+                        result.entry = BuildDatabase::Entry::Create(filesystem, invocation, std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(jobs->mutex);
+                finished.push_back(result);
+                jobs->available++;
+                jobs->condition.notify_all();
+            }) });
+        }
+
+        if (running.empty() && (ready.empty() || !failures.empty())) {
+            break;
+        }
+
+        jobs->condition.wait(lock, [&]() {
+            return !finished.empty() || (failures.empty() && !ready.empty() && jobs->available > 0 && (!createProductStructure || running.empty()));
+        });
+
+        std::vector<InvocationResult> results;
+        results.swap(finished);
+
+        for (InvocationResult const &result : results) {
+            auto it = running.find(result.index);
+            it->second.join();
+            running.erase(it);
+
+            finish(result);
         }
+    }
 
-        xcformatter::Formatter::Print(_formatter->finishInvocation(invocation, invocation.executable().displayName(), createProductStructure));
+    if (!failures.empty()) {
+        return std::make_pair(false, failures);
     }
 
     return std::make_pair(true, std::vector<pbxbuild::Tool::Invocation>());
@@ -253,9 +762,11 @@ buildTarget(
     Filesystem *filesystem,
     pbxproj::PBX::Target::shared_ptr const &target,
     pbxbuild::Target::Environment const &targetEnvironment,
-    std::vector<pbxbuild::Tool::Invocation> const &invocations)
+    std::vector<pbxbuild::Tool::Invocation> const &invocations,
+    Jobs *jobs,
+    std::string *output)
 {
-    if (!writeAuxiliaryFiles(filesystem, target, targetEnvironment, invocations)) {
+    if (!writeAuxiliaryFiles(filesystem, target, targetEnvironment, invocations, output)) {
         return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>());
     }
 
@@ -265,27 +776,57 @@ buildTarget(
         return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>());
     }
 
-    xcformatter::Formatter::Print(_formatter->beginCreateProductStructure(target));
-    std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> structureResult = performInvocations(filesystem, target, targetEnvironment, *orderedInvocations, true);
-    xcformatter::Formatter::Print(_formatter->finishCreateProductStructure(target));
-    if (!structureResult.first) {
-        return structureResult;
+    /*
+     * Load what ran in the last build. If the database is missing or
+     * unreadable, everything runs.
+     */
+    std::string databasePath = targetEnvironment.environment().resolve("TARGET_TEMP_DIR") + "/" + ".xcbuild-simple-database";
+
+    BuildDatabase database;
+    std::vector<uint8_t> databaseContents;
+    if (filesystem->read(&databaseContents, databasePath)) {
+        if (ext::optional<BuildDatabase> loaded = BuildDatabase::Deserialize(databaseContents)) {
+            database = std::move(*loaded);
+        }
     }
 
-    std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> invocationsResult = performInvocations(filesystem, target, targetEnvironment, *orderedInvocations, false);
-    if (!invocationsResult.first) {
-        return invocationsResult;
+    /* Drop invocations that are no longer part of the target. */
+    std::unordered_set<std::string> keys;
+    for (pbxbuild::Tool::Invocation const &invocation : *orderedInvocations) {
+        if (ext::optional<std::string> key = BuildDatabase::Key(invocation)) {
+            keys.insert(*key);
+        }
     }
+    database.retain(keys);
 
-    return std::make_pair(true, std::vector<pbxbuild::Tool::Invocation>());
+    Print(output, _formatter->beginCreateProductStructure(target));
+    std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> result = performInvocations(filesystem, target, targetEnvironment, *orderedInvocations, true, &database, jobs, output);
+    Print(output, _formatter->finishCreateProductStructure(target));
+
+    if (result.first) {
+        result = performInvocations(filesystem, target, targetEnvironment, *orderedInvocations, false, &database, jobs, output);
+    }
+
+    /* Save even after a failure, to keep what did succeed. */
+    if (!_dryRun) {
+        if (!filesystem->createDirectory(FSUtil::GetDirectoryName(databasePath)) || !filesystem->write(database.serialize(), databasePath)) {
+            fprintf(stderr, "warning: unable to write build database %s\n", databasePath.c_str());
+        }
+    }
+
+    return result;
 }
 
 std::unique_ptr<SimpleExecutor> SimpleExecutor::
-Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins)
+Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool verbose, builtin::Registry const &builtins, size_t jobs, bool parallelizeTargets, std::shared_ptr<ActionCache> const &actionCache)
 {
     return std::unique_ptr<SimpleExecutor>(new SimpleExecutor(
         formatter,
         dryRun,
-        builtins
+        verbose,
+        builtins,
+        jobs,
+        parallelizeTargets,
+        actionCache
     ));
 }
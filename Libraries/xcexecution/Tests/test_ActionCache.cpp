@@ -0,0 +1,109 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <xcexecution/ActionCache.h>
+
+#include <fstream>
+#include <sstream>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+using xcexecution::ActionCache;
+
+static void
+WriteFile(std::string const &path, std::string const &contents)
+{
+    std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    file << contents;
+}
+
+static std::string
+ReadFile(std::string const &path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+TEST(ActionCache, Cacheable)
+{
+    pbxbuild::Tool::Invocation invocation;
+    invocation.executable() = pbxbuild::Tool::Invocation::Executable::Absolute("/bin/sh");
+    invocation.inputs() = { "/in" };
+    invocation.outputs() = { "/out" };
+    EXPECT_TRUE(ActionCache::Cacheable(invocation));
+
+    /* Inputs found while running are not part of the key. */
+    pbxbuild::Tool::Invocation dependencyInfo = invocation;
+    dependencyInfo.dependencyInfo() = { pbxbuild::Tool::Invocation::DependencyInfo(dependency::DependencyInfoFormat::Makefile, "/out.d") };
+    EXPECT_FALSE(ActionCache::Cacheable(dependencyInfo));
+
+    pbxbuild::Tool::Invocation outputs = invocation;
+    outputs.outputs().clear();
+    EXPECT_FALSE(ActionCache::Cacheable(outputs));
+}
+
+TEST(ActionCache, RoundTrip)
+{
+    char temporaryDirectory[] = "/tmp/xcexecution-ActionCache-XXXXXX";
+    ASSERT_NE(nullptr, ::mkdtemp(temporaryDirectory));
+
+    std::string root = temporaryDirectory;
+    std::string input = root + "/in.c";
+    std::string output = root + "/build/out.o";
+    ActionCache cache(root + "/cache", ActionCache::DefaultSizeLimit());
+
+    WriteFile(input, "int main() { }");
+    std::vector<std::string> arguments = { "-c", input, "-o", output };
+    ext::optional<std::string> key = cache.key("/bin/sh", arguments, { { "A", "1" } }, root, { input });
+    ASSERT_NE(ext::nullopt, key);
+
+    /* The same command gets the same key, regardless of environment order. */
+    EXPECT_EQ(key, cache.key("/bin/sh", arguments, { { "A", "1" } }, root, { input }));
+    EXPECT_NE(key, cache.key("/bin/sh", arguments, { { "A", "2" } }, root, { input }));
+
+    /* Nothing is cached yet. */
+    EXPECT_FALSE(cache.restore(*key, { output }));
+
+    ::mkdir((root + "/build").c_str(), 0755);
+    WriteFile(output, "object");
+    EXPECT_TRUE(cache.store(*key, { output }));
+
+    /* Removed outputs are restored, including their directory. */
+    ::unlink(output.c_str());
+    ::rmdir((root + "/build").c_str());
+    EXPECT_TRUE(cache.restore(*key, { output }));
+    EXPECT_EQ("object", ReadFile(output));
+
+    EXPECT_EQ(1, cache.hits());
+    EXPECT_EQ(1, cache.misses());
+
+    size_t hits = 0, misses = 0;
+    EXPECT_TRUE(cache.statistics(&hits, &misses));
+    EXPECT_EQ(1, hits);
+    EXPECT_EQ(1, misses);
+
+    /* A changed input changes the key. */
+    WriteFile(input, "int main() { return 0; }");
+    EXPECT_NE(key, cache.key("/bin/sh", arguments, { { "A", "1" } }, root, { input }));
+
+    /* Missing inputs can't be cached. */
+    EXPECT_EQ(ext::nullopt, cache.key("/bin/sh", arguments, { }, root, { root + "/missing" }));
+
+    /* Trimming to nothing removes the entry. */
+    ActionCache empty(root + "/cache", 0);
+    empty.trim();
+    EXPECT_FALSE(empty.restore(*key, { output }));
+
+    std::string command = "rm -rf '" + root + "'";
+    EXPECT_EQ(0, ::system(command.c_str()));
+}
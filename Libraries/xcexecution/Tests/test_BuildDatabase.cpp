@@ -0,0 +1,175 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <xcexecution/BuildDatabase.h>
+#include <libutil/DefaultFilesystem.h>
+
+#include <fstream>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+using xcexecution::BuildDatabase;
+using libutil::DefaultFilesystem;
+
+static pbxbuild::Tool::Invocation
+CreateInvocation(std::string const &input, std::string const &output)
+{
+    pbxbuild::Tool::Invocation invocation;
+    invocation.executable() = pbxbuild::Tool::Invocation::Executable::Absolute("/usr/bin/cc");
+    invocation.arguments() = { "-c", input, "-o", output };
+    invocation.environment() = { { "A", "1" }, { "B", "2" } };
+    invocation.workingDirectory() = "/";
+    invocation.inputs() = { input };
+    invocation.outputs() = { output };
+    return invocation;
+}
+
+static void
+WriteFile(std::string const &path, std::string const &contents)
+{
+    std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    file << contents;
+}
+
+TEST(BuildDatabase, Key)
+{
+    pbxbuild::Tool::Invocation invocation = CreateInvocation("/in.c", "/out.o");
+    EXPECT_NE(ext::nullopt, BuildDatabase::Key(invocation));
+
+    /* Without outputs, there's nothing to check. */
+    invocation.outputs().clear();
+    EXPECT_EQ(ext::nullopt, BuildDatabase::Key(invocation));
+}
+
+TEST(BuildDatabase, Signature)
+{
+    pbxbuild::Tool::Invocation invocation = CreateInvocation("/in.c", "/out.o");
+    std::string signature = BuildDatabase::Signature(invocation);
+
+    pbxbuild::Tool::Invocation reordered = invocation;
+    reordered.environment() = { { "B", "2" }, { "A", "1" } };
+    EXPECT_EQ(signature, BuildDatabase::Signature(reordered));
+
+    pbxbuild::Tool::Invocation arguments = invocation;
+    arguments.arguments().push_back("-O2");
+    EXPECT_NE(signature, BuildDatabase::Signature(arguments));
+
+    /* Argument boundaries are part of the signature. */
+    pbxbuild::Tool::Invocation joined = invocation;
+    joined.arguments() = { "-c" + invocation.arguments()[1], "-o", "/out.o" };
+    EXPECT_NE(signature, BuildDatabase::Signature(joined));
+}
+
+TEST(BuildDatabase, Serialize)
+{
+    pbxbuild::Tool::Invocation invocation = CreateInvocation("/in.c", "/out.o");
+
+    BuildDatabase database;
+    database.insert(invocation, BuildDatabase::Entry(
+        BuildDatabase::Signature(invocation),
+        { BuildDatabase::FileState("/in.c", true, 100, 5, 10) },
+        { BuildDatabase::FileState("/out.o", false, 0, 0, 0) },
+        1500));
+
+    ext::optional<BuildDatabase> loaded = BuildDatabase::Deserialize(database.serialize());
+    ASSERT_NE(ext::nullopt, loaded);
+    ASSERT_NE(nullptr, loaded->entry(invocation));
+
+    BuildDatabase::Entry const *entry = loaded->entry(invocation);
+    EXPECT_EQ(BuildDatabase::Signature(invocation), entry->signature());
+    ASSERT_EQ(1, entry->inputs().size());
+    EXPECT_EQ(BuildDatabase::FileState("/in.c", true, 100, 5, 10), entry->inputs()[0]);
+    ASSERT_EQ(1, entry->outputs().size());
+    EXPECT_EQ(BuildDatabase::FileState("/out.o", false, 0, 0, 0), entry->outputs()[0]);
+    EXPECT_EQ(1500, entry->duration());
+
+    /* Truncated or unknown contents are rejected. */
+    std::vector<uint8_t> contents = database.serialize();
+    contents.pop_back();
+    EXPECT_EQ(ext::nullopt, BuildDatabase::Deserialize(contents));
+    EXPECT_EQ(ext::nullopt, BuildDatabase::Deserialize({ 'x' }));
+}
+
+TEST(BuildDatabase, Retain)
+{
+    pbxbuild::Tool::Invocation first = CreateInvocation("/a.c", "/a.o");
+    pbxbuild::Tool::Invocation second = CreateInvocation("/b.c", "/b.o");
+
+    BuildDatabase database;
+    database.insert(first, BuildDatabase::Entry(BuildDatabase::Signature(first), { }, { }, 0));
+    database.insert(second, BuildDatabase::Entry(BuildDatabase::Signature(second), { }, { }, 0));
+
+    database.retain({ *BuildDatabase::Key(second) });
+    EXPECT_EQ(nullptr, database.entry(first));
+    EXPECT_NE(nullptr, database.entry(second));
+}
+
+TEST(BuildDatabase, UpToDate)
+{
+    char temporaryDirectory[] = "/tmp/xcexecution-BuildDatabase-XXXXXX";
+    ASSERT_NE(nullptr, ::mkdtemp(temporaryDirectory));
+
+    std::string input = std::string(temporaryDirectory) + "/in.c";
+    std::string output = std::string(temporaryDirectory) + "/out.o";
+    pbxbuild::Tool::Invocation invocation = CreateInvocation(input, output);
+
+    DefaultFilesystem filesystem;
+    WriteFile(input, "int main() { }");
+
+    /* An output that was never created is never up to date. */
+    BuildDatabase::Entry missing = BuildDatabase::Entry::Create(&filesystem, invocation, 0);
+    EXPECT_FALSE(missing.upToDate(invocation));
+
+    WriteFile(output, "object");
+    BuildDatabase::Entry entry = BuildDatabase::Entry::Create(&filesystem, invocation, 0);
+    EXPECT_TRUE(entry.upToDate(invocation));
+
+    /* A different command needs to run again. */
+    pbxbuild::Tool::Invocation changed = invocation;
+    changed.arguments().push_back("-O2");
+    EXPECT_FALSE(entry.upToDate(changed));
+
+    /* So does a changed input. */
+    WriteFile(input, "int main() { return 0; }");
+    EXPECT_FALSE(entry.upToDate(invocation));
+
+    ::unlink(input.c_str());
+    ::unlink(output.c_str());
+    ::rmdir(temporaryDirectory);
+}
+
+TEST(BuildDatabase, RelativePaths)
+{
+    char temporaryDirectory[] = "/tmp/xcexecution-BuildDatabase-XXXXXX";
+    ASSERT_NE(nullptr, ::mkdtemp(temporaryDirectory));
+
+    std::string input = std::string(temporaryDirectory) + "/in.c";
+    std::string output = std::string(temporaryDirectory) + "/out.o";
+    pbxbuild::Tool::Invocation invocation = CreateInvocation("in.c", "out.o");
+    invocation.workingDirectory() = temporaryDirectory;
+
+    DefaultFilesystem filesystem;
+    WriteFile(input, "int main() { }");
+    WriteFile(output, "object");
+
+    /* Both are found in the working directory, not the current one. */
+    BuildDatabase::Entry entry = BuildDatabase::Entry::Create(&filesystem, invocation, 0);
+    ASSERT_EQ(1, entry.inputs().size());
+    EXPECT_EQ(input, entry.inputs()[0].path());
+    ASSERT_EQ(1, entry.outputs().size());
+    EXPECT_EQ(output, entry.outputs()[0].path());
+    EXPECT_TRUE(entry.outputs()[0].exists());
+    EXPECT_TRUE(entry.upToDate(invocation));
+
+    ::unlink(input.c_str());
+    ::unlink(output.c_str());
+    ::rmdir(temporaryDirectory);
+}
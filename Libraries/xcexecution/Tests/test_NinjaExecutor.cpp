@@ -0,0 +1,76 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <xcexecution/NinjaExecutor.h>
+#include <xcformatter/DefaultFormatter.h>
+#include <pbxbuild/Tool/Invocation.h>
+#include <ninja/Writer.h>
+
+using xcexecution::NinjaExecutor;
+using xcformatter::DefaultFormatter;
+
+static pbxbuild::Tool::Invocation
+CompileInvocation(std::string const &executable, std::vector<std::string> const &outputs, std::string const &dependencyInfo)
+{
+    pbxbuild::Tool::Invocation invocation;
+    invocation.executable() = pbxbuild::Tool::Invocation::Executable::Absolute(executable);
+    invocation.arguments() = { "-c", "/src/main.c" };
+    invocation.workingDirectory() = "/src";
+    invocation.inputs() = { "/src/main.c" };
+    invocation.outputs() = outputs;
+    invocation.dependencyInfo() = { pbxbuild::Tool::Invocation::DependencyInfo(dependency::DependencyInfoFormat::Makefile, dependencyInfo) };
+    return invocation;
+}
+
+/*
+ * The text of the rule that runs an executable, up to the next blank line.
+ */
+static std::string
+Rule(std::string const &ninja, std::string const &executable)
+{
+    std::string::size_type command = ninja.find(executable);
+    if (command == std::string::npos) {
+        return std::string();
+    }
+
+    std::string::size_type start = ninja.rfind("rule ", command);
+    std::string::size_type end = ninja.find("\n\n", command);
+    return ninja.substr(start, end - start);
+}
+
+TEST(NinjaExecutor, DependencyDatabase)
+{
+    std::unique_ptr<NinjaExecutor> executor = NinjaExecutor::Create(DefaultFormatter::Create(false), false, false, false, nullptr);
+
+    std::vector<pbxbuild::Tool::Invocation> invocations = {
+        /* A single output, with a separate depfile. */
+        CompileInvocation("/usr/bin/clang", { "/obj/main.o" }, "/obj/main.d"),
+
+        /* Several outputs, including the depfile itself. */
+        CompileInvocation("/usr/bin/swiftc", { "/obj/main.swift.o", "/obj/main.swiftmodule", "/obj/main.swift.d" }, "/obj/main.swift.d"),
+    };
+
+    ninja::Writer writer;
+    ASSERT_TRUE(executor->buildInvocations(&writer, "begin-target", "/tmp/target", invocations, { }));
+    std::string ninja = writer.serialize();
+
+    std::string clang = Rule(ninja, "/usr/bin/clang");
+    ASSERT_FALSE(clang.empty());
+    EXPECT_NE(std::string::npos, clang.find("deps = gcc"));
+
+    /* Ninja would delete the depfile, and can't store deps for several outputs. */
+    std::string swift = Rule(ninja, "/usr/bin/swiftc");
+    ASSERT_FALSE(swift.empty());
+    EXPECT_EQ(std::string::npos, swift.find("deps = gcc"));
+
+    /* Both still read their depfile. */
+    EXPECT_NE(std::string::npos, ninja.find("depfile = /obj/main.d"));
+    EXPECT_NE(std::string::npos, ninja.find("depfile = /obj/main.swift.d"));
+}
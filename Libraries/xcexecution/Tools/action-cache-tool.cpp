@@ -0,0 +1,246 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <xcexecution/ActionCache.h>
+#include <libutil/Options.h>
+#include <libutil/FSUtil.h>
+#include <libutil/Subprocess.h>
+#include <libutil/SysUtil.h>
+
+#include <cstdlib>
+
+using xcexecution::ActionCache;
+using libutil::FSUtil;
+using libutil::Subprocess;
+using libutil::SysUtil;
+
+class Options {
+private:
+    bool        _help;
+    bool        _version;
+
+private:
+    std::string _cache;
+    std::string _size;
+    bool        _stats;
+
+private:
+    std::vector<std::string> _inputs;
+    std::vector<std::string> _outputs;
+    std::vector<std::string> _command;
+
+public:
+    Options();
+    ~Options();
+
+public:
+    bool help() const
+    { return _help; }
+    bool version() const
+    { return _version; }
+
+public:
+    std::string const &cache() const
+    { return _cache; }
+    std::string const &size() const
+    { return _size; }
+    bool stats() const
+    { return _stats; }
+
+public:
+    std::vector<std::string> const &inputs() const
+    { return _inputs; }
+    std::vector<std::string> const &outputs() const
+    { return _outputs; }
+    std::vector<std::string> const &command() const
+    { return _command; }
+
+private:
+    friend class libutil::Options;
+    std::pair<bool, std::string>
+    parseArgument(std::vector<std::string> const &args, std::vector<std::string>::const_iterator *it);
+};
+
+Options::
+Options() :
+    _help   (false),
+    _version(false),
+    _stats  (false)
+{
+}
+
+Options::
+~Options()
+{
+}
+
+std::pair<bool, std::string> Options::
+parseArgument(std::vector<std::string> const &args, std::vector<std::string>::const_iterator *it)
+{
+    std::string const &arg = **it;
+
+    if (arg == "-h" || arg == "--help") {
+        return libutil::Options::MarkBool(&_help, arg);
+    } else if (arg == "-v" || arg == "--version") {
+        return libutil::Options::MarkBool(&_version, arg);
+    } else if (arg == "-c" || arg == "--cache") {
+        return libutil::Options::NextString(&_cache, args, it);
+    } else if (arg == "-s" || arg == "--size") {
+        return libutil::Options::NextString(&_size, args, it);
+    } else if (arg == "--stats") {
+        return libutil::Options::MarkBool(&_stats, arg);
+    } else if (arg == "-i" || arg == "--input") {
+        std::string input;
+        std::pair<bool, std::string> result = libutil::Options::NextString(&input, args, it);
+        _inputs.push_back(input);
+        return result;
+    } else if (arg == "-o" || arg == "--output") {
+        std::string output;
+        std::pair<bool, std::string> result = libutil::Options::NextString(&output, args, it);
+        _outputs.push_back(output);
+        return result;
+    } else if (arg == "--") {
+        /* Everything after is the command to run. */
+        _command = std::vector<std::string>(*it + 1, args.end());
+        *it = args.end() - 1;
+        return std::make_pair(true, std::string());
+    } else {
+        return std::make_pair(false, "unknown argument " + arg);
+    }
+}
+
+static int
+Help(std::string const &error = std::string())
+{
+    if (!error.empty()) {
+        fprintf(stderr, "error: %s\n", error.c_str());
+        fprintf(stderr, "\n");
+    }
+
+    fprintf(stderr, "Usage: action-cache-tool [options] -- command [arguments]\n\n");
+    fprintf(stderr, "Restores the outputs of a command from a cache, or runs it and caches them.\n\n");
+
+#define INDENT "  "
+    fprintf(stderr, "Information:\n");
+    fprintf(stderr, INDENT "-h, --help\n");
+    fprintf(stderr, INDENT "-v, --version\n");
+    fprintf(stderr, INDENT "--stats\n");
+    fprintf(stderr, "\n");
+
+    fprintf(stderr, "Cache Options:\n");
+    fprintf(stderr, INDENT "-c, --cache\n");
+    fprintf(stderr, INDENT "-s, --size\n");
+    fprintf(stderr, INDENT "-i, --input\n");
+    fprintf(stderr, INDENT "-o, --output\n");
+    fprintf(stderr, "\n");
+#undef INDENT
+
+    return (error.empty() ? 0 : -1);
+}
+
+static int
+Version()
+{
+    printf("action-cache-tool version 1 (xcbuild)\n");
+    return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    std::vector<std::string> args = std::vector<std::string>(argv + 1, argv + argc);
+
+    /*
+     * Parse out the options, or print help & exit.
+     */
+    Options options;
+    std::pair<bool, std::string> result = libutil::Options::Parse<Options>(&options, args);
+    if (!result.first) {
+        return Help(result.second);
+    }
+
+    /*
+     * Handle the basic options.
+     */
+    if (options.help()) {
+        return Help();
+    } else if (options.version()) {
+        return Version();
+    }
+
+    /*
+     * Diagnose missing options.
+     */
+    if (options.cache().empty() || (!options.stats() && options.command().empty())) {
+        return Help("missing option(s)");
+    }
+
+    uint64_t sizeLimit = ActionCache::DefaultSizeLimit();
+    if (!options.size().empty()) {
+        sizeLimit = ::strtoull(options.size().c_str(), nullptr, 10);
+    }
+
+    std::string currentDirectory = FSUtil::GetCurrentDirectory();
+    ActionCache cache(FSUtil::ResolveRelativePath(options.cache(), currentDirectory), sizeLimit);
+
+    if (options.stats()) {
+        size_t hits = 0, misses = 0;
+        if (!cache.statistics(&hits, &misses)) {
+            fprintf(stderr, "error: no statistics in %s\n", cache.path().c_str());
+            return 1;
+        }
+
+        printf("%zu hits, %zu misses\n", hits, misses);
+        return 0;
+    }
+
+    std::vector<std::string> outputs;
+    for (std::string const &output : options.outputs()) {
+        outputs.push_back(FSUtil::ResolveRelativePath(output, currentDirectory));
+    }
+
+    std::string executable = options.command().front();
+    std::vector<std::string> arguments = std::vector<std::string>(options.command().begin() + 1, options.command().end());
+    std::unordered_map<std::string, std::string> environment = SysUtil::EnvironmentVariables();
+
+    /*
+     * Restore the outputs if cached. Without a key, just run the command.
+     */
+    ext::optional<std::string> key;
+    if (!outputs.empty()) {
+        key = cache.key(executable, arguments, environment, currentDirectory, options.inputs());
+        if (key && cache.restore(*key, outputs)) {
+            return 0;
+        }
+    }
+
+    Subprocess process;
+    if (!process.execute(executable, arguments, environment, currentDirectory)) {
+        fprintf(stderr, "error: failed to run %s\n", executable.c_str());
+        return 1;
+    }
+
+    if (process.exitcode() != 0) {
+        return process.exitcode();
+    }
+
+    if (key) {
+        cache.store(*key, outputs);
+
+        /*
+         * Each run is a separate process, so trim only occasionally rather
+         * than scanning the whole cache after every command.
+         */
+        if (key->compare(0, 2, "00") == 0) {
+            cache.trim();
+        }
+    }
+
+    return 0;
+}
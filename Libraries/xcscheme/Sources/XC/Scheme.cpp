@@ -13,6 +13,7 @@
 
 using xcscheme::XC::Scheme;
 using libutil::Filesystem;
+using libutil::MappedBuffer;
 
 Scheme::
 Scheme(std::string const &name, std::string const &owner) :
@@ -101,15 +102,15 @@ Open(Filesystem const *filesystem, std::string const &name, std::string const &o
         return nullptr;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, realPath)) {
+    MappedBuffer contents;
+    if (!filesystem->map(&contents, realPath)) {
         return nullptr;
     }
 
     //
     // Parse simple XML
     //
-    std::unique_ptr<plist::Object> root = plist::Format::SimpleXML::Deserialize(contents).first;
+    std::unique_ptr<plist::Object> root = plist::Format::SimpleXML::Deserialize(contents.data(), contents.size()).first;
     if (root == nullptr) {
         return nullptr;
     }
@@ -12,6 +12,7 @@
 
 using xcsdk::SDK::PlatformVersion;
 using libutil::Filesystem;
+using libutil::MappedBuffer;
 
 PlatformVersion::PlatformVersion()
 {
@@ -61,15 +62,15 @@ Open(Filesystem const *filesystem, std::string const &path)
         return nullptr;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, versionFileName)) {
+    MappedBuffer contents;
+    if (!filesystem->map(&contents, versionFileName)) {
         return nullptr;
     }
 
     //
     // Parse property list
     //
-    auto result = plist::Format::Any::Deserialize(contents);
+    auto result = plist::Format::Any::Deserialize(contents.data(), contents.size());
     if (result.first == nullptr) {
         return nullptr;
     }
@@ -12,6 +12,7 @@
 
 using xcsdk::SDK::Product;
 using libutil::Filesystem;
+using libutil::MappedBuffer;
 
 Product::Product()
 {
@@ -66,15 +67,15 @@ Open(Filesystem const *filesystem, std::string const &path)
         return nullptr;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, settingsFileName)) {
+    MappedBuffer contents;
+    if (!filesystem->map(&contents, settingsFileName)) {
         return nullptr;
     }
 
     //
     // Parse property list
     //
-    auto result = plist::Format::Any::Deserialize(contents);
+    auto result = plist::Format::Any::Deserialize(contents.data(), contents.size());
     if (result.first == nullptr) {
         return nullptr;
     }
@@ -16,6 +16,7 @@ using xcsdk::SDK::Target;
 using pbxsetting::Level;
 using pbxsetting::Setting;
 using libutil::Filesystem;
+using libutil::MappedBuffer;
 using libutil::FSUtil;
 
 Target::Target() :
@@ -189,15 +190,15 @@ Open(Filesystem const *filesystem, std::shared_ptr<Manager> manager, std::shared
         return nullptr;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, settingsFileName)) {
+    MappedBuffer contents;
+    if (!filesystem->map(&contents, settingsFileName)) {
         return nullptr;
     }
 
     //
     // Parse property list
     //
-    auto result = plist::Format::Any::Deserialize(contents);
+    auto result = plist::Format::Any::Deserialize(contents.data(), contents.size());
     if (result.first == nullptr) {
         return nullptr;
     }
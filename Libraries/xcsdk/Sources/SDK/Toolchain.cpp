@@ -13,6 +13,7 @@
 
 using xcsdk::SDK::Toolchain;
 using libutil::Filesystem;
+using libutil::MappedBuffer;
 using libutil::FSUtil;
 
 Toolchain::Toolchain()
@@ -58,15 +59,15 @@ Open(Filesystem const *filesystem, std::shared_ptr<Manager> manager, std::string
         return nullptr;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, settingsFileName)) {
+    MappedBuffer contents;
+    if (!filesystem->map(&contents, settingsFileName)) {
         return nullptr;
     }
 
     //
     // Parse property list
     //
-    auto result = plist::Format::Any::Deserialize(contents);
+    auto result = plist::Format::Any::Deserialize(contents.data(), contents.size());
     if (result.first == nullptr) {
         return nullptr;
     }
@@ -15,6 +15,7 @@
 
 using xcworkspace::XC::Workspace;
 using libutil::Filesystem;
+using libutil::MappedBuffer;
 using libutil::FSUtil;
 using libutil::SysUtil;
 
@@ -73,15 +74,15 @@ Open(Filesystem const *filesystem, std::string const &path)
         return nullptr;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, realPath)) {
+    MappedBuffer contents;
+    if (!filesystem->map(&contents, realPath)) {
         return nullptr;
     }
 
     //
     // Parse property list
     //
-    std::unique_ptr<plist::Object> root = plist::Format::SimpleXML::Deserialize(contents).first;
+    std::unique_ptr<plist::Object> root = plist::Format::SimpleXML::Deserialize(contents.data(), contents.size()).first;
     if (root == nullptr) {
         return nullptr;
     }